@@ -0,0 +1,135 @@
+// RISC-V CPU Cluster for UnifiedRISCV
+// NUM_HARTS riscv_cpu cores (mhartid 0..NUM_HARTS-1) sharing one GPU array.
+// Each hart keeps its own memory port; the top arbitrates them, holding a
+// hart's grant while its mem_lock is up so AMOs and sub-word stores stay
+// atomic. The GPU custom instructions write per-hart copies of each unit's
+// operand, ring base and ring head registers, so every unit follows the
+// hart that last wrote them: software hands a unit to one hart at a time.
+// Debug outputs are hart 0's, which is the hart that runs main().
+
+module riscv_cluster #(
+    parameter XLEN = 32,
+    parameter NUM_HARTS = 1,
+    parameter NUM_GPU_UNITS = 8
+) (
+    input  logic clk,
+    input  logic rst_n,
+    
+    // One memory port per hart
+    output logic [NUM_HARTS-1:0][31:0] hart_mem_addr,
+    output logic [NUM_HARTS-1:0][31:0] hart_mem_wdata,
+    input  logic [NUM_HARTS-1:0][31:0] hart_mem_rdata,
+    output logic [NUM_HARTS-1:0] hart_mem_req,
+    output logic [NUM_HARTS-1:0] hart_mem_we,
+    input  logic [NUM_HARTS-1:0] hart_mem_ack,
+    output logic [NUM_HARTS-1:0] hart_mem_lock,
+    
+    // GPU interface, shared by the harts
+    input  logic [NUM_GPU_UNITS-1:0] gpu_unit_busy,
+    output logic [NUM_GPU_UNITS-1:0] gpu_unit_start,
+    output logic [31:0] gpu_matrix_a [NUM_GPU_UNITS-1:0],
+    output logic [31:0] gpu_matrix_b [NUM_GPU_UNITS-1:0],
+    input  logic [31:0] gpu_matrix_c [NUM_GPU_UNITS-1:0],
+    output logic [31:0] gpu_ring_base [NUM_GPU_UNITS-1:0],
+    output logic [7:0] gpu_ring_head [NUM_GPU_UNITS-1:0],
+    input  logic [7:0] gpu_ring_tail [NUM_GPU_UNITS-1:0],
+    
+    // Debug interface (hart 0)
+    output logic [31:0] debug_pc,
+    output logic [31:0] debug_inst,
+    output logic debug_valid
+);
+
+    localparam HART_BITS = NUM_HARTS > 1 ? $clog2(NUM_HARTS) : 1;
+    
+    // Per-hart GPU register copies
+    logic [NUM_GPU_UNITS-1:0] hart_unit_start [NUM_HARTS];
+    logic [31:0] hart_matrix_a [NUM_HARTS][NUM_GPU_UNITS-1:0];
+    logic [31:0] hart_matrix_b [NUM_HARTS][NUM_GPU_UNITS-1:0];
+    logic [31:0] hart_ring_base [NUM_HARTS][NUM_GPU_UNITS-1:0];
+    logic [7:0] hart_ring_head [NUM_HARTS][NUM_GPU_UNITS-1:0];
+    logic [NUM_GPU_UNITS-1:0] hart_ring_base_we [NUM_HARTS];
+    logic [NUM_GPU_UNITS-1:0] hart_ring_head_we [NUM_HARTS];
+    
+    logic [31:0] hart_debug_pc [NUM_HARTS];
+    logic [31:0] hart_debug_inst [NUM_HARTS];
+    logic [NUM_HARTS-1:0] hart_debug_valid;
+    
+    genvar h;
+    generate
+        for (h = 0; h < NUM_HARTS; h++) begin : harts
+            riscv_cpu #(
+                .XLEN(XLEN),
+                .HART_ID(h),
+                .NUM_GPU_UNITS(NUM_GPU_UNITS)
+            ) cpu (
+                .clk(clk),
+                .rst_n(rst_n),
+                .mem_addr(hart_mem_addr[h]),
+                .mem_wdata(hart_mem_wdata[h]),
+                .mem_rdata(hart_mem_rdata[h]),
+                .mem_req(hart_mem_req[h]),
+                .mem_we(hart_mem_we[h]),
+                .mem_ack(hart_mem_ack[h]),
+                .mem_lock(hart_mem_lock[h]),
+                .gpu_unit_busy(gpu_unit_busy),
+                .gpu_unit_start(hart_unit_start[h]),
+                .gpu_matrix_a(hart_matrix_a[h]),
+                .gpu_matrix_b(hart_matrix_b[h]),
+                .gpu_matrix_c(gpu_matrix_c),
+                .gpu_ring_base(hart_ring_base[h]),
+                .gpu_ring_head(hart_ring_head[h]),
+                .gpu_ring_tail(gpu_ring_tail),
+                .gpu_ring_base_we(hart_ring_base_we[h]),
+                .gpu_ring_head_we(hart_ring_head_we[h]),
+                .debug_pc(hart_debug_pc[h]),
+                .debug_inst(hart_debug_inst[h]),
+                .debug_valid(hart_debug_valid[h])
+            );
+        end
+    endgenerate
+    
+    assign debug_pc = hart_debug_pc[0];
+    assign debug_inst = hart_debug_inst[0];
+    assign debug_valid = hart_debug_valid[0];
+    
+    // Hart whose copy each unit register follows: the writer this cycle,
+    // otherwise the last one
+    logic [HART_BITS-1:0] start_owner [NUM_GPU_UNITS-1:0], start_sel [NUM_GPU_UNITS-1:0];
+    logic [HART_BITS-1:0] base_owner [NUM_GPU_UNITS-1:0], base_sel [NUM_GPU_UNITS-1:0];
+    logic [HART_BITS-1:0] head_owner [NUM_GPU_UNITS-1:0], head_sel [NUM_GPU_UNITS-1:0];
+    
+    always_comb begin
+        for (int u = 0; u < NUM_GPU_UNITS; u++) begin
+            start_sel[u] = start_owner[u];
+            base_sel[u] = base_owner[u];
+            head_sel[u] = head_owner[u];
+            gpu_unit_start[u] = 1'b0;
+            for (int i = 0; i < NUM_HARTS; i++) begin
+                if (hart_unit_start[i][u]) start_sel[u] = HART_BITS'(i);
+                if (hart_ring_base_we[i][u]) base_sel[u] = HART_BITS'(i);
+                if (hart_ring_head_we[i][u]) head_sel[u] = HART_BITS'(i);
+                gpu_unit_start[u] = gpu_unit_start[u] | hart_unit_start[i][u];
+            end
+            gpu_matrix_a[u] = hart_matrix_a[start_sel[u]][u];
+            gpu_matrix_b[u] = hart_matrix_b[start_sel[u]][u];
+            gpu_ring_base[u] = hart_ring_base[base_sel[u]][u];
+            gpu_ring_head[u] = hart_ring_head[head_sel[u]][u];
+        end
+    end
+    
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            for (int u = 0; u < NUM_GPU_UNITS; u++) begin
+                start_owner[u] <= '0;
+                base_owner[u] <= '0;
+                head_owner[u] <= '0;
+            end
+        end else begin
+            start_owner <= start_sel;
+            base_owner <= base_sel;
+            head_owner <= head_sel;
+        end
+    end
+
+endmodule
@@ -1,8 +1,21 @@
 // RISC-V RV32I CPU Core with Custom GPU Instructions
-// Extended with GPU control and matrix operations
+// Classic 5-stage in-order pipeline (IF/ID/EX/MEM/WB) with full forwarding and
+// a small direct-mapped instruction cache, so straight-line code and loops
+// issue one instruction per cycle. Loads and stores share the memory port with
+// instruction refills and stall the pipeline until they are acknowledged.
+// custom-2 holds packed-SIMD ops on 4x int8 or 2x int16 lanes (P-extension style).
+// Zicsr reads of the cycle/time/instret counters and mhartid are supported;
+// CSR writes are ignored and ECALL/EBREAK retire as no-ops for the host to see.
+// The A-extension AMOs (AMO*.W, no LR/SC) read the word, then write the
+// updated value back with mem_lock held in between so that other harts on
+// the same port cannot interleave; byte and halfword stores lock the same way.
 
 module riscv_cpu #(
-    parameter XLEN = 32
+    parameter XLEN = 32,
+    parameter HART_ID = 0,           // Read back through mhartid
+    parameter ICACHE_LINES = 64,     // Direct-mapped instruction cache lines
+    parameter ICACHE_LINE_WORDS = 4, // Words per line, refilled one word at a time
+    parameter NUM_GPU_UNITS = 8      // Units addressed by the GPU instructions
 ) (
     input  logic clk,
     input  logic rst_n,
@@ -14,194 +27,838 @@ module riscv_cpu #(
     output logic mem_req,
     output logic mem_we,
     input  logic mem_ack,
+    output logic mem_lock,           // Read-modify-write between its read and write
     
     // GPU interface
-    input  logic [7:0] gpu_unit_busy,
-    output logic [7:0] gpu_unit_start,
-    output logic [31:0] gpu_matrix_a [7:0],
-    output logic [31:0] gpu_matrix_b [7:0],
-    output logic [31:0] gpu_matrix_c [7:0],
+    input  logic [NUM_GPU_UNITS-1:0] gpu_unit_busy,
+    output logic [NUM_GPU_UNITS-1:0] gpu_unit_start,
+    output logic [31:0] gpu_matrix_a [NUM_GPU_UNITS-1:0],
+    output logic [31:0] gpu_matrix_b [NUM_GPU_UNITS-1:0],
+    input  logic [31:0] gpu_matrix_c [NUM_GPU_UNITS-1:0],
+    output logic [31:0] gpu_ring_base [NUM_GPU_UNITS-1:0],
+    output logic [7:0] gpu_ring_head [NUM_GPU_UNITS-1:0],
+    input  logic [7:0] gpu_ring_tail [NUM_GPU_UNITS-1:0],
+    output logic [NUM_GPU_UNITS-1:0] gpu_ring_base_we,   // One-cycle pulses when this hart writes
+    output logic [NUM_GPU_UNITS-1:0] gpu_ring_head_we,   // a unit's ring base or head
     
-    // Debug interface
+    // Debug interface (one pulse per retired instruction)
     output logic [31:0] debug_pc,
     output logic [31:0] debug_inst,
     output logic debug_valid
 );
 
-    // CPU state
-    logic [31:0] pc, pc_next;
-    logic [31:0] registers [31:0];
-    logic [31:0] instruction;
-    logic [31:0] immediate;
-    
-    // Pipeline stages
-    typedef enum logic [2:0] {
-        FETCH,
-        DECODE,
-        EXECUTE,
-        MEMORY,
-        WRITEBACK
-    } pipeline_stage_t;
-    
-    pipeline_stage_t current_stage;
-    
-    // Instruction decode
-    logic [6:0] opcode;
-    logic [4:0] rd, rs1, rs2;
-    logic [2:0] funct3;
-    logic [6:0] funct7;
-    
-    // ALU
-    logic [31:0] alu_a, alu_b, alu_result;
-    logic [3:0] alu_op;
-    
-    // Control signals
-    logic reg_write_en;
-    logic [1:0] reg_write_src;
-    logic branch_taken;
-    logic mem_read, mem_write;
-    logic gpu_instruction;
+    // Base opcodes
+    localparam OP_LUI    = 7'b0110111;
+    localparam OP_AUIPC  = 7'b0010111;
+    localparam OP_JAL    = 7'b1101111;
+    localparam OP_JALR   = 7'b1100111;
+    localparam OP_BRANCH = 7'b1100011;
+    localparam OP_LOAD   = 7'b0000011;
+    localparam OP_STORE  = 7'b0100011;
+    localparam OP_IMM    = 7'b0010011;
+    localparam OP_REG    = 7'b0110011;
+    localparam OP_FENCE  = 7'b0001111;
+    localparam OP_SYSTEM = 7'b1110011;
+    localparam OP_AMO    = 7'b0101111;
+    
+    // AMO funct5 (inst[31:27]); LR.W/SC.W (00010/00011) are not implemented
+    localparam AMO_ADD  = 5'b00000;
+    localparam AMO_SWAP = 5'b00001;
+    localparam AMO_XOR  = 5'b00100;
+    localparam AMO_OR   = 5'b01000;
+    localparam AMO_AND  = 5'b01100;
+    localparam AMO_MIN  = 5'b10000;
+    localparam AMO_MAX  = 5'b10100;
+    localparam AMO_MINU = 5'b11000;
+    localparam AMO_MAXU = 5'b11100;
+    
+    // Read-only CSRs (time reads the cycle counter)
+    localparam CSR_CYCLE     = 12'hC00;
+    localparam CSR_TIME      = 12'hC01;
+    localparam CSR_INSTRET   = 12'hC02;
+    localparam CSR_CYCLEH    = 12'hC80;
+    localparam CSR_TIMEH     = 12'hC81;
+    localparam CSR_INSTRETH  = 12'hC82;
+    localparam CSR_MCYCLE    = 12'hB00;
+    localparam CSR_MINSTRET  = 12'hB02;
+    localparam CSR_MCYCLEH   = 12'hB80;
+    localparam CSR_MINSTRETH = 12'hB82;
+    localparam CSR_MHARTID   = 12'hF14;
     
     // Custom GPU opcodes (using custom-0 and custom-1 space)
     localparam GPU_MATMUL   = 7'b0001011;  // custom-0
     localparam GPU_STATUS   = 7'b0101011;  // custom-1
     
-    assign opcode = instruction[6:0];
-    assign rd = instruction[11:7];
-    assign rs1 = instruction[19:15];
-    assign rs2 = instruction[24:20];
-    assign funct3 = instruction[14:12];
-    assign funct7 = instruction[31:25];
+    // GPU funct3 encodings
+    // custom-0: 000 matmul setup, 001 get result, 010 ring base, 011 ring doorbell
+    // custom-1: 001 unit status, 010 ring tail
+    localparam GPU_FN_MATMUL    = 3'b000;
+    localparam GPU_FN_RESULT    = 3'b001;
+    localparam GPU_FN_RING_BASE = 3'b010;
+    localparam GPU_FN_DOORBELL  = 3'b011;
+    localparam GPU_FN_STATUS    = 3'b001;
+    localparam GPU_FN_RING_TAIL = 3'b010;
+    
+    // Unit index bits taken from rs1 (value or register number)
+    localparam UNIT_BITS = NUM_GPU_UNITS > 1 ? $clog2(NUM_GPU_UNITS) : 1;
+    
+    // Packed SIMD (custom-2): funct3 selects the lane width, funct7 the op
+    localparam OP_SIMD       = 7'b1011011;
+    localparam SIMD_W8       = 3'b000;   // 4x int8
+    localparam SIMD_W16      = 3'b001;   // 2x int16
+    localparam SIMD_ADD      = 7'h00;    // Wrapping add
+    localparam SIMD_SUB      = 7'h01;    // Wrapping subtract
+    localparam SIMD_KADD     = 7'h02;    // Signed saturating add
+    localparam SIMD_KSUB     = 7'h03;    // Signed saturating subtract
+    localparam SIMD_MAX      = 7'h04;    // Signed max
+    localparam SIMD_MIN      = 7'h05;    // Signed min
+    localparam SIMD_SRA      = 7'h06;    // Arithmetic right shift by rs2[3:0] (all lanes)
+    localparam SIMD_KMUL     = 7'h07;    // Signed saturating multiply
+    localparam SIMD_NARROW   = 7'h08;    // int16 lanes of rs1, rs2 -> saturated int8 (W16 only)
+    
+    // ALU operations
+    typedef enum logic [3:0] {
+        ALU_ADD,
+        ALU_SUB,
+        ALU_SLL,
+        ALU_SLT,
+        ALU_SLTU,
+        ALU_XOR,
+        ALU_SRL,
+        ALU_SRA,
+        ALU_OR,
+        ALU_AND,
+        ALU_PASS_B
+    } alu_op_t;
+    
+    logic [31:0] registers [31:0];
+    
+    // Instruction cache geometry
+    localparam IC_WORD_BITS = $clog2(ICACHE_LINE_WORDS);
+    localparam IC_INDEX_BITS = $clog2(ICACHE_LINES);
+    localparam IC_TAG_BITS = 32 - IC_INDEX_BITS - IC_WORD_BITS - 2;
+    
+    logic [31:0] ic_data [ICACHE_LINES-1:0][ICACHE_LINE_WORDS-1:0];
+    logic [IC_TAG_BITS-1:0] ic_tag [ICACHE_LINES-1:0];
+    logic [ICACHE_LINES-1:0] ic_valid;
+    
+    // Line being refilled. The line is invalid until its last word arrives;
+    // a FENCE.I during the refill marks the words fetched so far as stale.
+    logic refilling;
+    logic refill_discard;
+    logic [31:0] refill_addr;
+    logic [IC_WORD_BITS-1:0] refill_word;
+    
+    // Memory port: one transaction at a time, either a data access from MEM
+    // or an instruction refill word
+    logic port_is_fetch;
+    logic rmw_phase;        // Sub-word store or AMO: old word read, write pending
+    logic [31:0] rmw_word;
+    
+    // ---------------------------------------------------------------
+    // Pipeline registers
+    // ---------------------------------------------------------------
+    
+    // IF
+    logic [31:0] pc_f;
+    
+    // IF/ID
+    logic d_valid;
+    logic [31:0] d_pc, d_inst;
+    
+    // ID/EX
+    logic e_valid;
+    logic [31:0] e_pc, e_inst;
+    logic [4:0] e_rd, e_rs1, e_rs2;
+    logic [2:0] e_funct3;
+    logic [31:0] e_rs1_val, e_rs2_val, e_imm;
+    alu_op_t e_alu_op;
+    logic e_use_imm, e_use_pc, e_reg_write;
+    logic e_is_load, e_is_store, e_is_branch, e_is_jal, e_is_jalr;
+    logic e_is_gpu, e_is_simd, e_is_csr, e_is_fence_i, e_is_amo, e_pred_taken;
+    
+    // EX/MEM
+    logic m_valid;
+    logic [31:0] m_pc, m_inst;
+    logic [4:0] m_rd;
+    logic [2:0] m_funct3;
+    logic m_reg_write, m_is_load, m_is_store, m_is_amo;
+    logic [31:0] m_result, m_store_data;
+    
+    // MEM/WB
+    logic w_valid;
+    logic [31:0] w_pc, w_inst;
+    logic [4:0] w_rd;
+    logic w_reg_write;
+    logic [31:0] w_value;
+    
+    // Performance counters
+    logic [63:0] cycle_count, instret_count;
+    
+    assign debug_pc = w_pc;
+    assign debug_inst = w_inst;
+    assign debug_valid = w_valid;
+    
+    // ---------------------------------------------------------------
+    // IF: instruction cache lookup
+    // ---------------------------------------------------------------
+    logic [IC_INDEX_BITS-1:0] f_index;
+    logic [IC_WORD_BITS-1:0] f_word;
+    logic [IC_TAG_BITS-1:0] f_tag;
+    logic f_hit;
+    
+    assign f_word = pc_f[IC_WORD_BITS+1:2];
+    assign f_index = pc_f[IC_INDEX_BITS+IC_WORD_BITS+1:IC_WORD_BITS+2];
+    assign f_tag = pc_f[31:IC_INDEX_BITS+IC_WORD_BITS+2];
+    assign f_hit = ic_valid[f_index] && ic_tag[f_index] == f_tag;
+    
+    // ---------------------------------------------------------------
+    // ID: decode, register read and static branch prediction
+    // ---------------------------------------------------------------
+    logic [6:0] d_opcode;
+    logic [4:0] d_rd, d_rs1, d_rs2;
+    logic [2:0] d_funct3;
+    logic [6:0] d_funct7;
+    logic [31:0] d_imm;
+    alu_op_t d_alu_op;
+    logic d_use_imm, d_use_pc, d_reg_write, d_uses_rs1, d_uses_rs2;
+    logic d_is_load, d_is_store, d_is_branch, d_is_jal, d_is_jalr;
+    logic d_is_gpu, d_is_simd, d_is_csr, d_is_fence_i, d_is_amo;
+    logic [31:0] d_rs1_val, d_rs2_val;
+    logic d_predict_taken;
+    
+    assign d_opcode = d_inst[6:0];
+    assign d_rd = d_inst[11:7];
+    assign d_rs1 = d_inst[19:15];
+    assign d_rs2 = d_inst[24:20];
+    assign d_funct3 = d_inst[14:12];
+    assign d_funct7 = d_inst[31:25];
+    
+    always_comb begin
+        d_imm = '0;
+        d_alu_op = ALU_ADD;
+        d_use_imm = 1'b0;
+        d_use_pc = 1'b0;
+        d_reg_write = 1'b0;
+        d_uses_rs1 = 1'b0;
+        d_uses_rs2 = 1'b0;
+        d_is_load = 1'b0;
+        d_is_store = 1'b0;
+        d_is_branch = 1'b0;
+        d_is_jal = 1'b0;
+        d_is_jalr = 1'b0;
+        d_is_gpu = 1'b0;
+        d_is_simd = 1'b0;
+        d_is_csr = 1'b0;
+        d_is_fence_i = 1'b0;
+        d_is_amo = 1'b0;
+        
+        case (d_opcode)
+            OP_LUI: begin
+                d_imm = {d_inst[31:12], 12'h0};
+                d_alu_op = ALU_PASS_B;
+                d_use_imm = 1'b1;
+                d_reg_write = 1'b1;
+            end
+            OP_AUIPC: begin
+                d_imm = {d_inst[31:12], 12'h0};
+                d_use_imm = 1'b1;
+                d_use_pc = 1'b1;
+                d_reg_write = 1'b1;
+            end
+            OP_JAL: begin
+                d_imm = {{12{d_inst[31]}}, d_inst[19:12], d_inst[20], d_inst[30:21], 1'b0};
+                d_is_jal = 1'b1;
+                d_reg_write = 1'b1;
+            end
+            OP_JALR: begin
+                d_imm = {{20{d_inst[31]}}, d_inst[31:20]};
+                d_is_jalr = 1'b1;
+                d_reg_write = 1'b1;
+                d_uses_rs1 = 1'b1;
+            end
+            OP_BRANCH: begin
+                d_imm = {{20{d_inst[31]}}, d_inst[7], d_inst[30:25], d_inst[11:8], 1'b0};
+                d_is_branch = 1'b1;
+                d_uses_rs1 = 1'b1;
+                d_uses_rs2 = 1'b1;
+            end
+            OP_LOAD: begin
+                d_imm = {{20{d_inst[31]}}, d_inst[31:20]};
+                d_use_imm = 1'b1;
+                d_is_load = 1'b1;
+                d_reg_write = 1'b1;
+                d_uses_rs1 = 1'b1;
+            end
+            OP_STORE: begin
+                d_imm = {{20{d_inst[31]}}, d_inst[31:25], d_inst[11:7]};
+                d_use_imm = 1'b1;
+                d_is_store = 1'b1;
+                d_uses_rs1 = 1'b1;
+                d_uses_rs2 = 1'b1;
+            end
+            OP_IMM: begin
+                d_imm = {{20{d_inst[31]}}, d_inst[31:20]};
+                d_alu_op = alu_decode(d_funct3, d_funct7, 1'b1);
+                d_use_imm = 1'b1;
+                d_reg_write = 1'b1;
+                d_uses_rs1 = 1'b1;
+            end
+            OP_REG: begin
+                d_alu_op = alu_decode(d_funct3, d_funct7, 1'b0);
+                d_reg_write = 1'b1;
+                d_uses_rs1 = 1'b1;
+                d_uses_rs2 = 1'b1;
+            end
+            OP_FENCE: begin
+                d_is_fence_i = (d_funct3 == 3'b001);
+            end
+            OP_AMO: begin
+                // Address in rs1 (the ALU adds a zero immediate); rd gets the
+                // old word like a load, rs2 is the operand like store data
+                if (d_funct3 == 3'b010 && !d_inst[28]) begin
+                    d_is_amo = 1'b1;
+                    d_use_imm = 1'b1;
+                    d_is_load = 1'b1;
+                    d_is_store = 1'b1;
+                    d_reg_write = 1'b1;
+                    d_uses_rs1 = 1'b1;
+                    d_uses_rs2 = 1'b1;
+                end
+            end
+            GPU_MATMUL, GPU_STATUS: begin // Custom GPU instructions
+                d_is_gpu = 1'b1;
+                d_uses_rs1 = 1'b1;
+                d_uses_rs2 = 1'b1;
+                d_reg_write = (d_opcode == GPU_STATUS) || (d_funct3 == GPU_FN_RESULT);
+            end
+            OP_SIMD: begin
+                d_is_simd = 1'b1;
+                d_reg_write = 1'b1;
+                d_uses_rs1 = 1'b1;
+                d_uses_rs2 = 1'b1;
+            end
+            OP_SYSTEM: begin
+                // CSR reads; ECALL/EBREAK (funct3 0) fall through as no-ops
+                d_is_csr = (d_funct3 != 3'b000);
+                d_reg_write = d_is_csr;
+            end
+            default: begin
+                // Unknown opcodes retire as no-ops
+            end
+        endcase
+    end
+    
+    // Register read; a write retiring this cycle is bypassed
+    assign d_rs1_val = (d_rs1 == 5'h0) ? 32'h0 :
+                       (w_valid && w_reg_write && w_rd == d_rs1) ? w_value : registers[d_rs1];
+    assign d_rs2_val = (d_rs2 == 5'h0) ? 32'h0 :
+                       (w_valid && w_reg_write && w_rd == d_rs2) ? w_value : registers[d_rs2];
     
-    assign debug_pc = pc;
-    assign debug_inst = instruction;
-    assign debug_valid = (current_stage == DECODE);
+    // Backward branches and JAL are predicted taken from ID (one bubble)
+    assign d_predict_taken = d_is_jal || (d_is_branch && d_imm[31]);
+    
+    // A load's value is only available from WB, one cycle too late for EX
+    logic load_use;
+    assign load_use = e_valid && e_is_load && e_rd != 5'h0 &&
+                      ((d_uses_rs1 && d_rs1 == e_rd) || (d_uses_rs2 && d_rs2 == e_rd));
+    
+    // ---------------------------------------------------------------
+    // EX: forwarding, ALU, branch resolution and GPU instructions
+    // ---------------------------------------------------------------
+    logic [31:0] ex_rs1, ex_rs2, ex_a, ex_b, ex_alu, ex_result;
+    logic [31:0] ex_target, ex_redirect_pc;
+    logic ex_taken, ex_redirect;
+    logic [31:0] gpu_result;
+    logic gpu_wait;
+    logic [UNIT_BITS-1:0] gpu_unit_sel, gpu_reg_sel;
+    
+    always_comb begin
+        ex_rs1 = e_rs1_val;
+        if (e_rs1 == 5'h0) ex_rs1 = 32'h0;
+        else if (m_valid && m_reg_write && !m_is_load && m_rd == e_rs1) ex_rs1 = m_result;
+        else if (w_valid && w_reg_write && w_rd == e_rs1) ex_rs1 = w_value;
+        
+        ex_rs2 = e_rs2_val;
+        if (e_rs2 == 5'h0) ex_rs2 = 32'h0;
+        else if (m_valid && m_reg_write && !m_is_load && m_rd == e_rs2) ex_rs2 = m_result;
+        else if (w_valid && w_reg_write && w_rd == e_rs2) ex_rs2 = w_value;
+    end
+    
+    assign ex_a = e_use_pc ? e_pc : ex_rs1;
+    assign ex_b = e_use_imm ? e_imm : ex_rs2;
+    assign ex_alu = alu(e_alu_op, ex_a, ex_b);
+    
+    assign ex_taken = e_is_jal || e_is_jalr || (e_is_branch && branch_cond(e_funct3, ex_rs1, ex_rs2));
+    assign ex_target = e_is_jalr ? ((ex_rs1 + e_imm) & ~32'h1) : (e_pc + e_imm);
+    assign ex_redirect_pc = ex_taken ? ex_target : (e_pc + 32'h4);
+    // JALR is never predicted; FENCE.I refetches the next instruction
+    assign ex_redirect = e_valid && (e_is_jalr || e_is_fence_i || (ex_taken != e_pred_taken));
+    
+    // Ring/status instructions carry the unit index in rs1; matmul setup and
+    // result use the rs1 register number, as before
+    assign gpu_unit_sel = ex_rs1[UNIT_BITS-1:0];
+    assign gpu_reg_sel = e_rs1[UNIT_BITS-1:0];
+    
+    always_comb begin
+        gpu_result = 32'h0;
+        gpu_wait = 1'b0;
+        if (e_inst[6:0] == GPU_STATUS) begin
+            case (e_funct3)
+                GPU_FN_STATUS: gpu_result = {31'h0, gpu_unit_busy[gpu_unit_sel]}; // Including queued work
+                GPU_FN_RING_TAIL: gpu_result = {24'h0, gpu_ring_tail[gpu_unit_sel]}; // Retired so far
+                default: gpu_result = 32'h0;
+            endcase
+        end else if (e_funct3 == GPU_FN_RESULT) begin
+            // Result reads wait for the unit to finish
+            gpu_result = gpu_matrix_c[gpu_reg_sel];
+            gpu_wait = gpu_unit_busy[gpu_reg_sel];
+        end
+    end
+    
+    logic [31:0] csr_rdata;
+    
+    always_comb begin
+        case (e_inst[31:20])
+            CSR_CYCLE, CSR_TIME, CSR_MCYCLE:       csr_rdata = cycle_count[31:0];
+            CSR_CYCLEH, CSR_TIMEH, CSR_MCYCLEH:    csr_rdata = cycle_count[63:32];
+            CSR_INSTRET, CSR_MINSTRET:             csr_rdata = instret_count[31:0];
+            CSR_INSTRETH, CSR_MINSTRETH:           csr_rdata = instret_count[63:32];
+            CSR_MHARTID:                           csr_rdata = 32'(HART_ID);
+            default:                               csr_rdata = 32'h0;
+        endcase
+    end
+    
+    assign ex_result = (e_is_jal || e_is_jalr) ? (e_pc + 32'h4) :
+                       e_is_csr ? csr_rdata :
+                       e_is_gpu ? gpu_result :
+                       e_is_simd ? simd_exec(e_inst[31:25], e_funct3, ex_rs1, ex_rs2) : ex_alu;
+    
+    // ---------------------------------------------------------------
+    // MEM: data access through the shared port
+    // ---------------------------------------------------------------
+    logic mem_need, mem_rmw, mem_done;
+    
+    assign mem_need = m_valid && (m_is_load || m_is_store);
+    // Byte and halfword stores read the word first, then write it back
+    // merged; AMOs write back the updated word
+    assign mem_rmw = m_is_amo || (m_is_store && m_funct3[1:0] != 2'b10);
+    assign mem_done = mem_req && mem_ack && !port_is_fetch && !(mem_rmw && !rmw_phase);
+    
+    // ---------------------------------------------------------------
+    // Stall and flush control
+    // ---------------------------------------------------------------
+    logic mem_stall, ex_stall;
+    logic m_advance, e_advance, d_advance;
+    logic id_redirect;
+    
+    assign mem_stall = mem_need && !mem_done;
+    // GPU instructions issue alone from EX: everything older has completed
+    // its memory access by the time they fire
+    assign ex_stall = e_valid && e_is_gpu && gpu_wait;
+    assign m_advance = !mem_stall;
+    assign e_advance = m_advance && !ex_stall;
+    
+    logic fence_i_retire;
+    assign fence_i_retire = e_advance && e_valid && e_is_fence_i;
+    assign d_advance = e_advance && !load_use;
+    assign id_redirect = d_valid && d_advance && d_predict_taken && !ex_redirect;
     
-    // Main CPU pipeline
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            pc <= 32'h0;
-            current_stage <= FETCH;
+            pc_f <= 32'h0;
+            d_valid <= 1'b0;
+            e_valid <= 1'b0;
+            m_valid <= 1'b0;
+            w_valid <= 1'b0;
+            cycle_count <= 64'h0;
+            instret_count <= 64'h0;
             for (int i = 0; i < 32; i++) begin
                 registers[i] <= 32'h0;
             end
-            gpu_unit_start <= 8'h0;
+            
+            mem_req <= 1'b0;
+            mem_we <= 1'b0;
+            mem_addr <= 32'h0;
+            mem_wdata <= 32'h0;
+            mem_lock <= 1'b0;
+            port_is_fetch <= 1'b0;
+            rmw_phase <= 1'b0;
+            refilling <= 1'b0;
+            refill_discard <= 1'b0;
+            refill_word <= '0;
+            ic_valid <= '0;
+            
+            gpu_unit_start <= '0;
+            gpu_ring_base_we <= '0;
+            gpu_ring_head_we <= '0;
+            for (int i = 0; i < NUM_GPU_UNITS; i++) begin
+                gpu_ring_base[i] <= 32'h0;
+                gpu_ring_head[i] <= 8'h0;
+            end
         end else begin
-            case (current_stage)
-                FETCH: begin
-                    mem_addr <= pc;
-                    mem_req <= 1'b1;
-                    mem_we <= 1'b0;
-                    if (mem_ack) begin
-                        instruction <= mem_rdata;
-                        current_stage <= DECODE;
-                        mem_req <= 1'b0;
-                    end
-                end
+            gpu_unit_start <= '0; // Start and ring writes are one-cycle pulses
+            gpu_ring_base_we <= '0;
+            gpu_ring_head_we <= '0;
+            
+            cycle_count <= cycle_count + 64'h1;
+            if (w_valid) begin
+                instret_count <= instret_count + 64'h1;
+            end
+            
+            // WB
+            if (w_valid && w_reg_write && w_rd != 5'h0) begin // x0 is hardwired to 0
+                registers[w_rd] <= w_value;
+            end
+            
+            // MEM -> WB
+            w_valid <= m_valid && m_advance;
+            if (m_advance) begin
+                w_pc <= m_pc;
+                w_inst <= m_inst;
+                w_rd <= m_rd;
+                w_reg_write <= m_reg_write;
+                w_value <= m_is_amo ? rmw_word :
+                           m_is_load ? load_extend(mem_rdata, m_funct3, m_result[1:0]) : m_result;
+            end
+            
+            // EX -> MEM
+            if (e_advance) begin
+                m_valid <= e_valid;
+                m_pc <= e_pc;
+                m_inst <= e_inst;
+                m_rd <= e_rd;
+                m_funct3 <= e_funct3;
+                m_reg_write <= e_reg_write;
+                m_is_load <= e_is_load;
+                m_is_store <= e_is_store;
+                m_is_amo <= e_is_amo;
+                m_result <= ex_result;
+                m_store_data <= ex_rs2;
                 
-                DECODE: begin
-                    // Decode instruction and prepare operands
-                    alu_a <= registers[rs1];
-                    case (opcode)
-                        7'b0010011: begin // I-type (ADDI, etc.)
-                            immediate <= {{20{instruction[31]}}, instruction[31:20]};
-                            alu_b <= immediate;
-                            alu_op <= (funct3 == 3'b000) ? 4'b0000 : 4'b0001; // ADD/SUB
+                if (e_valid && e_is_gpu && e_inst[6:0] == GPU_MATMUL) begin
+                    case (e_funct3)
+                        GPU_FN_MATMUL: begin // Matrix multiply setup
+                            if (!gpu_unit_busy[gpu_reg_sel]) begin
+                                gpu_matrix_a[gpu_reg_sel] <= ex_rs1;
+                                gpu_matrix_b[gpu_reg_sel] <= ex_rs2;
+                                gpu_unit_start[gpu_reg_sel] <= 1'b1;
+                            end
                         end
-                        7'b0110011: begin // R-type (ADD, SUB, etc.)
-                            alu_b <= registers[rs2];
-                            alu_op <= (funct3 == 3'b000) ? 
-                                     ((funct7 == 7'b0000000) ? 4'b0000 : 4'b0001) : // ADD/SUB
-                                     4'b0010; // Other ops
+                        GPU_FN_RING_BASE: begin // Point unit at its descriptor ring
+                            gpu_ring_base[gpu_unit_sel] <= ex_rs2;
+                            gpu_ring_base_we[gpu_unit_sel] <= 1'b1;
                         end
-                        GPU_MATMUL: begin // Custom GPU matrix multiply
-                            gpu_instruction <= 1'b1;
+                        GPU_FN_DOORBELL: begin // Publish new ring head (non-blocking)
+                            gpu_ring_head[gpu_unit_sel] <= ex_rs2[7:0];
+                            gpu_ring_head_we[gpu_unit_sel] <= 1'b1;
                         end
                         default: begin
-                            alu_op <= 4'b0000;
                         end
                     endcase
-                    current_stage <= EXECUTE;
                 end
                 
-                EXECUTE: begin
-                    if (gpu_instruction) begin
-                        // Handle GPU instructions
-                        case (funct3)
-                            3'b000: begin // Matrix multiply setup
-                                if (!gpu_unit_busy[rs1[2:0]]) begin
-                                    gpu_matrix_a[rs1[2:0]] <= registers[rs1];
-                                    gpu_matrix_b[rs1[2:0]] <= registers[rs2];
-                                    gpu_unit_start[rs1[2:0]] <= 1'b1;
-                                end
-                            end
-                            3'b001: begin // Get result
-                                if (!gpu_unit_busy[rs1[2:0]]) begin
-                                    registers[rd] <= gpu_matrix_c[rs1[2:0]];
-                                end
-                            end
-                        endcase
-                        gpu_instruction <= 1'b0;
-                    end else begin
-                        // Standard ALU operations
-                        case (alu_op)
-                            4'b0000: alu_result <= alu_a + alu_b;  // ADD
-                            4'b0001: alu_result <= alu_a - alu_b;  // SUB
-                            4'b0010: alu_result <= alu_a & alu_b;  // AND
-                            4'b0011: alu_result <= alu_a | alu_b;  // OR
-                            4'b0100: alu_result <= alu_a ^ alu_b;  // XOR
-                            4'b0101: alu_result <= alu_a << alu_b[4:0]; // SLL
-                            4'b0110: alu_result <= alu_a >> alu_b[4:0]; // SRL
-                            4'b0111: alu_result <= $signed(alu_a) >>> alu_b[4:0]; // SRA
-                            default: alu_result <= 32'h0;
-                        endcase
-                    end
-                    current_stage <= MEMORY;
+                if (fence_i_retire) begin
+                    ic_valid <= '0;
+                    if (refilling) refill_discard <= 1'b1;
                 end
-                
-                MEMORY: begin
-                    // Handle memory operations (load/store)
-                    case (opcode)
-                        7'b0000011: begin // Load
-                            mem_addr <= alu_result;
-                            mem_req <= 1'b1;
-                            mem_we <= 1'b0;
-                            if (mem_ack) begin
-                                registers[rd] <= mem_rdata;
-                                mem_req <= 1'b0;
-                                current_stage <= WRITEBACK;
-                            end
-                        end
-                        7'b0100011: begin // Store
-                            mem_addr <= alu_result;
-                            mem_wdata <= registers[rs2];
-                            mem_req <= 1'b1;
-                            mem_we <= 1'b1;
-                            if (mem_ack) begin
-                                mem_req <= 1'b0;
-                                current_stage <= WRITEBACK;
-                            end
+            end else if (m_advance) begin
+                m_valid <= 1'b0;
+            end
+            
+            // ID -> EX
+            if (d_advance) begin
+                e_valid <= d_valid && !ex_redirect;
+                e_pc <= d_pc;
+                e_inst <= d_inst;
+                e_rd <= d_rd;
+                e_rs1 <= d_rs1;
+                e_rs2 <= d_rs2;
+                e_funct3 <= d_funct3;
+                e_rs1_val <= d_rs1_val;
+                e_rs2_val <= d_rs2_val;
+                e_imm <= d_imm;
+                e_alu_op <= d_alu_op;
+                e_use_imm <= d_use_imm;
+                e_use_pc <= d_use_pc;
+                e_reg_write <= d_reg_write && d_rd != 5'h0;
+                e_is_load <= d_is_load;
+                e_is_store <= d_is_store;
+                e_is_branch <= d_is_branch;
+                e_is_jal <= d_is_jal;
+                e_is_jalr <= d_is_jalr;
+                e_is_gpu <= d_is_gpu;
+                e_is_simd <= d_is_simd;
+                e_is_csr <= d_is_csr;
+                e_is_fence_i <= d_is_fence_i;
+                e_is_amo <= d_is_amo;
+                e_pred_taken <= d_predict_taken;
+            end else if (e_advance) begin
+                e_valid <= 1'b0; // Load-use bubble
+            end else begin
+                // Held in EX: keep forwarded operands, the producers may retire
+                e_rs1_val <= ex_rs1;
+                e_rs2_val <= ex_rs2;
+            end
+            
+            // IF -> ID
+            if (e_advance && ex_redirect) begin
+                pc_f <= ex_redirect_pc;
+                d_valid <= 1'b0;
+            end else if (id_redirect) begin
+                pc_f <= d_pc + d_imm;
+                d_valid <= 1'b0;
+            end else if (d_advance) begin
+                d_valid <= f_hit;
+                d_pc <= pc_f;
+                d_inst <= ic_data[f_index][f_word];
+                if (f_hit) pc_f <= pc_f + 32'h4;
+            end
+            
+            // Memory port
+            if (mem_req) begin
+                if (mem_ack) begin
+                    mem_req <= 1'b0;
+                    if (port_is_fetch) begin
+                        ic_data[refill_addr[IC_INDEX_BITS+IC_WORD_BITS+1:IC_WORD_BITS+2]][refill_word] <= mem_rdata;
+                        refill_word <= refill_word + 1'b1;
+                        if (refill_word == IC_WORD_BITS'(ICACHE_LINE_WORDS - 1)) begin
+                            ic_tag[refill_addr[IC_INDEX_BITS+IC_WORD_BITS+1:IC_WORD_BITS+2]] <=
+                                refill_addr[31:IC_INDEX_BITS+IC_WORD_BITS+2];
+                            ic_valid[refill_addr[IC_INDEX_BITS+IC_WORD_BITS+1:IC_WORD_BITS+2]] <=
+                                !refill_discard && !fence_i_retire;
+                            refill_discard <= 1'b0;
+                            refilling <= 1'b0;
                         end
-                        default: current_stage <= WRITEBACK;
-                    endcase
-                end
-                
-                WRITEBACK: begin
-                    // Write back results to register file
-                    if (rd != 5'h0 && !gpu_instruction) begin // x0 is hardwired to 0
-                        case (opcode)
-                            7'b0010011, 7'b0110011: registers[rd] <= alu_result;
-                            // Load instructions already handled in MEMORY stage
-                        endcase
+                    end else if (mem_rmw && !rmw_phase) begin
+                        rmw_phase <= 1'b1;
+                        rmw_word <= mem_rdata;
+                    end else begin
+                        rmw_phase <= 1'b0;
+                        mem_lock <= 1'b0;
                     end
-                    
-                    // Advance PC and return to fetch
-                    pc <= pc + 4;
-                    current_stage <= FETCH;
-                    gpu_unit_start <= 8'h0; // Clear GPU start signals
                 end
-            endcase
+            end else if (mem_need) begin
+                // Data accesses go ahead of refills
+                mem_addr <= {m_result[31:2], 2'b00};
+                mem_we <= m_is_store && (!mem_rmw || rmw_phase);
+                mem_wdata <= m_is_amo ? amo_exec(m_inst[31:27], rmw_word, m_store_data) :
+                                        store_merge(rmw_word, m_store_data, m_funct3, m_result[1:0]);
+                mem_lock <= mem_rmw;
+                mem_req <= 1'b1;
+                port_is_fetch <= 1'b0;
+            end else if (refilling) begin
+                mem_addr <= {refill_addr[31:IC_WORD_BITS+2], refill_word, 2'b00};
+                mem_we <= 1'b0;
+                mem_req <= 1'b1;
+                port_is_fetch <= 1'b1;
+            end
+            
+            // Start a refill on an instruction cache miss. The old line goes
+            // invalid now: its words are overwritten one at a time.
+            if (!refilling && !f_hit) begin
+                ic_valid[f_index] <= 1'b0;
+                refilling <= 1'b1;
+                refill_addr <= pc_f;
+                refill_word <= '0;
+            end
         end
     end
+    
+    // ---------------------------------------------------------------
+    // Helper functions
+    // ---------------------------------------------------------------
+    function automatic alu_op_t alu_decode(
+        input logic [2:0] funct3,
+        input logic [6:0] funct7,
+        input logic is_imm
+    );
+        case (funct3)
+            3'b000: return (!is_imm && funct7[5]) ? ALU_SUB : ALU_ADD;
+            3'b001: return ALU_SLL;
+            3'b010: return ALU_SLT;
+            3'b011: return ALU_SLTU;
+            3'b100: return ALU_XOR;
+            3'b101: return funct7[5] ? ALU_SRA : ALU_SRL;
+            3'b110: return ALU_OR;
+            default: return ALU_AND;
+        endcase
+    endfunction
+    
+    function automatic logic [31:0] alu(
+        input alu_op_t op,
+        input logic [31:0] a,
+        input logic [31:0] b
+    );
+        case (op)
+            ALU_ADD: return a + b;
+            ALU_SUB: return a - b;
+            ALU_SLL: return a << b[4:0];
+            ALU_SLT: return {31'h0, $signed(a) < $signed(b)};
+            ALU_SLTU: return {31'h0, a < b};
+            ALU_XOR: return a ^ b;
+            ALU_SRL: return a >> b[4:0];
+            ALU_SRA: return $signed(a) >>> b[4:0];
+            ALU_OR: return a | b;
+            ALU_AND: return a & b;
+            ALU_PASS_B: return b;
+            default: return 32'h0;
+        endcase
+    endfunction
+    
+    function automatic logic branch_cond(
+        input logic [2:0] funct3,
+        input logic [31:0] a,
+        input logic [31:0] b
+    );
+        case (funct3)
+            3'b000: return a == b;                    // BEQ
+            3'b001: return a != b;                    // BNE
+            3'b100: return $signed(a) < $signed(b);   // BLT
+            3'b101: return $signed(a) >= $signed(b);  // BGE
+            3'b110: return a < b;                     // BLTU
+            3'b111: return a >= b;                    // BGEU
+            default: return 1'b0;
+        endcase
+    endfunction
+    
+    // Packed SIMD: the same op on every lane of rs1/rs2
+    function automatic logic [31:0] simd_exec(
+        input logic [6:0] op,
+        input logic [2:0] width,
+        input logic [31:0] a,
+        input logic [31:0] b
+    );
+        logic [31:0] result;
+        
+        result = '0;
+        if (width == SIMD_W16 && op == SIMD_NARROW) begin
+            result = {sat8(32'($signed(b[31:16]))), sat8(32'($signed(b[15:0]))),
+                      sat8(32'($signed(a[31:16]))), sat8(32'($signed(a[15:0])))};
+        end else if (width == SIMD_W16) begin
+            for (int i = 0; i < 2; i++) begin
+                result[i*16 +: 16] = simd_lane16(op, a[i*16 +: 16], b[i*16 +: 16], b[3:0]);
+            end
+        end else begin
+            for (int i = 0; i < 4; i++) begin
+                result[i*8 +: 8] = simd_lane8(op, a[i*8 +: 8], b[i*8 +: 8], b[2:0]);
+            end
+        end
+        return result;
+    endfunction
+    
+    function automatic logic [7:0] simd_lane8(
+        input logic [6:0] op,
+        input logic [7:0] a,
+        input logic [7:0] b,
+        input logic [2:0] shamt
+    );
+        logic signed [31:0] sa, sb;
+        
+        sa = 32'($signed(a));
+        sb = 32'($signed(b));
+        case (op)
+            SIMD_ADD: return a + b;
+            SIMD_SUB: return a - b;
+            SIMD_KADD: return sat8(sa + sb);
+            SIMD_KSUB: return sat8(sa - sb);
+            SIMD_MAX: return (sa > sb) ? a : b;
+            SIMD_MIN: return (sa < sb) ? a : b;
+            SIMD_SRA: return 8'(sa >>> shamt);
+            SIMD_KMUL: return sat8(sa * sb);
+            default: return 8'h0;
+        endcase
+    endfunction
+    
+    function automatic logic [15:0] simd_lane16(
+        input logic [6:0] op,
+        input logic [15:0] a,
+        input logic [15:0] b,
+        input logic [3:0] shamt
+    );
+        logic signed [31:0] sa, sb;
+        
+        sa = 32'($signed(a));
+        sb = 32'($signed(b));
+        case (op)
+            SIMD_ADD: return a + b;
+            SIMD_SUB: return a - b;
+            SIMD_KADD: return sat16(sa + sb);
+            SIMD_KSUB: return sat16(sa - sb);
+            SIMD_MAX: return (sa > sb) ? a : b;
+            SIMD_MIN: return (sa < sb) ? a : b;
+            SIMD_SRA: return 16'(sa >>> shamt);
+            SIMD_KMUL: return sat16(sa * sb);
+            default: return 16'h0;
+        endcase
+    endfunction
+    
+    function automatic logic [7:0] sat8(input logic signed [31:0] value);
+        if (value > 127) return 8'h7f;
+        if (value < -128) return 8'h80;
+        return value[7:0];
+    endfunction
+    
+    function automatic logic [15:0] sat16(input logic signed [31:0] value);
+        if (value > 32767) return 16'h7fff;
+        if (value < -32768) return 16'h8000;
+        return value[15:0];
+    endfunction
+    
+    // LB/LH/LW/LBU/LHU from the addressed word
+    function automatic logic [31:0] load_extend(
+        input logic [31:0] word,
+        input logic [2:0] funct3,
+        input logic [1:0] byte_offset
+    );
+        logic [31:0] shifted;
+        
+        shifted = word >> (byte_offset * 8);
+        case (funct3)
+            3'b000: return {{24{shifted[7]}}, shifted[7:0]};
+            3'b001: return {{16{shifted[15]}}, shifted[15:0]};
+            3'b100: return {24'h0, shifted[7:0]};
+            3'b101: return {16'h0, shifted[15:0]};
+            default: return word;
+        endcase
+    endfunction
+    
+    // New memory word of an AMO from the old one and rs2
+    function automatic logic [31:0] amo_exec(
+        input logic [4:0] op,
+        input logic [31:0] old_word,
+        input logic [31:0] operand
+    );
+        case (op)
+            AMO_ADD:  return old_word + operand;
+            AMO_SWAP: return operand;
+            AMO_XOR:  return old_word ^ operand;
+            AMO_OR:   return old_word | operand;
+            AMO_AND:  return old_word & operand;
+            AMO_MIN:  return ($signed(old_word) < $signed(operand)) ? old_word : operand;
+            AMO_MAX:  return ($signed(old_word) > $signed(operand)) ? old_word : operand;
+            AMO_MINU: return (old_word < operand) ? old_word : operand;
+            AMO_MAXU: return (old_word > operand) ? old_word : operand;
+            default:  return old_word;
+        endcase
+    endfunction
+    
+    // SB/SH merge into the word read back; SW replaces it
+    function automatic logic [31:0] store_merge(
+        input logic [31:0] old_word,
+        input logic [31:0] data,
+        input logic [2:0] funct3,
+        input logic [1:0] byte_offset
+    );
+        logic [31:0] result;
+        
+        result = old_word;
+        case (funct3[1:0])
+            2'b00: result[byte_offset*8 +: 8] = data[7:0];
+            2'b01: result[byte_offset[1]*16 +: 16] = data[15:0];
+            default: result = data;
+        endcase
+        return result;
+    endfunction
 
 endmodule
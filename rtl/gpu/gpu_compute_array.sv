@@ -1,26 +1,74 @@
-// GPU Compute Array with 8 compute units for matrix operations
+// GPU Compute Array with NUM_UNITS (default 8) compute units for matrix operations
 // Each unit performs 4x4 matrix multiply-accumulate operations
+// Memory fabric is split-transaction: requests are tagged with the unit ID,
+// one can issue per cycle and every unit can have one in flight. Addresses in
+// the scratchpad window go to the scratchpad port instead and never reach the
+// memory controller.
 
 module gpu_compute_array #(
-    parameter NUM_UNITS = 8
+    parameter NUM_UNITS = 8,
+    parameter LINE_WIDTH = 512,
+    parameter TAG_WIDTH = 8,  // Request tag width; must cover NUM_UNITS
+    parameter SPAD_BASE = 32'h10010000,
+    parameter SPAD_SIZE = 32'h00010000  // 64KB
 ) (
     input  logic clk,
     input  logic rst_n,
     
-    // Memory interface
+    // Memory interface: mem_req is held until mem_gnt accepts it; mem_ack
+    // returns the response for the request tagged mem_rtag
     output logic [31:0] mem_addr,
     output logic [31:0] mem_wdata,
     input  logic [31:0] mem_rdata,
     output logic mem_req,
     output logic mem_we,
+    output logic [TAG_WIDTH-1:0] mem_tag,
+    input  logic mem_gnt,
     input  logic mem_ack,
+    input  logic [TAG_WIDTH-1:0] mem_rtag,
+    output logic mem_line,
+    output logic [LINE_WIDTH/32-1:0] mem_wmask,
+    output logic [LINE_WIDTH-1:0] mem_line_wdata,
+    input  logic [LINE_WIDTH-1:0] mem_line_rdata,
+    
+    // Scratchpad interface: spad_req is a one-cycle strobe answered by
+    // spad_ack on the next cycle
+    output logic spad_req,
+    output logic spad_we,
+    output logic [31:0] spad_addr,
+    output logic [31:0] spad_wdata,
+    input  logic [31:0] spad_rdata,
+    output logic spad_line,
+    output logic [LINE_WIDTH/32-1:0] spad_wmask,
+    output logic [LINE_WIDTH-1:0] spad_line_wdata,
+    input  logic [LINE_WIDTH-1:0] spad_line_rdata,
+    input  logic spad_ack,
     
     // Control interface from CPU
     output logic [NUM_UNITS-1:0] unit_busy,
     input  logic [NUM_UNITS-1:0] unit_start,
     input  logic [31:0] matrix_a [NUM_UNITS-1:0],
     input  logic [31:0] matrix_b [NUM_UNITS-1:0],
-    output logic [31:0] matrix_c [NUM_UNITS-1:0]
+    input  logic [15:0] unit_config [NUM_UNITS-1:0],
+    output logic [31:0] matrix_c [NUM_UNITS-1:0],
+    
+    // Per-unit command rings
+    input  logic [31:0] ring_base [NUM_UNITS-1:0],
+    input  logic [7:0] ring_head [NUM_UNITS-1:0],
+    output logic [7:0] ring_tail [NUM_UNITS-1:0],
+    
+    // Performance counters: per unit (see gpu_compute_unit) and for the
+    // fabric arbiter. arb_waits adds one per cycle for every unit held back
+    // by another unit's grant; fabric_stalls counts cycles mem_req waits for
+    // mem_gnt.
+    output logic [31:0] unit_busy_cycles [NUM_UNITS-1:0],
+    output logic [31:0] unit_stall_cycles [NUM_UNITS-1:0],
+    output logic [31:0] unit_mem_wait_cycles [NUM_UNITS-1:0],
+    output logic [31:0] unit_macs [NUM_UNITS-1:0],
+    output logic [31:0] unit_ops [NUM_UNITS-1:0],
+    output logic [31:0] arb_grants,
+    output logic [31:0] arb_waits,
+    output logic [31:0] fabric_stalls
 );
 
     // Internal signals for each compute unit
@@ -30,17 +78,41 @@ module gpu_compute_array #(
     logic [31:0] unit_mem_wdata [NUM_UNITS-1:0];
     logic [31:0] unit_mem_rdata [NUM_UNITS-1:0];
     logic [NUM_UNITS-1:0] unit_mem_ack;
+    logic [NUM_UNITS-1:0] ext_mem_ack;
+    logic [NUM_UNITS-1:0] unit_mem_line;
+    logic [LINE_WIDTH/32-1:0] unit_mem_wmask [NUM_UNITS-1:0];
+    logic [LINE_WIDTH-1:0] unit_mem_line_wdata [NUM_UNITS-1:0];
     logic [NUM_UNITS-1:0] unit_done;
     
+    // Line read data is only consumed by the unit being acked, so one
+    // register is shared by all units
+    logic [LINE_WIDTH-1:0] line_rdata_q;
+    
     // Memory arbiter state
-    logic [2:0] current_unit;
-    logic arbiter_busy;
+    localparam UNIT_BITS = (NUM_UNITS > 1) ? $clog2(NUM_UNITS) : 1;
+    
+    logic [UNIT_BITS-1:0] rr_ptr;
+    logic [NUM_UNITS-1:0] unit_outstanding;
+    logic issue_free;
+    logic grant_valid;
+    logic [UNIT_BITS-1:0] grant_unit;
+    logic [UNIT_BITS-1:0] resp_unit;
+    
+    // Scratchpad arbiter state; spad_resp marks the unit answered this cycle
+    logic [NUM_UNITS-1:0] unit_in_spad;
+    logic [UNIT_BITS-1:0] spad_rr_ptr;
+    logic spad_grant_valid;
+    logic [UNIT_BITS-1:0] spad_grant_unit;
+    logic [NUM_UNITS-1:0] spad_resp;
     
     // Generate compute units
     genvar i;
     generate
         for (i = 0; i < NUM_UNITS; i++) begin : gpu_units
-            gpu_compute_unit unit (
+            gpu_compute_unit #(
+                .LINE_WIDTH(LINE_WIDTH),
+                .BURST_EN(1)
+            ) unit (
                 .clk(clk),
                 .rst_n(rst_n),
                 .start(unit_start[i]),
@@ -49,50 +121,157 @@ module gpu_compute_array #(
                 .matrix_a_addr(matrix_a[i]),
                 .matrix_b_addr(matrix_b[i]),
                 .matrix_c_addr(matrix_c[i]),
+                .operation_config(unit_config[i]),
+                .ring_base(ring_base[i]),
+                .ring_head(ring_head[i]),
+                .ring_tail(ring_tail[i]),
                 .mem_addr(unit_mem_addr[i]),
                 .mem_wdata(unit_mem_wdata[i]),
-                .mem_rdata(unit_mem_rdata[i]),
+                .mem_rdata(spad_resp[i] ? spad_rdata : unit_mem_rdata[i]),
                 .mem_req(unit_mem_req[i]),
                 .mem_we(unit_mem_we[i]),
-                .mem_ack(unit_mem_ack[i])
+                .mem_ack(unit_mem_ack[i]),
+                .mem_line(unit_mem_line[i]),
+                .mem_wmask(unit_mem_wmask[i]),
+                .mem_line_wdata(unit_mem_line_wdata[i]),
+                .mem_line_rdata(spad_resp[i] ? spad_line_rdata : line_rdata_q),
+                .perf_busy_cycles(unit_busy_cycles[i]),
+                .perf_stall_cycles(unit_stall_cycles[i]),
+                .perf_mem_wait_cycles(unit_mem_wait_cycles[i]),
+                .perf_macs(unit_macs[i]),
+                .perf_ops(unit_ops[i])
             );
         end
     endgenerate
     
-    // Simple round-robin memory arbiter with GPU priority
+    always_comb begin
+        for (int j = 0; j < NUM_UNITS; j++) begin
+            unit_in_spad[j] = (unit_mem_addr[j] >= SPAD_BASE) &&
+                              (unit_mem_addr[j] < SPAD_BASE + SPAD_SIZE);
+        end
+    end
+    
+    assign unit_mem_ack = ext_mem_ack | (spad_resp & {NUM_UNITS{spad_ack}});
+    
+    // Units the fabric arbiter could grant this cycle
+    logic [NUM_UNITS-1:0] unit_eligible;
+    logic [UNIT_BITS:0] eligible_count;
+    
+    always_comb begin
+        eligible_count = '0;
+        for (int j = 0; j < NUM_UNITS; j++) begin
+            unit_eligible[j] = unit_mem_req[j] && !unit_in_spad[j] &&
+                               !unit_outstanding[j] && !unit_mem_ack[j];
+            eligible_count = eligible_count + (UNIT_BITS+1)'(unit_eligible[j]);
+        end
+    end
+    
+    // Oldest-first round robin over units with no request in flight. A unit
+    // whose ack is still visible has not advanced its address yet, so skip it.
+    always_comb begin
+        grant_valid = 1'b0;
+        grant_unit = '0;
+        for (int j = 0; j < NUM_UNITS; j++) begin
+            int unit_idx;
+            unit_idx = (rr_ptr + j) % NUM_UNITS;
+            if (!grant_valid && unit_eligible[unit_idx]) begin
+                grant_valid = 1'b1;
+                grant_unit = unit_idx[UNIT_BITS-1:0];
+            end
+        end
+    end
+    
+    // The scratchpad has its own round robin, so one scratchpad and one
+    // fabric request can both start in the same cycle
+    always_comb begin
+        spad_grant_valid = 1'b0;
+        spad_grant_unit = '0;
+        for (int j = 0; j < NUM_UNITS; j++) begin
+            int unit_idx;
+            unit_idx = (spad_rr_ptr + j) % NUM_UNITS;
+            if (!spad_grant_valid && unit_mem_req[unit_idx] && unit_in_spad[unit_idx] &&
+                !unit_mem_ack[unit_idx]) begin
+                spad_grant_valid = 1'b1;
+                spad_grant_unit = unit_idx[UNIT_BITS-1:0];
+            end
+        end
+    end
+    
+    // Scratchpad requests go straight from the granted unit, no issue register
+    assign spad_req = spad_grant_valid;
+    assign spad_we = unit_mem_we[spad_grant_unit];
+    assign spad_addr = unit_mem_addr[spad_grant_unit];
+    assign spad_wdata = unit_mem_wdata[spad_grant_unit];
+    assign spad_line = unit_mem_line[spad_grant_unit];
+    assign spad_wmask = unit_mem_wmask[spad_grant_unit];
+    assign spad_line_wdata = unit_mem_line_wdata[spad_grant_unit];
+    
+    // The issue register can take a new request once the current one is accepted
+    assign issue_free = !mem_req || mem_gnt;
+    assign resp_unit = mem_rtag[UNIT_BITS-1:0];
+    
+    // Pipelined arbiter: issue and response paths run independently
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            current_unit <= 3'h0;
-            arbiter_busy <= 1'b0;
+            rr_ptr <= '0;
+            unit_outstanding <= {NUM_UNITS{1'b0}};
             mem_req <= 1'b0;
             mem_we <= 1'b0;
+            mem_tag <= '0;
             mem_addr <= 32'h0;
             mem_wdata <= 32'h0;
+            mem_line <= 1'b0;
+            mem_wmask <= '0;
+            mem_line_wdata <= '0;
+            line_rdata_q <= '0;
+            ext_mem_ack <= {NUM_UNITS{1'b0}};
+            spad_rr_ptr <= '0;
+            spad_resp <= {NUM_UNITS{1'b0}};
+            arb_grants <= 32'h0;
+            arb_waits <= 32'h0;
+            fabric_stalls <= 32'h0;
         end else begin
-            if (!arbiter_busy) begin
-                // Find next unit requesting memory access
-                for (int j = 0; j < NUM_UNITS; j++) begin
-                    int unit_idx = (current_unit + j) % NUM_UNITS;
-                    if (unit_mem_req[unit_idx]) begin
-                        current_unit <= unit_idx[2:0];
-                        arbiter_busy <= 1'b1;
-                        mem_addr <= unit_mem_addr[unit_idx];
-                        mem_wdata <= unit_mem_wdata[unit_idx];
-                        mem_req <= 1'b1;
-                        mem_we <= unit_mem_we[unit_idx];
-                        break;
-                    end
+            // Acks are single-cycle pulses
+            ext_mem_ack <= {NUM_UNITS{1'b0}};
+            spad_resp <= {NUM_UNITS{1'b0}};
+            
+            // Issue: one request per cycle into the fabric
+            if (issue_free) begin
+                mem_req <= grant_valid;
+                if (grant_valid) begin
+                    mem_addr <= unit_mem_addr[grant_unit];
+                    mem_wdata <= unit_mem_wdata[grant_unit];
+                    mem_we <= unit_mem_we[grant_unit];
+                    mem_tag <= TAG_WIDTH'(grant_unit);
+                    mem_line <= unit_mem_line[grant_unit];
+                    mem_wmask <= unit_mem_wmask[grant_unit];
+                    mem_line_wdata <= unit_mem_line_wdata[grant_unit];
+                    unit_outstanding[grant_unit] <= 1'b1;
+                    rr_ptr <= UNIT_BITS'((grant_unit + 1) % NUM_UNITS);
                 end
-            end else if (mem_ack) begin
-                // Complete current transaction
-                unit_mem_rdata[current_unit] <= mem_rdata;
-                unit_mem_ack[current_unit] <= 1'b1;
-                mem_req <= 1'b0;
-                arbiter_busy <= 1'b0;
-                current_unit <= (current_unit + 1) % NUM_UNITS;
+            end
+            
+            // Response: route by tag back to the requesting unit
+            if (mem_ack) begin
+                unit_mem_rdata[resp_unit] <= mem_rdata;
+                line_rdata_q <= mem_line_rdata;
+                ext_mem_ack[resp_unit] <= 1'b1;
+                unit_outstanding[resp_unit] <= 1'b0;
+            end
+            
+            if (spad_grant_valid) begin
+                spad_resp[spad_grant_unit] <= 1'b1;
+                spad_rr_ptr <= UNIT_BITS'((spad_grant_unit + 1) % NUM_UNITS);
+            end
+            
+            // Arbiter statistics
+            if (issue_free && grant_valid) begin
+                arb_grants <= arb_grants + 1;
+                arb_waits <= arb_waits + 32'(eligible_count) - 1;
             end else begin
-                unit_mem_ack <= {NUM_UNITS{1'b0}};
+                arb_waits <= arb_waits + 32'(eligible_count);
             end
+            if (mem_req && !mem_gnt) fabric_stalls <= fabric_stalls + 1;
         end
     end
 
@@ -1,7 +1,17 @@
 // GPU Compute Unit - Single unit performing 4x4 matrix multiply-accumulate
-// Optimized for INT8/FP16 operations with high throughput
+// Operands are INT8, INT16 for transformed tiles (e.g. Winograd), INT4 or FP16
+// INT4 packs two operands per byte: a 16-byte load is a 4x8 A and 8x4 B tile,
+// so each op is a K=8 step and twice the MACs per byte fetched
+// Accumulates at 32 bits; C is written back as int16 or, in ACC32 mode, int32.
+// FP16 accumulates in fp32 and always stores fp32 words
+// Load, compute and store overlap: A/B operands are double-buffered and the
+// finished C tile drains from its own buffer while the next op computes
 
-module gpu_compute_unit (
+module gpu_compute_unit #(
+    parameter RING_DEPTH = 16,  // Command descriptors per ring (power of two)
+    parameter LINE_WIDTH = 512, // Memory line size for burst accesses
+    parameter BURST_EN = 1      // 1: line-wide accesses, 0: one word per handshake
+) (
     input  logic clk,
     input  logic rst_n,
     
@@ -14,144 +24,615 @@ module gpu_compute_unit (
     input  logic [31:0] matrix_a_addr,
     input  logic [31:0] matrix_b_addr,
     input  logic [31:0] matrix_c_addr,
+    input  logic [15:0] operation_config, // Config for direct starts
     
-    // Memory interface
+    // Command ring interface (descriptors live in memory)
+    input  logic [31:0] ring_base,
+    input  logic [7:0] ring_head,
+    output logic [7:0] ring_tail,
+    
+    // Memory interface (line accesses use a line-aligned mem_addr)
     output logic [31:0] mem_addr,
     output logic [31:0] mem_wdata,
     input  logic [31:0] mem_rdata,
     output logic mem_req,
     output logic mem_we,
-    input  logic mem_ack
+    input  logic mem_ack,
+    output logic mem_line,
+    output logic [LINE_WIDTH/32-1:0] mem_wmask,
+    output logic [LINE_WIDTH-1:0] mem_line_wdata,
+    input  logic [LINE_WIDTH-1:0] mem_line_rdata,
+    
+    // Performance counters, free running from reset
+    output logic [31:0] perf_busy_cycles,     // Any stage active or ring work queued
+    output logic [31:0] perf_stall_cycles,    // Busy but the MAC array is idle
+    output logic [31:0] perf_mem_wait_cycles, // Memory request waiting for its ack
+    output logic [31:0] perf_macs,
+    output logic [31:0] perf_ops              // Retired operations
 );
 
-    // State machine for matrix operations
-    typedef enum logic [3:0] {
-        IDLE,
-        LOAD_A,
-        LOAD_B,
-        COMPUTE,
-        STORE_C,
-        DONE_STATE
-    } state_t;
-    
-    state_t current_state, next_state;
-    
-    // Matrix storage (4x4 matrices, 8-bit elements)
-    logic [7:0] matrix_a [3:0][3:0];
-    logic [7:0] matrix_b [3:0][3:0];
-    logic [15:0] matrix_c [3:0][3:0]; // 16-bit for accumulation
+    // Ring descriptor layout: {a_addr, b_addr, c_addr, config}, 16 bytes each
+    localparam CMD_WORDS = 4;
+    localparam CMD_BYTES = CMD_WORDS * 4;
+    
+    // Operation config bits (descriptor config word / UNIT_CONFIG register)
+    localparam CFG_ACCUMULATE  = 0;  // Keep matrix_c from the previous op
+    localparam CFG_DEFER_STORE = 1;  // Skip the C write-back (partial sum)
+    localparam CFG_ACC32       = 2;  // Store C as 16 int32 words instead of int16
+    localparam CFG_PREC        = 3;  // Operand precision field, bits [4:3]
+    localparam CFG_UNIT_PREC   = 5;  // Descriptor only: use UNIT_CONFIG's precision
+    
+    // Operand precisions
+    localparam logic [1:0] PREC_INT8  = 2'd0;  // 16 bytes per A/B tile
+    localparam logic [1:0] PREC_INT16 = 2'd1;  // 32 bytes per A/B tile
+    localparam logic [1:0] PREC_INT4  = 2'd2;  // 16 bytes per 4x8 A / 8x4 B tile
+    localparam logic [1:0] PREC_FP16  = 2'd3;  // 32 bytes per A/B tile
+    
+    // Burst geometry: every transfer phase is at most 16 words
+    localparam LINE_OFFSET_BITS = $clog2(LINE_WIDTH / 8);
+    localparam XFER_MAX = 16;
+    
+    // Loader: fetches the next descriptor and its A/B tiles into a free bank
+    typedef enum logic [1:0] {
+        LD_IDLE,
+        LD_FETCH,
+        LD_OPERANDS
+    } load_state_t;
+    
+    // Compute: multiplies the oldest loaded bank into matrix_c
+    typedef enum logic [1:0] {
+        EX_IDLE,
+        EX_COMPUTE,
+        EX_HANDOFF
+    } exec_state_t;
+    
+    // Store: drains a finished C tile, then retires the op
+    typedef enum logic [1:0] {
+        ST_IDLE,
+        ST_STORE,
+        ST_RETIRE
+    } store_state_t;
+    
+    // Owner of the memory port; held from request until ack
+    typedef enum logic [1:0] {
+        PORT_NONE,
+        PORT_LOAD,
+        PORT_STORE
+    } port_t;
+    
+    load_state_t load_state;
+    exec_state_t exec_state;
+    store_state_t store_state;
+    port_t port_owner, port_sel;
+    
+    // Operand banks (4x4 matrices, 16-bit elements; INT8 tiles are sign
+    // extended on load, INT4 tiles hold elements k and k+4 of a row (A) or
+    // rows k and k+4 (B) as two sign extended bytes), one op per bank
+    logic [15:0] matrix_a [1:0][3:0][3:0];
+    logic [15:0] matrix_b [1:0][3:0][3:0];
+    logic [31:0] bank_c_addr [1:0];
+    logic [31:0] bank_config [1:0];
+    logic [1:0] bank_prec [1:0];
+    logic [1:0] bank_from_ring;
+    logic [1:0] bank_valid;
+    logic load_bank;
+    logic exec_bank;
+    
+    // Accumulators and the tile being drained by the store stage
+    logic [31:0] matrix_c [3:0][3:0];
+    logic [31:0] c_out [3:0][3:0];
     
     // Control counters
     logic [3:0] load_counter;
     logic [3:0] compute_counter;
-    logic [3:0] store_counter;
-    logic [1:0] row_idx, col_idx, k_idx;
+    logic [4:0] store_counter;
+    
+    // Command being loaded (from a direct start or the ring)
+    logic [31:0] ld_a_addr;
+    logic [31:0] ld_b_addr;
+    logic [31:0] ld_c_addr;
+    logic [31:0] ld_config;
+    logic ld_from_ring;
+    logic [1:0] ld_prec;
+    logic ld_wide;
+    logic [4:0] ld_words;
+    
+    // Command being computed, and the one being stored
+    logic [31:0] ex_c_addr;
+    logic [31:0] ex_config;
+    logic [1:0] ex_prec;
+    logic ex_from_ring;
+    logic [31:0] st_c_addr;
+    logic st_acc32;
+    logic st_from_ring;
+    
+    // Direct start, held until the loader can take it
+    logic start_pending;
+    logic [31:0] start_a_addr;
+    logic [31:0] start_b_addr;
+    logic [31:0] start_c_addr;
+    logic [15:0] start_config;
+    
+    // Ring pointers: fetch runs ahead of tail by the ops in flight
+    logic [7:0] ring_fetch;
+    logic ring_pending;
+    logic [31:0] ring_slot_addr;
+    logic [4:0] store_words;
+    logic load_ack, store_ack;
+    
+    // Current transfer phase: word w of the phase lives at xfer_addr[w]
+    logic [31:0] xfer_addr [XFER_MAX-1:0];
+    logic [31:0] xfer_word [XFER_MAX-1:0];
+    logic [XFER_MAX-1:0] xfer_take;
+    logic [4:0] xfer_index;
+    logic [4:0] xfer_end;
+    logic [4:0] xfer_count;
+    logic [4:0] xfer_next;
+    logic [31:0] xfer_line_addr;
+    
+    assign ring_pending = (ring_head != ring_fetch);
+    assign ring_slot_addr = ring_base + ((ring_fetch & (RING_DEPTH - 1)) * CMD_BYTES);
+    assign store_words = st_acc32 ? 5'd16 : 5'd8;
+    
+    assign ld_prec = ld_config[CFG_UNIT_PREC] ? operation_config[CFG_PREC +: 2] :
+                                                ld_config[CFG_PREC +: 2];
+    assign ld_wide = (ld_prec == PREC_INT16) || (ld_prec == PREC_FP16);
+    assign ld_words = ld_wide ? 5'd16 : 5'd8;
+    
+    // Queued descriptors count as busy so status polling covers the whole ring
+    assign busy = (load_state != LD_IDLE) || (exec_state != EX_IDLE) ||
+                  (store_state != ST_IDLE) || (bank_valid != 2'b00) ||
+                  start_pending || (ring_head != ring_tail);
+    assign done = (store_state == ST_RETIRE);
+    
+    // Stores go first so finished tiles free the output buffer quickly
+    always_comb begin
+        if (port_owner != PORT_NONE) port_sel = port_owner;
+        else if (store_state == ST_STORE) port_sel = PORT_STORE;
+        else if (load_state != LD_IDLE) port_sel = PORT_LOAD;
+        else port_sel = PORT_NONE;
+    end
+    
+    assign load_ack = mem_ack && (port_sel == PORT_LOAD);
+    assign store_ack = mem_ack && (port_sel == PORT_STORE);
+    
+    // Word addresses of the active transfer phase. A and B are one phase
+    // (8 words, 16 for INT16/FP16) so tiles sharing a line come back in one burst.
+    always_comb begin
+        for (int w = 0; w < XFER_MAX; w++) begin
+            if (port_sel == PORT_STORE) begin
+                xfer_addr[w] = st_c_addr + (w << 2);
+            end else if (load_state == LD_FETCH) begin
+                xfer_addr[w] = ring_slot_addr + (w << 2);
+            end else begin
+                xfer_addr[w] = (w < ld_words / 2) ? ld_a_addr + (w << 2) :
+                               ld_b_addr + ((w - ld_words / 2) << 2);
+            end
+        end
+    end
+    
+    always_comb begin
+        if (port_sel == PORT_STORE) begin
+            xfer_index = store_counter;
+            xfer_end = store_words;
+        end else if (port_sel == PORT_LOAD) begin
+            xfer_index = {1'b0, load_counter};
+            xfer_end = (load_state == LD_FETCH) ? CMD_WORDS : ld_words;
+        end else begin
+            xfer_index = 5'd0;
+            xfer_end = 5'd0;
+        end
+    end
+    
+    assign xfer_line_addr = {xfer_addr[xfer_index[3:0]][31:LINE_OFFSET_BITS],
+                             {LINE_OFFSET_BITS{1'b0}}};
+    
+    // Words served by one handshake: the next phase word, plus in burst mode
+    // every following phase word that falls in the same line
+    always_comb begin
+        logic in_run;
+        in_run = 1'b0;
+        xfer_count = 5'd0;
+        for (int w = 0; w < XFER_MAX; w++) begin
+            if (w == xfer_index) begin
+                in_run = 1'b1;
+            end else if (BURST_EN == 0 ||
+                         xfer_addr[w][31:LINE_OFFSET_BITS] != xfer_line_addr[31:LINE_OFFSET_BITS]) begin
+                in_run = 1'b0;
+            end
+            xfer_take[w] = in_run && (w < xfer_end);
+            if (xfer_take[w]) xfer_count = xfer_count + 5'd1;
+            
+            // Read data for phase word w from the line or the word port
+            if (BURST_EN != 0) begin
+                xfer_word[w] = mem_line_rdata[xfer_addr[w][LINE_OFFSET_BITS-1:2]*32 +: 32];
+            end else begin
+                xfer_word[w] = mem_rdata;
+            end
+        end
+    end
     
-    // MAC units for parallel computation
-    logic [15:0] mac_result [3:0][3:0];
-    logic [15:0] accumulator [3:0][3:0];
+    assign xfer_next = xfer_index + xfer_count;
     
-    assign busy = (current_state != IDLE);
-    assign done = (current_state == DONE_STATE);
+    // FP16 x FP16 -> FP32 is exact, so only the accumulate rounds. Subnormal
+    // fp16 inputs are normalized; no product is below 2^-48, so the fp32 side
+    // never sees subnormals.
+    function automatic logic [31:0] fp16_mul(input logic [15:0] a, input logic [15:0] b);
+        logic sign;
+        logic [10:0] ma, mb;
+        logic signed [9:0] xa, xb, e;
+        logic [21:0] p;
+        logic [23:0] m;
+        sign = a[15] ^ b[15];
+        if ((a[14:10] == 5'h1f && a[9:0] != 0) || (b[14:10] == 5'h1f && b[9:0] != 0) ||
+            (a[14:10] == 5'h1f && b[14:0] == 0) || (b[14:10] == 5'h1f && a[14:0] == 0)) begin
+            return 32'h7fc00000;  // NaN operand or inf * 0
+        end
+        if (a[14:10] == 5'h1f || b[14:10] == 5'h1f) return {sign, 8'hff, 23'h0};
+        if (a[14:0] == 0 || b[14:0] == 0) return {sign, 31'h0};
+        
+        ma = {a[14:10] != 0, a[9:0]};
+        mb = {b[14:10] != 0, b[9:0]};
+        xa = (a[14:10] != 0) ? 10'(a[14:10]) : 10'sd1;
+        xb = (b[14:10] != 0) ? 10'(b[14:10]) : 10'sd1;
+        for (int n = 0; n < 10; n++) begin
+            if (!ma[10]) begin
+                ma = ma << 1;
+                xa = xa - 10'sd1;
+            end
+            if (!mb[10]) begin
+                mb = mb << 1;
+                xb = xb - 10'sd1;
+            end
+        end
+        
+        // value = p * 2^(xa + xb - 50), rebiased to 127 with a 24-bit mantissa
+        p = ma * mb;
+        if (p[21]) begin
+            m = {p, 2'b00};
+            e = xa + xb + 10'sd98;
+        end else begin
+            m = {p[20:0], 3'b000};
+            e = xa + xb + 10'sd97;
+        end
+        return {sign, e[7:0], m[22:0]};
+    endfunction
+    
+    // FP32 add, round to nearest even; underflow flushes to zero
+    function automatic logic [31:0] fp32_add(input logic [31:0] x, input logic [31:0] y);
+        logic [31:0] a, b;
+        logic [26:0] ma, mb, sum;  // 1.f and three guard bits
+        logic [27:0] wide;
+        logic [7:0] d;
+        logic signed [9:0] e;
+        logic [24:0] mant;
+        if ((x[30:23] == 8'hff && x[22:0] != 0) || (y[30:23] == 8'hff && y[22:0] != 0) ||
+            (x[30:23] == 8'hff && y[30:23] == 8'hff && x[31] != y[31])) begin
+            return 32'h7fc00000;
+        end
+        if (x[30:23] == 8'hff) return x;
+        if (y[30:23] == 8'hff) return y;
+        
+        // a has the larger magnitude
+        if (y[30:0] > x[30:0]) begin
+            a = y;
+            b = x;
+        end else begin
+            a = x;
+            b = y;
+        end
+        if (b[30:23] == 0) return (a[30:23] == 0) ? {a[31] & b[31], 31'h0} : a;
+        
+        ma = {1'b1, a[22:0], 3'b000};
+        mb = {1'b1, b[22:0], 3'b000};
+        d = a[30:23] - b[30:23];
+        if (d >= 8'd27) mb = 27'd1;
+        else mb = (mb >> d) | 27'((mb & ((27'd1 << d) - 27'd1)) != 0);
+        
+        e = 10'(a[30:23]);
+        if (a[31] == b[31]) begin
+            wide = {1'b0, ma} + {1'b0, mb};
+            if (wide[27]) begin
+                sum = wide[27:1] | {26'h0, wide[0]};
+                e = e + 10'sd1;
+            end else begin
+                sum = wide[26:0];
+            end
+        end else begin
+            sum = ma - mb;
+            if (sum == 0) return 32'h0;
+            for (int n = 0; n < 26; n++) begin
+                if (!sum[26]) begin
+                    sum = sum << 1;
+                    e = e - 10'sd1;
+                end
+            end
+            if (e <= 0) return {a[31], 31'h0};
+        end
+        
+        mant = {1'b0, sum[26:3]};
+        if (sum[2] && (sum[1] || sum[0] || sum[3])) begin
+            mant = mant + 25'd1;
+            if (mant[24]) begin
+                mant = mant >> 1;
+                e = e + 10'sd1;
+            end
+        end
+        if (e >= 10'sd255) return {a[31], 8'hff, 23'h0};
+        return {a[31], e[7:0], mant[22:0]};
+    endfunction
     
-    // State machine
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            current_state <= IDLE;
+            load_state <= LD_IDLE;
+            exec_state <= EX_IDLE;
+            store_state <= ST_IDLE;
+            port_owner <= PORT_NONE;
             load_counter <= 4'h0;
             compute_counter <= 4'h0;
-            store_counter <= 4'h0;
-            row_idx <= 2'h0;
-            col_idx <= 2'h0;
-            k_idx <= 2'h0;
+            store_counter <= 5'h0;
+            bank_valid <= 2'b00;
+            bank_from_ring <= 2'b00;
+            load_bank <= 1'b0;
+            exec_bank <= 1'b0;
+            ld_a_addr <= 32'h0;
+            ld_b_addr <= 32'h0;
+            ld_c_addr <= 32'h0;
+            ld_config <= 32'h0;
+            ld_from_ring <= 1'b0;
+            ex_c_addr <= 32'h0;
+            ex_config <= 32'h0;
+            ex_prec <= PREC_INT8;
+            ex_from_ring <= 1'b0;
+            st_c_addr <= 32'h0;
+            st_acc32 <= 1'b0;
+            st_from_ring <= 1'b0;
+            start_pending <= 1'b0;
+            ring_fetch <= 8'h0;
+            ring_tail <= 8'h0;
         end else begin
-            current_state <= next_state;
+            port_owner <= mem_ack ? PORT_NONE : port_sel;
             
-            case (current_state)
-                IDLE: begin
-                    if (start) begin
+            // ---------------- Loader ----------------
+            case (load_state)
+                LD_IDLE: begin
+                    // Direct start takes precedence over queued descriptors
+                    if (!bank_valid[load_bank] && (start_pending || ring_pending)) begin
                         load_counter <= 4'h0;
-                        compute_counter <= 4'h0;
-                        store_counter <= 4'h0;
-                        row_idx <= 2'h0;
-                        col_idx <= 2'h0;
-                        k_idx <= 2'h0;
-                        // Initialize result matrix to zero
-                        for (int i = 0; i < 4; i++) begin
-                            for (int j = 0; j < 4; j++) begin
-                                matrix_c[i][j] <= 16'h0;
+                        ld_from_ring <= !start_pending;
+                        if (start_pending) begin
+                            ld_a_addr <= start_a_addr;
+                            ld_b_addr <= start_b_addr;
+                            ld_c_addr <= start_c_addr;
+                            ld_config <= {16'h0, start_config};
+                            start_pending <= 1'b0;
+                            load_state <= LD_OPERANDS;
+                        end else begin
+                            load_state <= LD_FETCH;
+                        end
+                    end
+                end
+                
+                LD_FETCH: begin
+                    if (load_ack) begin
+                        for (int w = 0; w < CMD_WORDS; w++) begin
+                            if (xfer_take[w]) begin
+                                case (w)
+                                    0: ld_a_addr <= xfer_word[w];
+                                    1: ld_b_addr <= xfer_word[w];
+                                    2: ld_c_addr <= xfer_word[w];
+                                    3: ld_config <= xfer_word[w];
+                                endcase
                             end
                         end
+                        if (xfer_next >= CMD_WORDS) begin
+                            // Wrap back to zero so the operands start from word 0
+                            load_counter <= 4'h0;
+                            ring_fetch <= ring_fetch + 8'h1;
+                            load_state <= LD_OPERANDS;
+                        end else begin
+                            load_counter <= xfer_next[3:0];
+                        end
                     end
                 end
                 
-                LOAD_A: begin
-                    if (mem_ack) begin
-                        // Pack 4 8-bit values from 32-bit word
-                        matrix_a[load_counter[3:2]][load_counter[1:0]] <= mem_rdata[7:0];
-                        matrix_a[load_counter[3:2]][load_counter[1:0]+1] <= mem_rdata[15:8];
-                        matrix_a[load_counter[3:2]][load_counter[1:0]+2] <= mem_rdata[23:16];
-                        matrix_a[load_counter[3:2]][load_counter[1:0]+3] <= mem_rdata[31:24];
-                        load_counter <= load_counter + 1;
+                LD_OPERANDS: begin
+                    if (load_ack) begin
+                        if (ld_wide) begin
+                            // 2 16-bit values (int16 or fp16 bits) per word (two words per row);
+                            // words 0-7 are A rows, 8-15 are B rows
+                            for (int w = 0; w < 8; w++) begin
+                                for (int k = 0; k < 2; k++) begin
+                                    if (xfer_take[w])
+                                        matrix_a[load_bank][w/2][(w%2)*2 + k] <= xfer_word[w][k*16 +: 16];
+                                    if (xfer_take[w + 8])
+                                        matrix_b[load_bank][w/2][(w%2)*2 + k] <= xfer_word[w + 8][k*16 +: 16];
+                                end
+                            end
+                        end else if (ld_prec == PREC_INT4) begin
+                            // 8 4-bit values per word, sign extended. Words 0-3 are A
+                            // rows (k = 0-7); B word w holds k-rows 2w and 2w+1 in its
+                            // low and high halves, so words 4-5 fill the low bytes of
+                            // the B bank and words 6-7 the high bytes
+                            for (int w = 0; w < 4; w++) begin
+                                for (int k = 0; k < 4; k++) begin
+                                    if (xfer_take[w])
+                                        matrix_a[load_bank][w][k] <= {8'($signed(xfer_word[w][(k + 4)*4 +: 4])),
+                                                                      8'($signed(xfer_word[w][k*4 +: 4]))};
+                                    for (int h = 0; h < 2; h++) begin
+                                        if (xfer_take[w + 4])
+                                            matrix_b[load_bank][(2*w + h) % 4][k][(w/2)*8 +: 8] <=
+                                                8'($signed(xfer_word[w + 4][h*16 + k*4 +: 4]));
+                                    end
+                                end
+                            end
+                        end else begin
+                            // 4 8-bit values per word (one row per word), sign extended;
+                            // words 0-3 are A rows, 4-7 are B rows
+                            for (int w = 0; w < 4; w++) begin
+                                for (int k = 0; k < 4; k++) begin
+                                    if (xfer_take[w])
+                                        matrix_a[load_bank][w][k] <= 16'($signed(xfer_word[w][k*8 +: 8]));
+                                    if (xfer_take[w + 4])
+                                        matrix_b[load_bank][w][k] <= 16'($signed(xfer_word[w + 4][k*8 +: 8]));
+                                end
+                            end
+                        end
+                        load_counter <= xfer_next[3:0];
+                        
+                        // Bank is complete; hand it to compute and move to the other one
+                        if (xfer_next >= ld_words) begin
+                            bank_valid[load_bank] <= 1'b1;
+                            bank_c_addr[load_bank] <= ld_c_addr;
+                            bank_config[load_bank] <= ld_config;
+                            bank_prec[load_bank] <= ld_prec;
+                            bank_from_ring[load_bank] <= ld_from_ring;
+                            load_bank <= ~load_bank;
+                            load_state <= LD_IDLE;
+                        end
                     end
                 end
                 
-                LOAD_B: begin
-                    if (mem_ack) begin
-                        matrix_b[load_counter[3:2]][load_counter[1:0]] <= mem_rdata[7:0];
-                        matrix_b[load_counter[3:2]][load_counter[1:0]+1] <= mem_rdata[15:8];
-                        matrix_b[load_counter[3:2]][load_counter[1:0]+2] <= mem_rdata[23:16];
-                        matrix_b[load_counter[3:2]][load_counter[1:0]+3] <= mem_rdata[31:24];
-                        load_counter <= load_counter + 1;
+                default: load_state <= LD_IDLE;
+            endcase
+            
+            // Latch a direct start. The CPU only starts an idle unit (busy covers
+            // start_pending), so a pending start is never overwritten.
+            if (start) begin
+                start_pending <= 1'b1;
+                start_a_addr <= matrix_a_addr;
+                start_b_addr <= matrix_b_addr;
+                start_c_addr <= matrix_c_addr;
+                start_config <= operation_config;
+            end
+            
+            // ---------------- Compute ----------------
+            case (exec_state)
+                EX_IDLE: begin
+                    if (bank_valid[exec_bank]) begin
+                        ex_c_addr <= bank_c_addr[exec_bank];
+                        ex_config <= bank_config[exec_bank];
+                        ex_prec <= bank_prec[exec_bank];
+                        ex_from_ring <= bank_from_ring[exec_bank];
+                        compute_counter <= 4'h0;
+                        // Initialize result matrix unless accumulating
+                        if (!bank_config[exec_bank][CFG_ACCUMULATE]) begin
+                            for (int i = 0; i < 4; i++) begin
+                                for (int j = 0; j < 4; j++) begin
+                                    matrix_c[i][j] <= 32'h0;
+                                end
+                            end
+                        end
+                        exec_state <= EX_COMPUTE;
                     end
                 end
                 
-                COMPUTE: begin
-                    // Perform matrix multiplication using systolic array approach
-                    if (compute_counter < 4) begin
-                        // Compute one row of results per cycle
-                        for (int j = 0; j < 4; j++) begin
-                            for (int k = 0; k < 4; k++) begin
-                                matrix_c[compute_counter][j] <= matrix_c[compute_counter][j] + 
-                                    (matrix_a[compute_counter][k] * matrix_b[k][j]);
+                EX_COMPUTE: begin
+                    // Compute one row of results per cycle
+                    for (int j = 0; j < 4; j++) begin
+                        logic [31:0] row_sum;
+                        row_sum = matrix_c[compute_counter[1:0]][j];
+                        for (int k = 0; k < 4; k++) begin
+                            logic [15:0] a, b;
+                            a = matrix_a[exec_bank][compute_counter[1:0]][k];
+                            b = matrix_b[exec_bank][k][j];
+                            if (ex_prec == PREC_FP16) begin
+                                // Sequential fp32 adds, rounded once each
+                                row_sum = fp32_add(row_sum, fp16_mul(a, b));
+                            end else if (ex_prec == PREC_INT4) begin
+                                row_sum = row_sum + 32'($signed(a[7:0]) * $signed(b[7:0])) +
+                                                    32'($signed(a[15:8]) * $signed(b[15:8]));
+                            end else begin
+                                row_sum = row_sum + 32'($signed(a) * $signed(b));
                             end
                         end
-                        compute_counter <= compute_counter + 1;
+                        matrix_c[compute_counter[1:0]][j] <= row_sum;
+                    end
+                    compute_counter <= compute_counter + 1;
+                    
+                    // Operands are consumed after the last row; free the bank
+                    if (compute_counter == 4'd3) begin
+                        bank_valid[exec_bank] <= 1'b0;
+                        exec_bank <= ~exec_bank;
+                        exec_state <= EX_HANDOFF;
                     end
                 end
                 
-                STORE_C: begin
-                    if (mem_ack) begin
-                        store_counter <= store_counter + 1;
+                EX_HANDOFF: begin
+                    // Ops retire in order through the store stage; partial sums
+                    // stay on the unit until the last k-step
+                    if (store_state == ST_IDLE) begin
+                        c_out <= matrix_c;
+                        st_c_addr <= ex_c_addr;
+                        st_acc32 <= ex_config[CFG_ACC32] || operation_config[CFG_ACC32] ||
+                                    (ex_prec == PREC_FP16);
+                        st_from_ring <= ex_from_ring;
+                        store_counter <= 5'h0;
+                        store_state <= ex_config[CFG_DEFER_STORE] ? ST_RETIRE : ST_STORE;
+                        exec_state <= EX_IDLE;
                     end
                 end
+                
+                default: exec_state <= EX_IDLE;
+            endcase
+            
+            // ---------------- Store ----------------
+            case (store_state)
+                ST_STORE: begin
+                    if (store_ack) begin
+                        store_counter <= xfer_next;
+                        if (xfer_next >= store_words) store_state <= ST_RETIRE;
+                    end
+                end
+                
+                ST_RETIRE: begin
+                    // Retire the descriptor so software can reuse its slot
+                    if (st_from_ring) begin
+                        ring_tail <= ring_tail + 8'h1;
+                    end
+                    store_state <= ST_IDLE;
+                end
+                
+                default: ;
             endcase
         end
     end
     
-    // Next state logic
+    // C words in store order
+    logic [31:0] c_word [XFER_MAX-1:0];
+    
     always_comb begin
-        next_state = current_state;
-        case (current_state)
-            IDLE: begin
-                if (start) next_state = LOAD_A;
-            end
-            LOAD_A: begin
-                if (load_counter >= 4) next_state = LOAD_B;
-            end
-            LOAD_B: begin
-                if (load_counter >= 8) next_state = COMPUTE;
-            end
-            COMPUTE: begin
-                if (compute_counter >= 4) next_state = STORE_C;
-            end
-            STORE_C: begin
-                if (store_counter >= 4) next_state = DONE_STATE;
+        for (int w = 0; w < XFER_MAX; w++) begin
+            if (st_acc32) begin
+                // One 32-bit result per word (four words per row)
+                c_word[w] = c_out[w / 4][w % 4];
+            end else if (w < 8) begin
+                // Pack 2 16-bit results into 32-bit word (two words per row)
+                c_word[w] = {c_out[w / 2][(w % 2) * 2 + 1][15:0],
+                             c_out[w / 2][(w % 2) * 2][15:0]};
+            end else begin
+                c_word[w] = 32'h0;
             end
-            DONE_STATE: begin
-                next_state = IDLE;
-            end
-        endcase
+        end
+    end
+    
+    // 16 MACs per compute cycle: one row of four 4-element dot products
+    // (8-element for INT4, 32 MACs)
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            perf_busy_cycles <= 32'h0;
+            perf_stall_cycles <= 32'h0;
+            perf_mem_wait_cycles <= 32'h0;
+            perf_macs <= 32'h0;
+            perf_ops <= 32'h0;
+        end else begin
+            if (busy) perf_busy_cycles <= perf_busy_cycles + 1;
+            if (busy && exec_state != EX_COMPUTE) perf_stall_cycles <= perf_stall_cycles + 1;
+            if (mem_req && !mem_ack) perf_mem_wait_cycles <= perf_mem_wait_cycles + 1;
+            if (exec_state == EX_COMPUTE)
+                perf_macs <= perf_macs + ((ex_prec == PREC_INT4) ? 32'd32 : 32'd16);
+            if (store_state == ST_RETIRE) perf_ops <= perf_ops + 1;
+        end
     end
     
     // Memory interface control
@@ -160,26 +641,27 @@ module gpu_compute_unit (
         mem_we = 1'b0;
         mem_addr = 32'h0;
         mem_wdata = 32'h0;
+        mem_line = 1'b0;
+        mem_wmask = '0;
+        mem_line_wdata = '0;
         
-        case (current_state)
-            LOAD_A: begin
-                mem_req = 1'b1;
-                mem_we = 1'b0;
-                mem_addr = matrix_a_addr + (load_counter << 2); // 4 bytes per word
-            end
-            LOAD_B: begin
-                mem_req = 1'b1;
-                mem_we = 1'b0;
-                mem_addr = matrix_b_addr + ((load_counter - 4) << 2);
-            end
-            STORE_C: begin
-                mem_req = 1'b1;
-                mem_we = 1'b1;
-                mem_addr = matrix_c_addr + (store_counter << 2);
-                // Pack 2 16-bit results into 32-bit word
-                mem_wdata = {matrix_c[store_counter[1:0]][1], matrix_c[store_counter[1:0]][0]};
+        if (port_sel != PORT_NONE) begin
+            mem_req = 1'b1;
+            mem_we = (port_sel == PORT_STORE);
+            mem_line = (BURST_EN != 0);
+            mem_addr = (BURST_EN != 0) ? xfer_line_addr : xfer_addr[xfer_index[3:0]];
+            mem_wdata = c_word[xfer_index[3:0]];
+            
+            // Place every C word served by this burst at its line offset
+            if (port_sel == PORT_STORE) begin
+                for (int w = 0; w < XFER_MAX; w++) begin
+                    if (xfer_take[w]) begin
+                        mem_wmask[xfer_addr[w][LINE_OFFSET_BITS-1:2]] = 1'b1;
+                        mem_line_wdata[xfer_addr[w][LINE_OFFSET_BITS-1:2]*32 +: 32] = c_word[w];
+                    end
+                end
             end
-        endcase
+        end
     end
 
 endmodule
@@ -31,14 +31,42 @@ module gpu_control_interface #(
     output logic [31:0] gpu_matrix_c_addr [NUM_GPU_UNITS-1:0],
     output logic [15:0] gpu_operation_config [NUM_GPU_UNITS-1:0],
     
-    // Performance counters
+    // Per-unit performance counters (busy cycles, retired ops, busy cycles
+    // without compute, cycles waiting on memory, multiply-accumulates)
     input  logic [31:0] gpu_cycle_count [NUM_GPU_UNITS-1:0],
     input  logic [31:0] gpu_operation_count [NUM_GPU_UNITS-1:0],
+    input  logic [31:0] gpu_stall_count [NUM_GPU_UNITS-1:0],
+    input  logic [31:0] gpu_mem_wait_count [NUM_GPU_UNITS-1:0],
+    input  logic [31:0] gpu_mac_count [NUM_GPU_UNITS-1:0],
     
     // Global GPU configuration
     output logic [7:0] gpu_global_priority,
     output logic gpu_global_enable,
-    output logic gpu_debug_enable
+    output logic gpu_debug_enable,
+    
+    // Cache stride prefetcher controls
+    output logic gpu_prefetch_enable,
+    output logic [3:0] gpu_prefetch_degree,
+    
+    // Cache way partitioning and per-level hit statistics (index 0 = L1)
+    output logic [31:0] gpu_cache_partition,
+    input  logic [31:0] cache_hits [2:0],
+    input  logic [31:0] cache_misses [2:0],
+    
+    // GPU requester share of the cache statistics, and memory system counters
+    input  logic [31:0] gpu_cache_hits [2:0],
+    input  logic [31:0] gpu_cache_misses [2:0],
+    input  logic [31:0] bank_conflicts,
+    input  logic [31:0] arb_grants,
+    input  logic [31:0] arb_waits,
+    input  logic [31:0] fabric_stalls,
+    
+    // Tile DMA engine: a queue write hands it a descriptor chain
+    output logic dma_queue_valid,
+    output logic [31:0] dma_queue_addr,
+    input  logic [7:0] dma_queue_free,
+    input  logic dma_busy,
+    input  logic [31:0] dma_done_count
 );
 
     // Register map
@@ -46,6 +74,27 @@ module gpu_control_interface #(
     localparam GPU_GLOBAL_STATUS    = 16'h0004;
     localparam GPU_GLOBAL_PRIORITY  = 16'h0008;
     localparam GPU_DEBUG_CTRL       = 16'h000C;
+    localparam GPU_PREFETCH_CTRL    = 16'h0010; // [0] enable [7:4] degree (lines ahead)
+    localparam GPU_CACHE_PARTITION  = 16'h0014; // L2 ways [3:0] GPU [7:4] CPU, L3 ways [12:8] GPU [20:16] CPU
+    localparam GPU_L1_HITS          = 16'h0020; // Read-only cache statistics
+    localparam GPU_L1_MISSES        = 16'h0024;
+    localparam GPU_L2_HITS          = 16'h0028;
+    localparam GPU_L2_MISSES        = 16'h002C;
+    localparam GPU_L3_HITS          = 16'h0030;
+    localparam GPU_L3_MISSES        = 16'h0034;
+    localparam GPU_L1_GPU_HITS      = 16'h0038; // GPU requests only
+    localparam GPU_L1_GPU_MISSES    = 16'h003C;
+    localparam GPU_L2_GPU_HITS      = 16'h0040;
+    localparam GPU_L2_GPU_MISSES    = 16'h0044;
+    localparam GPU_L3_GPU_HITS      = 16'h0048;
+    localparam GPU_L3_GPU_MISSES    = 16'h004C;
+    localparam GPU_BANK_CONFLICTS   = 16'h0050;
+    localparam GPU_ARB_GRANTS       = 16'h0054; // GPU array fabric arbiter
+    localparam GPU_ARB_WAITS        = 16'h0058;
+    localparam GPU_FABRIC_STALLS    = 16'h005C;
+    localparam GPU_DMA_QUEUE        = 16'h0060; // W: descriptor chain head, R: free queue entries
+    localparam GPU_DMA_STATUS       = 16'h0064; // [0] busy
+    localparam GPU_DMA_DONE         = 16'h0068; // Chains completed
     
     // Per-unit registers (64 bytes per unit, starting at 0x0100)
     localparam GPU_UNIT_BASE        = 16'h0100;
@@ -57,9 +106,12 @@ module gpu_control_interface #(
     localparam UNIT_MATRIX_A_OFFSET = 16'h08;
     localparam UNIT_MATRIX_B_OFFSET = 16'h0C;
     localparam UNIT_MATRIX_C_OFFSET = 16'h10;
-    localparam UNIT_CONFIG_OFFSET   = 16'h14;
-    localparam UNIT_CYCLES_OFFSET   = 16'h18;
+    localparam UNIT_CONFIG_OFFSET   = 16'h14; // [0] accumulate [1] defer store [2] int32 C [4:3] precision
+    localparam UNIT_CYCLES_OFFSET   = 16'h18; // Read-only counters
     localparam UNIT_OPS_OFFSET      = 16'h1C;
+    localparam UNIT_STALL_OFFSET    = 16'h20;
+    localparam UNIT_MEM_WAIT_OFFSET = 16'h24;
+    localparam UNIT_MACS_OFFSET     = 16'h28;
     
     // Address decoding
     logic [15:0] reg_addr;
@@ -81,6 +133,8 @@ module gpu_control_interface #(
     logic [31:0] global_status_reg;
     logic [31:0] global_priority_reg;
     logic [31:0] debug_ctrl_reg;
+    logic [31:0] prefetch_ctrl_reg;
+    logic [31:0] cache_partition_reg;
     
     // Per-unit control registers
     logic [31:0] unit_ctrl_reg [NUM_GPU_UNITS-1:0];
@@ -90,6 +144,9 @@ module gpu_control_interface #(
     assign gpu_global_enable = global_ctrl_reg[0];
     assign gpu_global_priority = global_priority_reg[7:0];
     assign gpu_debug_enable = debug_ctrl_reg[0];
+    assign gpu_prefetch_enable = prefetch_ctrl_reg[0];
+    assign gpu_prefetch_degree = prefetch_ctrl_reg[7:4];
+    assign gpu_cache_partition = cache_partition_reg;
     
     // Per-unit control assignments
     genvar i;
@@ -105,9 +162,9 @@ module gpu_control_interface #(
     // Global status register composition
     always_comb begin
         global_status_reg = '0;
-        global_status_reg[7:0] = gpu_busy;
-        global_status_reg[15:8] = gpu_done;
-        global_status_reg[23:16] = gpu_error;
+        global_status_reg[7:0] = 8'(gpu_busy); // Units 0-7
+        global_status_reg[15:8] = 8'(gpu_done);
+        global_status_reg[23:16] = 8'(gpu_error);
         global_status_reg[31] = |gpu_busy; // Any GPU busy
     end
     
@@ -118,6 +175,8 @@ module gpu_control_interface #(
             global_ctrl_reg <= '0;
             global_priority_reg <= 32'h80; // Default priority
             debug_ctrl_reg <= '0;
+            prefetch_ctrl_reg <= 32'h20; // Disabled, degree 2
+            cache_partition_reg <= '0;   // No reserved ways
             
             for (int i = 0; i < NUM_GPU_UNITS; i++) begin
                 unit_ctrl_reg[i] <= '0;
@@ -129,9 +188,12 @@ module gpu_control_interface #(
             
             ack <= 1'b0;
             rdata <= '0;
+            dma_queue_valid <= 1'b0;
+            dma_queue_addr <= '0;
         end else begin
             ack <= 1'b0;
             rdata <= '0;
+            dma_queue_valid <= 1'b0;
             
             // Clear one-shot control bits
             for (int i = 0; i < NUM_GPU_UNITS; i++) begin
@@ -148,6 +210,12 @@ module gpu_control_interface #(
                             GPU_GLOBAL_CTRL: global_ctrl_reg <= wdata;
                             GPU_GLOBAL_PRIORITY: global_priority_reg <= wdata;
                             GPU_DEBUG_CTRL: debug_ctrl_reg <= wdata;
+                            GPU_PREFETCH_CTRL: prefetch_ctrl_reg <= wdata;
+                            GPU_CACHE_PARTITION: cache_partition_reg <= wdata;
+                            GPU_DMA_QUEUE: begin
+                                dma_queue_valid <= 1'b1;
+                                dma_queue_addr <= wdata;
+                            end
                         endcase
                     end else if (is_unit_reg && valid_unit) begin
                         case (unit_offset)
@@ -166,6 +234,27 @@ module gpu_control_interface #(
                             GPU_GLOBAL_STATUS: rdata <= global_status_reg;
                             GPU_GLOBAL_PRIORITY: rdata <= global_priority_reg;
                             GPU_DEBUG_CTRL: rdata <= debug_ctrl_reg;
+                            GPU_PREFETCH_CTRL: rdata <= prefetch_ctrl_reg;
+                            GPU_CACHE_PARTITION: rdata <= cache_partition_reg;
+                            GPU_L1_HITS: rdata <= cache_hits[0];
+                            GPU_L1_MISSES: rdata <= cache_misses[0];
+                            GPU_L2_HITS: rdata <= cache_hits[1];
+                            GPU_L2_MISSES: rdata <= cache_misses[1];
+                            GPU_L3_HITS: rdata <= cache_hits[2];
+                            GPU_L3_MISSES: rdata <= cache_misses[2];
+                            GPU_L1_GPU_HITS: rdata <= gpu_cache_hits[0];
+                            GPU_L1_GPU_MISSES: rdata <= gpu_cache_misses[0];
+                            GPU_L2_GPU_HITS: rdata <= gpu_cache_hits[1];
+                            GPU_L2_GPU_MISSES: rdata <= gpu_cache_misses[1];
+                            GPU_L3_GPU_HITS: rdata <= gpu_cache_hits[2];
+                            GPU_L3_GPU_MISSES: rdata <= gpu_cache_misses[2];
+                            GPU_BANK_CONFLICTS: rdata <= bank_conflicts;
+                            GPU_ARB_GRANTS: rdata <= arb_grants;
+                            GPU_ARB_WAITS: rdata <= arb_waits;
+                            GPU_FABRIC_STALLS: rdata <= fabric_stalls;
+                            GPU_DMA_QUEUE: rdata <= 32'(dma_queue_free);
+                            GPU_DMA_STATUS: rdata <= {31'b0, dma_busy};
+                            GPU_DMA_DONE: rdata <= dma_done_count;
                             default: rdata <= 32'hDEADBEEF; // Invalid address
                         endcase
                     end else if (is_unit_reg && valid_unit) begin
@@ -185,6 +274,9 @@ module gpu_control_interface #(
                             UNIT_CONFIG_OFFSET: rdata <= unit_config_reg[unit_id];
                             UNIT_CYCLES_OFFSET: rdata <= gpu_cycle_count[unit_id];
                             UNIT_OPS_OFFSET: rdata <= gpu_operation_count[unit_id];
+                            UNIT_STALL_OFFSET: rdata <= gpu_stall_count[unit_id];
+                            UNIT_MEM_WAIT_OFFSET: rdata <= gpu_mem_wait_count[unit_id];
+                            UNIT_MACS_OFFSET: rdata <= gpu_mac_count[unit_id];
                             default: rdata <= 32'hDEADBEEF; // Invalid address
                         endcase
                     end else begin
@@ -1,22 +1,26 @@
 // Priority Arbiter for UnifiedRISCV Interconnect
-// Implements GPU-priority round-robin arbitration
+// Implements GPU-priority round-robin arbitration. A requester keeps its
+// grant for as long as its hold bit stays set, so a transaction (or a locked
+// read-modify-write, which drops its request between the two halves) is
+// never split by another requester.
 
 module priority_arbiter #(
     parameter NUM_REQUESTERS = 9,
+    parameter NUM_CPUS = 1,          // Requesters 0..NUM_CPUS-1 are CPU harts
     parameter GPU_PRIORITY = 1
 ) (
     input  logic clk,
     input  logic rst_n,
     
     input  logic [NUM_REQUESTERS-1:0] requests,
+    input  logic [NUM_REQUESTERS-1:0] hold,
     output logic [NUM_REQUESTERS-1:0] grants,
     output logic [$clog2(NUM_REQUESTERS)-1:0] granted_id,
     output logic any_grant
 );
 
-    // Assuming requester 0 is CPU, 1-8 are GPU units
-    localparam CPU_ID = 0;
-    localparam NUM_GPU_UNITS = NUM_REQUESTERS - 1;
+    // CPU harts first, then the GPU units
+    localparam logic [NUM_REQUESTERS-1:0] CPU_MASK = NUM_REQUESTERS'((1 << NUM_CPUS) - 1);
     
     // Round-robin state
     logic [$clog2(NUM_REQUESTERS)-1:0] rr_pointer;
@@ -29,10 +33,15 @@ module priority_arbiter #(
     
     // GPU priority grouping
     logic gpu_has_request;
-    logic cpu_has_request;
     
-    assign cpu_has_request = requests[CPU_ID];
-    assign gpu_has_request = |requests[NUM_REQUESTERS-1:1]; // GPU units 1-8
+    assign gpu_has_request = |(requests & ~CPU_MASK);
+    
+    // Grant of the previous cycle, kept while its holder asks
+    logic [$clog2(NUM_REQUESTERS)-1:0] last_id;
+    logic last_valid;
+    logic holding;
+    
+    assign holding = last_valid && hold[last_id];
     
     // Generate round-robin mask
     logic [NUM_REQUESTERS-1:0] rr_mask;
@@ -56,32 +65,31 @@ module priority_arbiter #(
         granted_id = '0;
         any_grant = 1'b0;
         
-        if (GPU_PRIORITY && gpu_has_request) begin
+        if (holding) begin
+            grants[last_id] = 1'b1;
+            granted_id = last_id;
+            any_grant = 1'b1;
+        end else if (GPU_PRIORITY && gpu_has_request) begin
             // GPU units have priority - round-robin among GPU units only
             logic [NUM_REQUESTERS-1:0] gpu_requests;
             logic [NUM_REQUESTERS-1:0] gpu_masked;
             logic [NUM_REQUESTERS-1:0] gpu_final;
             
-            // Extract GPU requests (exclude CPU)
-            gpu_requests = requests & ~(1 << CPU_ID);
+            // Extract GPU requests (exclude CPUs)
+            gpu_requests = requests & ~CPU_MASK;
             gpu_masked = gpu_requests & rr_mask;
             gpu_final = (gpu_masked != '0) ? gpu_masked : gpu_requests;
             
             // Find first GPU requester
-            for (int i = 1; i < NUM_REQUESTERS; i++) begin // Start from 1 (first GPU)
+            for (int i = NUM_CPUS; i < NUM_REQUESTERS; i++) begin
                 if (gpu_final[i] && !any_grant) begin
                     grants[i] = 1'b1;
                     granted_id = i;
                     any_grant = 1'b1;
                 end
             end
-        end else if (cpu_has_request && !gpu_has_request) begin
-            // Only CPU requesting
-            grants[CPU_ID] = 1'b1;
-            granted_id = CPU_ID;
-            any_grant = 1'b1;
         end else begin
-            // Fallback: standard round-robin
+            // Standard round-robin, which is among the harts when only CPUs ask
             logic [NUM_REQUESTERS-1:0] final_requests;
             final_requests = use_unmasked ? unmasked_requests : masked_requests;
             
@@ -107,8 +115,12 @@ module priority_arbiter #(
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             rr_pointer <= '0;
+            last_id <= '0;
+            last_valid <= 1'b0;
         end else begin
             rr_pointer <= next_rr_pointer;
+            last_id <= granted_id;
+            last_valid <= any_grant;
         end
     end
 
@@ -3,7 +3,8 @@
 
 module system_interconnect #(
     parameter NUM_MASTERS = 9,  // 1 CPU + 8 GPU units
-    parameter NUM_SLAVES = 4,   // Memory controller, GPU control, system regs, debug
+    parameter NUM_CPUS = 1,     // Masters 0..NUM_CPUS-1 are CPU harts, the rest GPU units
+    parameter NUM_SLAVES = 5,   // Memory controller, GPU control, system regs, debug, GPU scratchpad
     parameter ADDR_WIDTH = 32,
     parameter DATA_WIDTH = 32,
     parameter ID_WIDTH = 4
@@ -11,8 +12,9 @@ module system_interconnect #(
     input  logic clk,
     input  logic rst_n,
     
-    // Master interfaces (CPU + 8 GPU units)
+    // Master interfaces (CPU harts + GPU units)
     input  logic [NUM_MASTERS-1:0] master_req,
+    input  logic [NUM_MASTERS-1:0] master_lock,  // Keeps the slave across a read-modify-write
     input  logic [NUM_MASTERS-1:0] master_we,
     input  logic [NUM_MASTERS-1:0][ADDR_WIDTH-1:0] master_addr,
     input  logic [NUM_MASTERS-1:0][DATA_WIDTH-1:0] master_wdata,
@@ -35,6 +37,8 @@ module system_interconnect #(
     localparam MAIN_MEMORY_SIZE = 32'h10000000; // 256MB
     localparam GPU_CTRL_BASE    = 32'h10000000;
     localparam GPU_CTRL_SIZE    = 32'h00010000; // 64KB
+    localparam GPU_SPAD_BASE    = 32'h10010000;
+    localparam GPU_SPAD_SIZE    = 32'h00010000; // 64KB
     localparam SYS_CTRL_BASE    = 32'h20000000;
     localparam SYS_CTRL_SIZE    = 32'h00010000; // 64KB
     localparam DEBUG_BASE       = 32'h30000000;
@@ -45,13 +49,12 @@ module system_interconnect #(
     localparam SLAVE_GPU_CTRL = 1;
     localparam SLAVE_SYS_CTRL = 2;
     localparam SLAVE_DEBUG = 3;
+    localparam SLAVE_GPU_SPAD = 4;
     
-    // Master priority (GPU units have higher priority than CPU)
-    localparam CPU_MASTER = 0;
-    // GPU masters are 1-8
+    // Master priority (GPU units have higher priority than the CPU harts)
     
     // Crossbar state
-    logic [NUM_MASTERS-1:0][1:0] master_target_slave;
+    logic [NUM_MASTERS-1:0][2:0] master_target_slave;
     logic [NUM_MASTERS-1:0] master_valid_target;
     logic [NUM_SLAVES-1:0][3:0] slave_granted_master;
     logic [NUM_SLAVES-1:0] slave_has_master;
@@ -64,7 +67,7 @@ module system_interconnect #(
     always_comb begin
         for (int m = 0; m < NUM_MASTERS; m++) begin
             master_valid_target[m] = 1'b0;
-            master_target_slave[m] = 2'b00;
+            master_target_slave[m] = 3'b000;
             
             if (master_req[m]) begin
                 if (master_addr[m] >= MAIN_MEMORY_BASE && 
@@ -75,6 +78,10 @@ module system_interconnect #(
                            master_addr[m] < GPU_CTRL_BASE + GPU_CTRL_SIZE) begin
                     master_target_slave[m] = SLAVE_GPU_CTRL;
                     master_valid_target[m] = 1'b1;
+                end else if (master_addr[m] >= GPU_SPAD_BASE && 
+                           master_addr[m] < GPU_SPAD_BASE + GPU_SPAD_SIZE) begin
+                    master_target_slave[m] = SLAVE_GPU_SPAD;
+                    master_valid_target[m] = 1'b1;
                 end else if (master_addr[m] >= SYS_CTRL_BASE && 
                            master_addr[m] < SYS_CTRL_BASE + SYS_CTRL_SIZE) begin
                     master_target_slave[m] = SLAVE_SYS_CTRL;
@@ -104,11 +111,13 @@ module system_interconnect #(
         for (s = 0; s < NUM_SLAVES; s++) begin : slave_arbiters
             priority_arbiter #(
                 .NUM_REQUESTERS(NUM_MASTERS),
+                .NUM_CPUS(NUM_CPUS),
                 .GPU_PRIORITY(1'b1)  // GPU units have priority over CPU
             ) arbiter (
                 .clk(clk),
                 .rst_n(rst_n),
                 .requests(request_matrix[s]),
+                .hold(request_matrix[s] | master_lock),
                 .grants(grant_matrix[s]),
                 .granted_id(slave_granted_master[s]),
                 .any_grant(slave_has_master[s])
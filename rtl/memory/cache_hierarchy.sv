@@ -1,12 +1,16 @@
 // M1-Inspired Cache Hierarchy with 512-bit cache lines
 // L1: 32KB 4-way, L2: 256KB 8-way, L3: 2MB 16-way
+// GPU requests train a per-unit stride prefetcher that fills lines ahead of demand.
+// L2/L3 ways can be reserved for GPU or CPU fills so streaming tiles and CPU
+// working sets do not evict each other.
 
 module cache_hierarchy #(
     parameter L1_SIZE = 32 * 1024,    // 32KB
     parameter L2_SIZE = 256 * 1024,   // 256KB  
     parameter L3_SIZE = 2 * 1024 * 1024, // 2MB
     parameter CACHE_LINE_WIDTH = 512,
-    parameter ADDR_WIDTH = 32
+    parameter ADDR_WIDTH = 32,
+    parameter PF_STREAMS = 8          // Prefetch stream table entries (one per GPU unit)
 ) (
     input  logic clk,
     input  logic rst_n,
@@ -18,7 +22,42 @@ module cache_hierarchy #(
     input  logic req_valid,
     input  logic req_we,
     output logic req_ready,
+    output logic req_done, // Pulses when a demand request completes
     input  logic req_is_gpu, // GPU requests have different caching behavior
+    input  logic [3:0] req_unit, // GPU unit ID, keys the prefetch stream table
+    
+    // Whole-line accesses (GPU tile loads and stores)
+    input  logic req_line,
+    input  logic [CACHE_LINE_WIDTH/32-1:0] req_wmask,
+    input  logic [CACHE_LINE_WIDTH-1:0] req_line_wdata,
+    output logic [CACHE_LINE_WIDTH-1:0] req_line_rdata,
+    
+    // Stride prefetcher controls (GPU control block)
+    input  logic pf_enable,
+    input  logic [3:0] pf_degree, // Lines fetched ahead once a stride is confirmed
+    
+    // Way partitioning (GPU control block). GPU fills use the ways not
+    // reserved for the CPU and vice versa; invalid settings disable it.
+    input  logic [3:0] l2_gpu_ways,
+    input  logic [3:0] l2_cpu_ways,
+    input  logic [4:0] l3_gpu_ways,
+    input  logic [4:0] l3_cpu_ways,
+    
+    // Demand hit/miss counters per level (prefetches are not counted)
+    output logic [31:0] l1_hits,
+    output logic [31:0] l1_misses,
+    output logic [31:0] l2_hits,
+    output logic [31:0] l2_misses,
+    output logic [31:0] l3_hits,
+    output logic [31:0] l3_misses,
+    
+    // GPU share of the demand counters above
+    output logic [31:0] l1_gpu_hits,
+    output logic [31:0] l1_gpu_misses,
+    output logic [31:0] l2_gpu_hits,
+    output logic [31:0] l2_gpu_misses,
+    output logic [31:0] l3_gpu_hits,
+    output logic [31:0] l3_gpu_misses,
     
     // External memory interface
     output logic [ADDR_WIDTH-1:0] mem_addr,
@@ -33,8 +72,11 @@ module cache_hierarchy #(
     localparam L1_WAYS = 4;
     localparam L2_WAYS = 8;
     localparam L3_WAYS = 16;
+    localparam L2_WAY_BITS = $clog2(L2_WAYS);
+    localparam L3_WAY_BITS = $clog2(L3_WAYS);
     
     localparam LINE_SIZE = CACHE_LINE_WIDTH / 8; // 64 bytes
+    localparam LINE_WORDS = CACHE_LINE_WIDTH / 32;
     localparam OFFSET_BITS = $clog2(LINE_SIZE);
     
     // L1 Cache parameters
@@ -52,14 +94,24 @@ module cache_hierarchy #(
     localparam L3_SET_BITS = $clog2(L3_SETS);
     localparam L3_TAG_BITS = ADDR_WIDTH - L3_SET_BITS - OFFSET_BITS;
     
-    // Address breakdown
+    // Request registers
+    logic [ADDR_WIDTH-1:0] current_addr;
+    logic [31:0] current_wdata;
+    logic current_we;
+    logic current_is_gpu;
+    logic current_is_prefetch; // Fill only, no requester waiting
+    logic current_line;
+    logic [LINE_WORDS-1:0] current_wmask;
+    logic [CACHE_LINE_WIDTH-1:0] current_line_wdata;
+    
+    // Address breakdown (of the request being served)
     logic [L1_SET_BITS-1:0] l1_set;
     logic [L1_TAG_BITS-1:0] l1_tag;
     logic [OFFSET_BITS-1:0] offset;
     
-    assign l1_set = req_addr[L1_SET_BITS+OFFSET_BITS-1:OFFSET_BITS];
-    assign l1_tag = req_addr[ADDR_WIDTH-1:L1_SET_BITS+OFFSET_BITS];
-    assign offset = req_addr[OFFSET_BITS-1:0];
+    assign l1_set = current_addr[L1_SET_BITS+OFFSET_BITS-1:OFFSET_BITS];
+    assign l1_tag = current_addr[ADDR_WIDTH-1:L1_SET_BITS+OFFSET_BITS];
+    assign offset = current_addr[OFFSET_BITS-1:0];
     
     // L1 Cache arrays
     logic [L1_TAG_BITS-1:0] l1_tags [L1_SETS-1:0][L1_WAYS-1:0];
@@ -72,6 +124,44 @@ module cache_hierarchy #(
     logic l1_hit, l1_miss;
     logic [1:0] l1_hit_way, l1_victim_way;
     
+    // L2/L3 never hold dirty data: L1 victims are written to memory and
+    // refresh any L2/L3 copy on the way out, so their evictions are silent.
+    // During a writeback the lower levels are probed with the victim address.
+    logic [ADDR_WIDTH-1:0] probe_addr;
+    logic [L2_SET_BITS-1:0] l2_set;
+    logic [L2_TAG_BITS-1:0] l2_tag;
+    logic [L3_SET_BITS-1:0] l3_set;
+    logic [L3_TAG_BITS-1:0] l3_tag;
+    
+    assign l2_set = probe_addr[L2_SET_BITS+OFFSET_BITS-1:OFFSET_BITS];
+    assign l2_tag = probe_addr[ADDR_WIDTH-1:L2_SET_BITS+OFFSET_BITS];
+    assign l3_set = probe_addr[L3_SET_BITS+OFFSET_BITS-1:OFFSET_BITS];
+    assign l3_tag = probe_addr[ADDR_WIDTH-1:L3_SET_BITS+OFFSET_BITS];
+    
+    // L2 Cache arrays (round-robin replacement within the allowed ways)
+    logic [L2_TAG_BITS-1:0] l2_tags [L2_SETS-1:0][L2_WAYS-1:0];
+    logic [CACHE_LINE_WIDTH-1:0] l2_data [L2_SETS-1:0][L2_WAYS-1:0];
+    logic l2_valid [L2_SETS-1:0][L2_WAYS-1:0];
+    logic [L2_WAY_BITS-1:0] l2_rr [L2_SETS-1:0];
+    
+    // L3 Cache arrays
+    logic [L3_TAG_BITS-1:0] l3_tags [L3_SETS-1:0][L3_WAYS-1:0];
+    logic [CACHE_LINE_WIDTH-1:0] l3_data [L3_SETS-1:0][L3_WAYS-1:0];
+    logic l3_valid [L3_SETS-1:0][L3_WAYS-1:0];
+    logic [L3_WAY_BITS-1:0] l3_rr [L3_SETS-1:0];
+    
+    logic l2_hit, l3_hit;
+    logic [L2_WAY_BITS-1:0] l2_hit_way, l2_victim_way, l2_fill_way;
+    logic [L3_WAY_BITS-1:0] l3_hit_way, l3_victim_way;
+    
+    // Allowed fill ways [lo, hi) for the current requester
+    logic [L2_WAY_BITS:0] l2_lo, l2_hi;
+    logic [L3_WAY_BITS:0] l3_lo, l3_hi;
+    logic l2_partitioned, l3_partitioned;
+    
+    // Line handed to FILL_L1 by whichever level supplied it
+    logic [CACHE_LINE_WIDTH-1:0] fill_line;
+    
     // Cache state machine
     typedef enum logic [3:0] {
         IDLE,
@@ -90,11 +180,29 @@ module cache_hierarchy #(
     
     cache_state_t current_state, next_state;
     
-    // Request registers
-    logic [ADDR_WIDTH-1:0] current_addr;
-    logic [31:0] current_wdata;
-    logic current_we;
-    logic current_is_gpu;
+    // Stride prefetcher: one stream per GPU unit, trained on the line address
+    // of each demand request. The same line delta twice in a row confirms it.
+    localparam LINE_BITS = ADDR_WIDTH - OFFSET_BITS;
+    localparam PF_BITS = (PF_STREAMS > 1) ? $clog2(PF_STREAMS) : 1;
+    
+    logic [LINE_BITS-1:0] pf_last_line [PF_STREAMS-1:0];
+    logic [LINE_BITS-1:0] pf_stride [PF_STREAMS-1:0];
+    logic [PF_STREAMS-1:0] pf_valid;
+    
+    // Lines still to prefetch for the most recently confirmed stream
+    logic [LINE_BITS-1:0] pf_next_line;
+    logic [LINE_BITS-1:0] pf_next_stride;
+    logic [3:0] pf_remaining;
+    
+    logic [PF_BITS-1:0] train_idx;
+    logic [LINE_BITS-1:0] train_line;
+    logic [LINE_BITS-1:0] train_delta;
+    logic train_match;
+    
+    assign train_idx = req_unit[PF_BITS-1:0];
+    assign train_line = req_addr[ADDR_WIDTH-1:OFFSET_BITS];
+    assign train_delta = train_line - pf_last_line[train_idx];
+    assign train_match = pf_valid[train_idx] && (train_delta == pf_stride[train_idx]);
     
     // L1 Cache hit detection
     always_comb begin
@@ -113,12 +221,106 @@ module cache_hierarchy #(
     // L1 Victim selection (LRU)
     assign l1_victim_way = l1_lru[l1_set];
     
+    assign probe_addr = (current_state == WRITEBACK) ?
+                        {l1_tags[l1_set][l1_victim_way], l1_set, {OFFSET_BITS{1'b0}}} :
+                        current_addr;
+    
+    // L2/L3 hit detection
+    always_comb begin
+        l2_hit = 1'b0;
+        l2_hit_way = '0;
+        for (int i = 0; i < L2_WAYS; i++) begin
+            if (l2_valid[l2_set][i] && l2_tags[l2_set][i] == l2_tag) begin
+                l2_hit = 1'b1;
+                l2_hit_way = i[L2_WAY_BITS-1:0];
+                break;
+            end
+        end
+        
+        l3_hit = 1'b0;
+        l3_hit_way = '0;
+        for (int i = 0; i < L3_WAYS; i++) begin
+            if (l3_valid[l3_set][i] && l3_tags[l3_set][i] == l3_tag) begin
+                l3_hit = 1'b1;
+                l3_hit_way = i[L3_WAY_BITS-1:0];
+                break;
+            end
+        end
+    end
+    
+    // Way partitioning: a reservation is only honoured when both sides are
+    // left at least one way
+    assign l2_partitioned = ({1'b0, l2_gpu_ways} + {1'b0, l2_cpu_ways} <= L2_WAYS) &&
+                            (l2_gpu_ways < L2_WAYS) && (l2_cpu_ways < L2_WAYS);
+    assign l3_partitioned = ({1'b0, l3_gpu_ways} + {1'b0, l3_cpu_ways} <= L3_WAYS) &&
+                            (l3_gpu_ways < L3_WAYS) && (l3_cpu_ways < L3_WAYS);
+    
+    always_comb begin
+        l2_lo = '0;
+        l2_hi = L2_WAYS[L2_WAY_BITS:0];
+        if (l2_partitioned) begin
+            if (current_is_gpu) l2_hi = L2_WAYS[L2_WAY_BITS:0] - l2_cpu_ways[L2_WAY_BITS:0];
+            else l2_lo = l2_gpu_ways[L2_WAY_BITS:0];
+        end
+        
+        l3_lo = '0;
+        l3_hi = L3_WAYS[L3_WAY_BITS:0];
+        if (l3_partitioned) begin
+            if (current_is_gpu) l3_hi = L3_WAYS[L3_WAY_BITS:0] - l3_cpu_ways;
+            else l3_lo = l3_gpu_ways;
+        end
+    end
+    
+    // Victim: first invalid way in range, else the set's round-robin pointer
+    // (pulled back into range if the partition changed under it)
+    always_comb begin
+        logic found;
+        
+        found = 1'b0;
+        l2_victim_way = ({1'b0, l2_rr[l2_set]} >= l2_lo && {1'b0, l2_rr[l2_set]} < l2_hi) ?
+                        l2_rr[l2_set] : l2_lo[L2_WAY_BITS-1:0];
+        for (int i = 0; i < L2_WAYS; i++) begin
+            if (!found && i >= l2_lo && i < l2_hi && !l2_valid[l2_set][i]) begin
+                l2_victim_way = i[L2_WAY_BITS-1:0];
+                found = 1'b1;
+            end
+        end
+        
+        found = 1'b0;
+        l3_victim_way = ({1'b0, l3_rr[l3_set]} >= l3_lo && {1'b0, l3_rr[l3_set]} < l3_hi) ?
+                        l3_rr[l3_set] : l3_lo[L3_WAY_BITS-1:0];
+        for (int i = 0; i < L3_WAYS; i++) begin
+            if (!found && i >= l3_lo && i < l3_hi && !l3_valid[l3_set][i]) begin
+                l3_victim_way = i[L3_WAY_BITS-1:0];
+                found = 1'b1;
+            end
+        end
+    end
+    
     // Main state machine
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             current_state <= IDLE;
             req_ready <= 1'b1;
+            req_done <= 1'b0;
             mem_req <= 1'b0;
+            current_is_prefetch <= 1'b0;
+            pf_valid <= '0;
+            pf_remaining <= '0;
+            l2_fill_way <= '0;
+            
+            l1_hits <= '0;
+            l1_misses <= '0;
+            l2_hits <= '0;
+            l2_misses <= '0;
+            l3_hits <= '0;
+            l3_misses <= '0;
+            l1_gpu_hits <= '0;
+            l1_gpu_misses <= '0;
+            l2_gpu_hits <= '0;
+            l2_gpu_misses <= '0;
+            l3_gpu_hits <= '0;
+            l3_gpu_misses <= '0;
             
             // Initialize L1 cache
             for (int i = 0; i < L1_SETS; i++) begin
@@ -130,8 +332,23 @@ module cache_hierarchy #(
                 end
                 l1_lru[i] <= 2'b00;
             end
+            
+            // L2/L3 only need their valid bits cleared
+            for (int i = 0; i < L2_SETS; i++) begin
+                for (int j = 0; j < L2_WAYS; j++) begin
+                    l2_valid[i][j] <= 1'b0;
+                end
+                l2_rr[i] <= '0;
+            end
+            for (int i = 0; i < L3_SETS; i++) begin
+                for (int j = 0; j < L3_WAYS; j++) begin
+                    l3_valid[i][j] <= 1'b0;
+                end
+                l3_rr[i] <= '0;
+            end
         end else begin
             current_state <= next_state;
+            req_done <= 1'b0;
             
             case (current_state)
                 IDLE: begin
@@ -141,55 +358,120 @@ module cache_hierarchy #(
                         current_wdata <= req_wdata;
                         current_we <= req_we;
                         current_is_gpu <= req_is_gpu;
+                        current_is_prefetch <= 1'b0;
+                        current_line <= req_line;
+                        current_wmask <= req_wmask;
+                        current_line_wdata <= req_line_wdata;
                         req_ready <= 1'b0;
+                        
+                        // Train on every new line a GPU unit touches; words in
+                        // the same line leave the stream alone
+                        if (req_is_gpu && !(pf_valid[train_idx] && train_delta == '0)) begin
+                            pf_valid[train_idx] <= 1'b1;
+                            pf_last_line[train_idx] <= train_line;
+                            if (train_match && pf_enable) begin
+                                pf_next_line <= train_line + train_delta;
+                                pf_next_stride <= train_delta;
+                                pf_remaining <= pf_degree;
+                            end
+                            pf_stride[train_idx] <= train_delta;
+                        end
+                    end else if (pf_enable && pf_remaining != 0) begin
+                        // Idle cycle: run one prefetch through the miss path
+                        current_addr <= {pf_next_line, {OFFSET_BITS{1'b0}}};
+                        current_we <= 1'b0;
+                        current_is_gpu <= 1'b1;
+                        current_is_prefetch <= 1'b1;
+                        current_line <= 1'b0;
+                        req_ready <= 1'b0;
+                        pf_next_line <= pf_next_line + pf_next_stride;
+                        pf_remaining <= pf_remaining - 4'h1;
                     end
                 end
                 
                 L1_LOOKUP: begin
                     // L1 lookup is combinational, move to next state
+                    if (!current_is_prefetch) begin
+                        if (l1_hit) l1_hits <= l1_hits + 1;
+                        else l1_misses <= l1_misses + 1;
+                        if (current_is_gpu && l1_hit) l1_gpu_hits <= l1_gpu_hits + 1;
+                        if (current_is_gpu && !l1_hit) l1_gpu_misses <= l1_gpu_misses + 1;
+                    end
                 end
                 
                 L1_HIT_SERVE: begin
                     if (current_we) begin
                         // Write hit
-                        l1_data[l1_set][l1_hit_way] <= update_cache_line(
-                            l1_data[l1_set][l1_hit_way], 
-                            current_wdata, 
-                            offset
-                        );
+                        l1_data[l1_set][l1_hit_way] <= write_line(l1_data[l1_set][l1_hit_way]);
                         l1_dirty[l1_set][l1_hit_way] <= 1'b1;
                     end else begin
                         // Read hit
                         req_rdata <= extract_word(l1_data[l1_set][l1_hit_way], offset);
+                        req_line_rdata <= l1_data[l1_set][l1_hit_way];
                     end
+                    req_done <= 1'b1;
                     
                     // Update LRU
                     l1_lru[l1_set] <= update_l1_lru(l1_lru[l1_set], l1_hit_way);
                 end
                 
                 L1_MISS_L2: begin
-                    // Check if victim line needs writeback
-                    if (l1_dirty[l1_set][l1_victim_way] && l1_valid[l1_set][l1_victim_way]) begin
-                        next_state <= WRITEBACK;
-                    end else begin
-                        // Proceed to L2 lookup (simplified - direct to memory for now)
-                        next_state <= L3_MISS_MEM;
-                    end
+                    // Victim writeback or L2 lookup is chosen by the next
+                    // state logic
                 end
                 
                 WRITEBACK: begin
                     if (!mem_req) begin
-                        mem_addr <= {l1_tags[l1_set][l1_victim_way], l1_set, {OFFSET_BITS{1'b0}}};
+                        mem_addr <= probe_addr;
                         mem_wdata <= l1_data[l1_set][l1_victim_way];
                         mem_we <= 1'b1;
                         mem_req <= 1'b1;
                     end else if (mem_ack) begin
                         mem_req <= 1'b0;
                         l1_dirty[l1_set][l1_victim_way] <= 1'b0;
-                        next_state <= L3_MISS_MEM;
+                        
+                        // Keep clean lower-level copies of the victim current
+                        if (l2_hit) l2_data[l2_set][l2_hit_way] <= l1_data[l1_set][l1_victim_way];
+                        if (l3_hit) l3_data[l3_set][l3_hit_way] <= l1_data[l1_set][l1_victim_way];
                     end
                 end
                 
+                L2_LOOKUP: begin
+                    if (!current_is_prefetch) begin
+                        if (l2_hit) l2_hits <= l2_hits + 1;
+                        else l2_misses <= l2_misses + 1;
+                        if (current_is_gpu && l2_hit) l2_gpu_hits <= l2_gpu_hits + 1;
+                        if (current_is_gpu && !l2_hit) l2_gpu_misses <= l2_gpu_misses + 1;
+                    end
+                end
+                
+                L2_HIT_FILL: begin
+                    fill_line <= l2_data[l2_set][l2_hit_way];
+                end
+                
+                L2_MISS_L3: begin
+                    // Reserve the L2 way the line will be installed in
+                    l2_fill_way <= l2_victim_way;
+                    l2_rr[l2_set] <= ({1'b0, l2_victim_way} + 1 >= l2_hi) ?
+                                     l2_lo[L2_WAY_BITS-1:0] : l2_victim_way + 1;
+                end
+                
+                L3_LOOKUP: begin
+                    if (!current_is_prefetch) begin
+                        if (l3_hit) l3_hits <= l3_hits + 1;
+                        else l3_misses <= l3_misses + 1;
+                        if (current_is_gpu && l3_hit) l3_gpu_hits <= l3_gpu_hits + 1;
+                        if (current_is_gpu && !l3_hit) l3_gpu_misses <= l3_gpu_misses + 1;
+                    end
+                end
+                
+                L3_HIT_FILL: begin
+                    fill_line <= l3_data[l3_set][l3_hit_way];
+                    l2_data[l2_set][l2_fill_way] <= l3_data[l3_set][l3_hit_way];
+                    l2_tags[l2_set][l2_fill_way] <= l2_tag;
+                    l2_valid[l2_set][l2_fill_way] <= 1'b1;
+                end
+                
                 L3_MISS_MEM: begin
                     if (!mem_req) begin
                         mem_addr <= {current_addr[ADDR_WIDTH-1:OFFSET_BITS], {OFFSET_BITS{1'b0}}};
@@ -197,30 +479,45 @@ module cache_hierarchy #(
                         mem_req <= 1'b1;
                     end else if (mem_ack) begin
                         mem_req <= 1'b0;
-                        next_state <= FILL_L1;
+                        fill_line <= mem_rdata;
+                        
+                        // Install in both lower levels
+                        l3_data[l3_set][l3_victim_way] <= mem_rdata;
+                        l3_tags[l3_set][l3_victim_way] <= l3_tag;
+                        l3_valid[l3_set][l3_victim_way] <= 1'b1;
+                        l3_rr[l3_set] <= ({1'b0, l3_victim_way} + 1 >= l3_hi) ?
+                                         l3_lo[L3_WAY_BITS-1:0] : l3_victim_way + 1;
+                        l2_data[l2_set][l2_fill_way] <= mem_rdata;
+                        l2_tags[l2_set][l2_fill_way] <= l2_tag;
+                        l2_valid[l2_set][l2_fill_way] <= 1'b1;
                     end
                 end
                 
                 FILL_L1: begin
                     // Fill L1 cache line
-                    l1_data[l1_set][l1_victim_way] <= mem_rdata;
+                    l1_data[l1_set][l1_victim_way] <= fill_line;
                     l1_tags[l1_set][l1_victim_way] <= l1_tag;
                     l1_valid[l1_set][l1_victim_way] <= 1'b1;
                     l1_dirty[l1_set][l1_victim_way] <= 1'b0;
                     
-                    // Serve the original request
-                    if (current_we) begin
-                        l1_data[l1_set][l1_victim_way] <= update_cache_line(
-                            mem_rdata, current_wdata, offset
-                        );
+                    // Serve the original request; a prefetch only fills
+                    if (current_is_prefetch) begin
+                        // Nothing to return
+                    end else if (current_we) begin
+                        l1_data[l1_set][l1_victim_way] <= write_line(fill_line);
                         l1_dirty[l1_set][l1_victim_way] <= 1'b1;
                     end else begin
-                        req_rdata <= extract_word(mem_rdata, offset);
+                        req_rdata <= extract_word(fill_line, offset);
+                        req_line_rdata <= fill_line;
                     end
+                    req_done <= !current_is_prefetch;
                     
                     // Update LRU
                     l1_lru[l1_set] <= update_l1_lru(l1_lru[l1_set], l1_victim_way);
                 end
+                
+                default: begin
+                end
             endcase
         end
     end
@@ -230,10 +527,10 @@ module cache_hierarchy #(
         next_state = current_state;
         case (current_state)
             IDLE: begin
-                if (req_valid) next_state = L1_LOOKUP;
+                if (req_valid || (pf_enable && pf_remaining != 0)) next_state = L1_LOOKUP;
             end
             L1_LOOKUP: begin
-                if (l1_hit) next_state = L1_HIT_SERVE;
+                if (l1_hit) next_state = current_is_prefetch ? IDLE : L1_HIT_SERVE;
                 else next_state = L1_MISS_L2;
             end
             L1_HIT_SERVE: next_state = IDLE;
@@ -241,18 +538,38 @@ module cache_hierarchy #(
                 if (l1_dirty[l1_set][l1_victim_way] && l1_valid[l1_set][l1_victim_way]) 
                     next_state = WRITEBACK;
                 else 
-                    next_state = L3_MISS_MEM;
+                    next_state = L2_LOOKUP;
             end
             WRITEBACK: begin
-                if (mem_ack) next_state = L3_MISS_MEM;
+                if (mem_ack) next_state = L2_LOOKUP;
             end
+            L2_LOOKUP: next_state = l2_hit ? L2_HIT_FILL : L2_MISS_L3;
+            L2_HIT_FILL: next_state = FILL_L1;
+            L2_MISS_L3: next_state = L3_LOOKUP;
+            L3_LOOKUP: next_state = l3_hit ? L3_HIT_FILL : L3_MISS_MEM;
+            L3_HIT_FILL: next_state = FILL_L1;
             L3_MISS_MEM: begin
                 if (mem_ack) next_state = FILL_L1;
             end
             FILL_L1: next_state = IDLE;
+            default: next_state = IDLE;
         endcase
     end
     
+    // Apply the current write (one word, or a masked line) to a cache line
+    function automatic logic [CACHE_LINE_WIDTH-1:0] write_line(
+        input logic [CACHE_LINE_WIDTH-1:0] cache_line
+    );
+        logic [CACHE_LINE_WIDTH-1:0] result;
+        
+        if (!current_line) return update_cache_line(cache_line, current_wdata, offset);
+        result = cache_line;
+        for (int w = 0; w < LINE_WORDS; w++) begin
+            if (current_wmask[w]) result[w*32 +: 32] = current_line_wdata[w*32 +: 32];
+        end
+        return result;
+    endfunction
+    
     // Helper functions
     function logic [CACHE_LINE_WIDTH-1:0] update_cache_line;
         input logic [CACHE_LINE_WIDTH-1:0] cache_line;
@@ -0,0 +1,133 @@
+// Cache Port Arbiter - puts the CPU and GPU array in front of cache_hierarchy
+// The hierarchy serves one request at a time, so GPU requests are granted
+// ahead of a waiting CPU access whenever it is ready for a new one. A CPU
+// access that has lost CPU_STARVE_LIMIT issue slots to the GPU takes the
+// next one, so a streaming GPU cannot starve the harts. The GPU tag is
+// returned with the response and doubles as the prefetch stream ID.
+
+module cache_port_arbiter #(
+    parameter ADDR_WIDTH = 32,
+    parameter DATA_WIDTH = 32,
+    parameter LINE_WIDTH = 512,
+    parameter TAG_WIDTH = 8,
+    parameter CPU_STARVE_LIMIT = 4   // GPU grants a waiting CPU access tolerates
+) (
+    input  logic clk,
+    input  logic rst_n,
+    
+    // CPU port: cpu_req is held until cpu_ack
+    input  logic cpu_req,
+    input  logic cpu_we,
+    input  logic [ADDR_WIDTH-1:0] cpu_addr,
+    input  logic [DATA_WIDTH-1:0] cpu_wdata,
+    output logic [DATA_WIDTH-1:0] cpu_rdata,
+    output logic cpu_ack,
+    
+    // GPU port: split transaction, gpu_req is held until gpu_gnt
+    input  logic gpu_req,
+    input  logic gpu_we,
+    input  logic [ADDR_WIDTH-1:0] gpu_addr,
+    input  logic [DATA_WIDTH-1:0] gpu_wdata,
+    output logic [DATA_WIDTH-1:0] gpu_rdata,
+    input  logic [TAG_WIDTH-1:0] gpu_tag,
+    output logic gpu_gnt,
+    output logic gpu_ack,
+    output logic [TAG_WIDTH-1:0] gpu_rtag,
+    input  logic gpu_line,
+    input  logic [LINE_WIDTH/32-1:0] gpu_wmask,
+    input  logic [LINE_WIDTH-1:0] gpu_line_wdata,
+    output logic [LINE_WIDTH-1:0] gpu_line_rdata,
+    
+    // cache_hierarchy request port
+    output logic [ADDR_WIDTH-1:0] req_addr,
+    output logic [DATA_WIDTH-1:0] req_wdata,
+    input  logic [DATA_WIDTH-1:0] req_rdata,
+    output logic req_valid,
+    output logic req_we,
+    input  logic req_ready,
+    input  logic req_done,
+    output logic req_is_gpu,
+    output logic [3:0] req_unit,
+    output logic req_line,
+    output logic [LINE_WIDTH/32-1:0] req_wmask,
+    output logic [LINE_WIDTH-1:0] req_line_wdata,
+    input  logic [LINE_WIDTH-1:0] req_line_rdata
+);
+
+    // One request in flight; who owns it and the tag to return
+    logic busy;
+    logic busy_is_gpu;
+    logic [TAG_WIDTH-1:0] busy_tag;
+    
+    // Issue slots the waiting CPU access has lost to the GPU
+    localparam STARVE_BITS = $clog2(CPU_STARVE_LIMIT + 1) + 1;
+    logic [STARVE_BITS-1:0] cpu_starve;
+    
+    logic can_issue;
+    logic cpu_waiting;
+    logic cpu_first;
+    logic gpu_sel;
+    logic gpu_take;
+    logic cpu_take;
+    
+    assign can_issue = !busy && req_ready;
+    // A held CPU request whose ack is visible has already been served
+    assign cpu_waiting = cpu_req && !cpu_ack;
+    assign cpu_first = cpu_waiting && (cpu_starve >= STARVE_BITS'(CPU_STARVE_LIMIT));
+    assign gpu_sel = gpu_req && !cpu_first;
+    assign gpu_take = can_issue && gpu_sel;
+    assign cpu_take = can_issue && cpu_waiting && !gpu_sel;
+    
+    assign gpu_gnt = can_issue && !cpu_first;
+    assign req_valid = gpu_take || cpu_take;
+    assign req_is_gpu = gpu_sel;
+    assign req_unit = gpu_tag[3:0];
+    assign req_addr = gpu_sel ? gpu_addr : cpu_addr;
+    assign req_wdata = gpu_sel ? gpu_wdata : cpu_wdata;
+    assign req_we = gpu_sel ? gpu_we : cpu_we;
+    assign req_line = gpu_sel && gpu_line;
+    assign req_wmask = gpu_wmask;
+    assign req_line_wdata = gpu_line_wdata;
+    
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            busy <= 1'b0;
+            busy_is_gpu <= 1'b0;
+            busy_tag <= '0;
+            cpu_starve <= '0;
+            cpu_ack <= 1'b0;
+            cpu_rdata <= '0;
+            gpu_ack <= 1'b0;
+            gpu_rtag <= '0;
+            gpu_rdata <= '0;
+            gpu_line_rdata <= '0;
+        end else begin
+            cpu_ack <= 1'b0;
+            gpu_ack <= 1'b0;
+            
+            if (!cpu_waiting || cpu_take) begin
+                cpu_starve <= '0;
+            end else if (gpu_take) begin
+                cpu_starve <= cpu_starve + 1'b1;
+            end
+            
+            if (req_valid) begin
+                busy <= 1'b1;
+                busy_is_gpu <= gpu_sel;
+                busy_tag <= gpu_tag;
+            end else if (busy && req_done) begin
+                busy <= 1'b0;
+                if (busy_is_gpu) begin
+                    gpu_ack <= 1'b1;
+                    gpu_rtag <= busy_tag;
+                    gpu_rdata <= req_rdata;
+                    gpu_line_rdata <= req_line_rdata;
+                end else begin
+                    cpu_ack <= 1'b1;
+                    cpu_rdata <= req_rdata;
+                end
+            end
+        end
+    end
+
+endmodule
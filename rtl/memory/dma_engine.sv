@@ -0,0 +1,321 @@
+// Tile DMA Engine for UnifiedRISCV
+// Walks chains of descriptors in memory and moves their data over one 32-bit
+// master port, so staging tiles does not cost the CPU a load and a store per
+// word. A descriptor either copies a 2D block of words or gathers a row-major
+// int8 matrix into 4x4 tiles, tile row by tile row, with zeros past the
+// matrix edges: the layout gpu_pack_weights_4x4 produces.
+//
+// Descriptor (8 words, word aligned):
+//   +0x00 next        next descriptor of the chain, 0 ends it
+//   +0x04 src         first source byte (any alignment for tile gathers)
+//   +0x08 dst         first destination word
+//   +0x0C src_stride  bytes between source rows
+//   +0x10 extent      [15:0] rows, [31:16] bytes per row (copies round up to words)
+//   +0x14 dst_stride  bytes between destination rows (copies only)
+//   +0x18 flags       [0] tile gather
+//   +0x1C reserved
+//
+// Chain heads written to the queue wait in a small FIFO; a write while it is
+// full is dropped, so software checks queue_free first. done_count advances
+// once per finished chain.
+
+module dma_engine #(
+    parameter QUEUE_DEPTH = 4,
+    parameter ADDR_WIDTH = 32,
+    parameter DATA_WIDTH = 32
+) (
+    input  logic clk,
+    input  logic rst_n,
+    
+    // Control (from the GPU control block)
+    input  logic queue_valid,
+    input  logic [ADDR_WIDTH-1:0] queue_addr,
+    output logic [7:0] queue_free,
+    output logic busy,
+    output logic [31:0] done_count,
+    
+    // Master port: mem_req is held until mem_ack, one word per request
+    output logic [ADDR_WIDTH-1:0] mem_addr,
+    output logic [DATA_WIDTH-1:0] mem_wdata,
+    output logic mem_req,
+    output logic mem_we,
+    input  logic [DATA_WIDTH-1:0] mem_rdata,
+    input  logic mem_ack
+);
+
+    localparam QUEUE_BITS = $clog2(QUEUE_DEPTH);
+    localparam DESC_WORDS = 7; // Words read; the last one is reserved
+    
+    localparam FLAG_TILE = 0;
+    
+    typedef enum logic [2:0] {
+        S_IDLE,
+        S_DESC,        // Fetching descriptor words
+        S_SETUP,
+        S_TILE_ROW,    // Tile gather: one 4-byte tile row per pass
+        S_TILE_READ1,  // Second source word of a row that straddles two
+        S_COPY_READ,
+        S_WRITE,
+        S_NEXT
+    } dma_state_t;
+    
+    dma_state_t state;
+    
+    // Chain head FIFO
+    logic [ADDR_WIDTH-1:0] queue [QUEUE_DEPTH];
+    logic [QUEUE_BITS-1:0] queue_rd, queue_wr;
+    logic [QUEUE_BITS:0] queue_count;
+    logic queue_push, queue_pop;
+    
+    assign queue_push = queue_valid && (queue_count != QUEUE_DEPTH);
+    assign queue_pop = (state == S_IDLE) && (queue_count != 0);
+    assign queue_free = 8'(QUEUE_DEPTH - queue_count);
+    assign busy = (state != S_IDLE) || (queue_count != 0);
+    
+    // Current descriptor
+    logic [ADDR_WIDTH-1:0] desc_addr;
+    logic [2:0] desc_word;
+    logic [31:0] desc_next, desc_src, desc_dst, desc_src_stride, desc_dst_stride;
+    logic [15:0] desc_rows, desc_cols;
+    logic desc_tile;
+    
+    // Walk state. For tile gathers row_base is the first source row of the
+    // current tile band and rows_left/cols_left count from the current tile.
+    logic [31:0] row_base, dst_row, src_ptr, dst_ptr;
+    logic [31:0] col_off;
+    logic [16:0] rows_left, cols_left;
+    logic [1:0] tile_row;
+    logic [31:0] data_word, low_word;
+    
+    // Bytes of the current tile row inside the matrix, and whether they
+    // spill into the next source word
+    logic [2:0] row_bytes;
+    logic row_valid, row_straddles;
+    
+    assign row_bytes = (cols_left >= 4) ? 3'd4 : 3'(cols_left);
+    assign row_valid = rows_left > 17'(tile_row);
+    assign row_straddles = (3'(src_ptr[1:0]) + row_bytes) > 3'd4;
+    
+    // Shift the source bytes down to the tile row and clear the padding
+    function automatic logic [31:0] tile_bytes(
+        input logic [31:0] lo,
+        input logic [31:0] hi,
+        input logic [1:0] shift,
+        input logic [2:0] count
+    );
+        logic [63:0] both;
+        logic [31:0] word;
+        both = {hi, lo} >> {shift, 3'b000};
+        word = both[31:0];
+        for (int b = 0; b < 4; b++) begin
+            if (b >= count) word[b*8 +: 8] = 8'h00;
+        end
+        return word;
+    endfunction
+    
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            queue_rd <= '0;
+            queue_wr <= '0;
+            queue_count <= '0;
+        end else begin
+            if (queue_push) begin
+                queue[queue_wr] <= queue_addr;
+                queue_wr <= QUEUE_BITS'((queue_wr + 1) % QUEUE_DEPTH);
+            end
+            if (queue_pop) begin
+                queue_rd <= QUEUE_BITS'((queue_rd + 1) % QUEUE_DEPTH);
+            end
+            queue_count <= queue_count + (queue_push ? 1 : 0) - (queue_pop ? 1 : 0);
+        end
+    end
+    
+    // Each access state raises mem_req on entry and moves on at mem_ack;
+    // req then drops for a cycle, as the CPU's does between accesses
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            state <= S_IDLE;
+            mem_addr <= '0;
+            mem_wdata <= '0;
+            mem_req <= 1'b0;
+            mem_we <= 1'b0;
+            done_count <= '0;
+            desc_addr <= '0;
+            desc_word <= '0;
+            desc_next <= '0;
+            desc_src <= '0;
+            desc_dst <= '0;
+            desc_src_stride <= '0;
+            desc_dst_stride <= '0;
+            desc_rows <= '0;
+            desc_cols <= '0;
+            desc_tile <= 1'b0;
+            row_base <= '0;
+            dst_row <= '0;
+            src_ptr <= '0;
+            dst_ptr <= '0;
+            col_off <= '0;
+            rows_left <= '0;
+            cols_left <= '0;
+            tile_row <= '0;
+            data_word <= '0;
+            low_word <= '0;
+        end else begin
+            case (state)
+                S_IDLE: begin
+                    if (queue_pop) begin
+                        desc_addr <= queue[queue_rd];
+                        desc_word <= '0;
+                        state <= S_DESC;
+                    end
+                end
+                
+                S_DESC: begin
+                    if (!mem_req) begin
+                        mem_addr <= desc_addr + {27'b0, desc_word, 2'b00};
+                        mem_we <= 1'b0;
+                        mem_req <= 1'b1;
+                    end else if (mem_ack) begin
+                        mem_req <= 1'b0;
+                        case (desc_word)
+                            3'd0: desc_next <= mem_rdata;
+                            3'd1: desc_src <= mem_rdata;
+                            3'd2: desc_dst <= mem_rdata;
+                            3'd3: desc_src_stride <= mem_rdata;
+                            3'd4: {desc_cols, desc_rows} <= mem_rdata;
+                            3'd5: desc_dst_stride <= mem_rdata;
+                            default: desc_tile <= mem_rdata[FLAG_TILE];
+                        endcase
+                        desc_word <= desc_word + 1;
+                        if (desc_word == DESC_WORDS - 1) begin
+                            state <= S_SETUP;
+                        end
+                    end
+                end
+                
+                S_SETUP: begin
+                    row_base <= desc_src;
+                    dst_row <= desc_dst;
+                    src_ptr <= desc_src;
+                    dst_ptr <= desc_dst;
+                    col_off <= '0;
+                    rows_left <= 17'(desc_rows);
+                    cols_left <= 17'(desc_cols);
+                    tile_row <= '0;
+                    if (desc_rows == 0 || desc_cols == 0) begin
+                        state <= S_NEXT;
+                    end else begin
+                        state <= desc_tile ? S_TILE_ROW : S_COPY_READ;
+                    end
+                end
+                
+                S_TILE_ROW: begin
+                    if (!row_valid) begin
+                        // Bottom padding: nothing to read
+                        data_word <= '0;
+                        state <= S_WRITE;
+                    end else if (!mem_req) begin
+                        mem_addr <= {src_ptr[31:2], 2'b00};
+                        mem_we <= 1'b0;
+                        mem_req <= 1'b1;
+                    end else if (mem_ack) begin
+                        mem_req <= 1'b0;
+                        low_word <= mem_rdata;
+                        data_word <= tile_bytes(mem_rdata, '0, src_ptr[1:0], row_bytes);
+                        state <= row_straddles ? S_TILE_READ1 : S_WRITE;
+                    end
+                end
+                
+                S_TILE_READ1: begin
+                    if (!mem_req) begin
+                        mem_addr <= {src_ptr[31:2], 2'b00} + 32'd4;
+                        mem_we <= 1'b0;
+                        mem_req <= 1'b1;
+                    end else if (mem_ack) begin
+                        mem_req <= 1'b0;
+                        data_word <= tile_bytes(low_word, mem_rdata, src_ptr[1:0], row_bytes);
+                        state <= S_WRITE;
+                    end
+                end
+                
+                S_COPY_READ: begin
+                    if (!mem_req) begin
+                        mem_addr <= src_ptr;
+                        mem_we <= 1'b0;
+                        mem_req <= 1'b1;
+                    end else if (mem_ack) begin
+                        mem_req <= 1'b0;
+                        data_word <= mem_rdata;
+                        state <= S_WRITE;
+                    end
+                end
+                
+                S_WRITE: begin
+                    if (!mem_req) begin
+                        mem_addr <= dst_ptr;
+                        mem_wdata <= data_word;
+                        mem_we <= 1'b1;
+                        mem_req <= 1'b1;
+                    end else if (mem_ack) begin
+                        mem_req <= 1'b0;
+                        mem_we <= 1'b0;
+                        dst_ptr <= dst_ptr + 32'd4;
+                        
+                        if (desc_tile) begin
+                            state <= S_TILE_ROW;
+                            if (tile_row != 2'd3) begin
+                                tile_row <= tile_row + 1;
+                                src_ptr <= src_ptr + desc_src_stride;
+                            end else if (cols_left > 4) begin
+                                // Next tile of the band
+                                tile_row <= '0;
+                                col_off <= col_off + 32'd4;
+                                cols_left <= cols_left - 17'd4;
+                                src_ptr <= row_base + col_off + 32'd4;
+                            end else if (rows_left > 4) begin
+                                // First tile of the next band
+                                tile_row <= '0;
+                                col_off <= '0;
+                                cols_left <= 17'(desc_cols);
+                                rows_left <= rows_left - 17'd4;
+                                row_base <= row_base + (desc_src_stride << 2);
+                                src_ptr <= row_base + (desc_src_stride << 2);
+                            end else begin
+                                state <= S_NEXT;
+                            end
+                        end else begin
+                            state <= S_COPY_READ;
+                            if (cols_left > 4) begin
+                                cols_left <= cols_left - 17'd4;
+                                src_ptr <= src_ptr + 32'd4;
+                            end else if (rows_left > 1) begin
+                                cols_left <= 17'(desc_cols);
+                                rows_left <= rows_left - 17'd1;
+                                row_base <= row_base + desc_src_stride;
+                                dst_row <= dst_row + desc_dst_stride;
+                                src_ptr <= row_base + desc_src_stride;
+                                dst_ptr <= dst_row + desc_dst_stride;
+                            end else begin
+                                state <= S_NEXT;
+                            end
+                        end
+                    end
+                end
+                
+                S_NEXT: begin
+                    if (desc_next != 0) begin
+                        desc_addr <= desc_next;
+                        desc_word <= '0;
+                        state <= S_DESC;
+                    end else begin
+                        done_count <= done_count + 1;
+                        state <= S_IDLE;
+                    end
+                end
+                
+                default: state <= S_IDLE;
+            endcase
+        end
+    end
+
+endmodule
@@ -0,0 +1,116 @@
+// GPU Scratchpad - software-managed tile memory (TCM) for the GPU array
+// Mapped at GPU_SPAD_BASE, next to the GPU control block. GPU accesses bypass
+// the L1 entirely and are answered on the next cycle; the CPU port lets
+// kernels stage packed weights before dispatching work that reads them.
+
+module gpu_scratchpad #(
+    parameter SIZE_BYTES = 64 * 1024,
+    parameter LINE_WIDTH = 512,
+    parameter ADDR_WIDTH = 32,
+    parameter DATA_WIDTH = 32
+) (
+    input  logic clk,
+    input  logic rst_n,
+    
+    // GPU port: gpu_req is a one-cycle strobe, gpu_ack follows next cycle
+    input  logic gpu_req,
+    input  logic gpu_we,
+    input  logic [ADDR_WIDTH-1:0] gpu_addr,
+    input  logic [DATA_WIDTH-1:0] gpu_wdata,
+    output logic [DATA_WIDTH-1:0] gpu_rdata,
+    input  logic gpu_line,                      // Whole-line access
+    input  logic [LINE_WIDTH/32-1:0] gpu_wmask, // Word enables for line writes
+    input  logic [LINE_WIDTH-1:0] gpu_line_wdata,
+    output logic [LINE_WIDTH-1:0] gpu_line_rdata,
+    output logic gpu_ack,
+    
+    // CPU port: cpu_req is held until cpu_ack, one word per request
+    input  logic cpu_req,
+    input  logic cpu_we,
+    input  logic [ADDR_WIDTH-1:0] cpu_addr,
+    input  logic [DATA_WIDTH-1:0] cpu_wdata,
+    output logic [DATA_WIDTH-1:0] cpu_rdata,
+    output logic cpu_ack
+);
+
+    localparam LINE_WORDS = LINE_WIDTH / 32;
+    localparam NUM_LINES = SIZE_BYTES / (LINE_WIDTH / 8);
+    localparam INDEX_BITS = $clog2(NUM_LINES);
+    localparam OFFSET_BITS = $clog2(LINE_WIDTH / 8);
+    localparam WORD_BITS = $clog2(LINE_WORDS);
+    
+    logic [LINE_WIDTH-1:0] spad_mem [NUM_LINES-1:0];
+    
+    // Only the offset within the scratchpad is decoded; the requester has
+    // already matched the address range
+    logic [INDEX_BITS-1:0] gpu_index, cpu_index;
+    logic [WORD_BITS-1:0] gpu_word, cpu_word;
+    
+    assign gpu_index = gpu_addr[INDEX_BITS+OFFSET_BITS-1:OFFSET_BITS];
+    assign gpu_word = gpu_addr[OFFSET_BITS-1:2];
+    assign cpu_index = cpu_addr[INDEX_BITS+OFFSET_BITS-1:OFFSET_BITS];
+    assign cpu_word = cpu_addr[OFFSET_BITS-1:2];
+    
+    // A held CPU request whose ack is visible has already been served
+    logic cpu_take;
+    assign cpu_take = cpu_req && !cpu_ack;
+    
+    // Both ports write through word enables on a whole line; single-word
+    // writes replicate the data and enable one word
+    logic [LINE_WORDS-1:0] gpu_word_en, cpu_word_en;
+    logic [LINE_WIDTH-1:0] gpu_write_line, cpu_write_line;
+    
+    always_comb begin
+        gpu_word_en = '0;
+        gpu_write_line = gpu_line ? gpu_line_wdata : {LINE_WORDS{gpu_wdata}};
+        if (gpu_req && gpu_we) begin
+            if (gpu_line) begin
+                gpu_word_en = gpu_wmask;
+            end else begin
+                gpu_word_en[gpu_word] = 1'b1;
+            end
+        end
+        
+        cpu_word_en = '0;
+        cpu_write_line = {LINE_WORDS{cpu_wdata}};
+        if (cpu_take && cpu_we) begin
+            cpu_word_en[cpu_word] = 1'b1;
+        end
+    end
+    
+    // Storage has no reset. The GPU write is applied last, so it wins when
+    // both ports write the same word in the same cycle.
+    always_ff @(posedge clk) begin
+        for (int w = 0; w < LINE_WORDS; w++) begin
+            if (cpu_word_en[w]) begin
+                spad_mem[cpu_index][w*32 +: 32] <= cpu_write_line[w*32 +: 32];
+            end
+            if (gpu_word_en[w]) begin
+                spad_mem[gpu_index][w*32 +: 32] <= gpu_write_line[w*32 +: 32];
+            end
+        end
+    end
+    
+    // Fixed one-cycle response on both ports
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            gpu_ack <= 1'b0;
+            gpu_rdata <= '0;
+            gpu_line_rdata <= '0;
+            cpu_ack <= 1'b0;
+            cpu_rdata <= '0;
+        end else begin
+            gpu_ack <= gpu_req;
+            if (gpu_req && !gpu_we) begin
+                gpu_rdata <= spad_mem[gpu_index][gpu_word*32 +: 32];
+                gpu_line_rdata <= spad_mem[gpu_index];
+            end
+            
+            cpu_ack <= cpu_take;
+            if (cpu_take && !cpu_we) begin
+                cpu_rdata <= spad_mem[cpu_index][cpu_word*32 +: 32];
+            end
+        end
+    end
+
+endmodule
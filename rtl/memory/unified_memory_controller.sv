@@ -1,11 +1,18 @@
 // Unified Memory Controller with GPU Priority for ML Workloads
 // M1-inspired design with 512-bit cache lines and 16 banks
+// Non-blocking: the L1 is split into line-interleaved banks, each with its own
+// request queue, and misses park in MSHRs so later hits keep flowing.
 
 module unified_memory_controller #(
     parameter CACHE_LINE_WIDTH = 512,
-    parameter NUM_BANKS = 16,
+    parameter NUM_BANKS = 16,       // Power of two, at most CACHE_SETS / 2
     parameter ADDR_WIDTH = 32,
-    parameter DATA_WIDTH = 32
+    parameter DATA_WIDTH = 32,
+    parameter GPU_TAG_WIDTH = 8,
+    parameter GPU_QUEUE_DEPTH = 4,  // GPU requests accepted ahead of service
+    parameter BANK_QUEUE_DEPTH = 2, // Requests waiting per bank
+    parameter NUM_MSHRS = 4,        // Misses outstanding to external memory
+    parameter BANK_XOR_HASH = 1     // XOR low tag bits into the bank index
 ) (
     input  logic clk,
     input  logic rst_n,
@@ -18,13 +25,21 @@ module unified_memory_controller #(
     input  logic cpu_we,
     output logic cpu_ack,
     
-    // GPU interface (higher priority)
+    // GPU interface (higher priority, split transaction): a request is taken
+    // when gpu_gnt is high and answered later by gpu_ack with its tag
     input  logic [ADDR_WIDTH-1:0] gpu_addr,
     input  logic [DATA_WIDTH-1:0] gpu_wdata,
     output logic [DATA_WIDTH-1:0] gpu_rdata,
     input  logic gpu_req,
     input  logic gpu_we,
+    input  logic [GPU_TAG_WIDTH-1:0] gpu_tag,
+    output logic gpu_gnt,
     output logic gpu_ack,
+    output logic [GPU_TAG_WIDTH-1:0] gpu_rtag,
+    input  logic gpu_line,                            // Whole-line access
+    input  logic [CACHE_LINE_WIDTH/32-1:0] gpu_wmask, // Word enables for line writes
+    input  logic [CACHE_LINE_WIDTH-1:0] gpu_line_wdata,
+    output logic [CACHE_LINE_WIDTH-1:0] gpu_line_rdata,
     
     // External memory interface (512-bit wide)
     output logic [ADDR_WIDTH-1:0] mem_addr,
@@ -32,236 +47,518 @@ module unified_memory_controller #(
     input  logic [CACHE_LINE_WIDTH-1:0] mem_rdata,
     output logic mem_req,
     output logic mem_we,
-    input  logic mem_ack
+    input  logic mem_ack,
+    
+    // Statistics, free running from reset. A miss is counted once, when it
+    // takes an MSHR; bank conflicts count requests held back by a full bank
+    // queue, a same-bank dispatch tie or the memory engine using the bank.
+    output logic [31:0] cpu_hits,
+    output logic [31:0] cpu_misses,
+    output logic [31:0] gpu_hits,
+    output logic [31:0] gpu_misses,
+    output logic [31:0] bank_conflicts
 );
 
     // L1 Cache parameters
     localparam CACHE_SIZE = 32 * 1024; // 32KB L1 cache
     localparam CACHE_WAYS = 4;
     localparam CACHE_SETS = CACHE_SIZE / (CACHE_WAYS * CACHE_LINE_WIDTH / 8);
-    localparam SET_BITS = $clog2(CACHE_SETS);
     localparam OFFSET_BITS = $clog2(CACHE_LINE_WIDTH / 8);
-    localparam TAG_BITS = ADDR_WIDTH - SET_BITS - OFFSET_BITS;
-    
-    // Cache structures
-    logic [TAG_BITS-1:0] cache_tags [CACHE_SETS-1:0][CACHE_WAYS-1:0];
-    logic [CACHE_LINE_WIDTH-1:0] cache_data [CACHE_SETS-1:0][CACHE_WAYS-1:0];
-    logic cache_valid [CACHE_SETS-1:0][CACHE_WAYS-1:0];
-    logic cache_dirty [CACHE_SETS-1:0][CACHE_WAYS-1:0];
-    logic [1:0] cache_lru [CACHE_SETS-1:0]; // Simple 2-bit LRU for 4-way
-    
-    // Memory banking
-    logic [3:0] bank_select;
-    logic [NUM_BANKS-1:0] bank_busy;
-    logic [NUM_BANKS-1:0] bank_req;
-    logic [ADDR_WIDTH-1:0] bank_addr [NUM_BANKS-1:0];
-    
-    // Request arbitration
-    typedef enum logic [2:0] {
-        IDLE,
-        GPU_ACCESS,
-        CPU_ACCESS,
-        CACHE_FILL,
-        CACHE_WRITEBACK
-    } arbiter_state_t;
-    
-    arbiter_state_t current_state, next_state;
-    
-    // Current request tracking
-    logic [ADDR_WIDTH-1:0] current_addr;
-    logic [DATA_WIDTH-1:0] current_wdata;
-    logic current_we;
-    logic is_gpu_req;
-    
-    // Cache lookup signals
-    logic [SET_BITS-1:0] cache_set;
-    logic [TAG_BITS-1:0] cache_tag;
-    logic [OFFSET_BITS-1:0] cache_offset;
-    logic cache_hit;
-    logic [1:0] hit_way;
-    logic [1:0] victim_way;
-    
-    // Address decomposition
-    assign cache_set = current_addr[SET_BITS+OFFSET_BITS-1:OFFSET_BITS];
-    assign cache_tag = current_addr[ADDR_WIDTH-1:SET_BITS+OFFSET_BITS];
-    assign cache_offset = current_addr[OFFSET_BITS-1:0];
-    assign bank_select = current_addr[7:4]; // Simple bank mapping
-    
-    // Cache hit detection
+    
+    // Banking: consecutive lines go to consecutive banks, each bank holds
+    // CACHE_SETS / NUM_BANKS sets
+    localparam BANK_BITS = $clog2(NUM_BANKS);
+    localparam BANK_SETS = CACHE_SETS / NUM_BANKS;
+    localparam SET_BITS = $clog2(BANK_SETS);
+    localparam TAG_BITS = ADDR_WIDTH - SET_BITS - BANK_BITS - OFFSET_BITS;
+    localparam BQ_BITS = (BANK_QUEUE_DEPTH > 1) ? $clog2(BANK_QUEUE_DEPTH) : 1;
+    localparam MSHR_BITS = (NUM_MSHRS > 1) ? $clog2(NUM_MSHRS) : 1;
+    
+    // Cache structures, one slice per bank
+    logic [TAG_BITS-1:0] cache_tags [NUM_BANKS-1:0][BANK_SETS-1:0][CACHE_WAYS-1:0];
+    logic [CACHE_LINE_WIDTH-1:0] cache_data [NUM_BANKS-1:0][BANK_SETS-1:0][CACHE_WAYS-1:0];
+    logic cache_valid [NUM_BANKS-1:0][BANK_SETS-1:0][CACHE_WAYS-1:0];
+    logic cache_dirty [NUM_BANKS-1:0][BANK_SETS-1:0][CACHE_WAYS-1:0];
+    logic [1:0] cache_lru [NUM_BANKS-1:0][BANK_SETS-1:0]; // Simple 2-bit LRU for 4-way
+    
+    // GPU request queue so the fabric can issue while a request is served
+    localparam GQ_BITS = (GPU_QUEUE_DEPTH > 1) ? $clog2(GPU_QUEUE_DEPTH) : 1;
+    
+    logic [ADDR_WIDTH-1:0] gq_addr [GPU_QUEUE_DEPTH-1:0];
+    logic [DATA_WIDTH-1:0] gq_wdata [GPU_QUEUE_DEPTH-1:0];
+    logic [GPU_QUEUE_DEPTH-1:0] gq_we;
+    logic [GPU_QUEUE_DEPTH-1:0] gq_line;
+    logic [CACHE_LINE_WIDTH/32-1:0] gq_wmask [GPU_QUEUE_DEPTH-1:0];
+    logic [CACHE_LINE_WIDTH-1:0] gq_line_wdata [GPU_QUEUE_DEPTH-1:0];
+    logic [GPU_TAG_WIDTH-1:0] gq_tag [GPU_QUEUE_DEPTH-1:0];
+    logic [GQ_BITS-1:0] gq_rd_ptr, gq_wr_ptr;
+    logic [GQ_BITS:0] gq_count;
+    logic gq_push, gq_pop;
+    logic [BANK_BITS-1:0] gq_bank;
+    
+    // Per-bank request queues
+    logic [ADDR_WIDTH-1:0] bq_addr [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic [DATA_WIDTH-1:0] bq_wdata [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic bq_we [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic bq_gpu [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic bq_line [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic [CACHE_LINE_WIDTH/32-1:0] bq_wmask [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic [CACHE_LINE_WIDTH-1:0] bq_line_wdata [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic [GPU_TAG_WIDTH-1:0] bq_tag [NUM_BANKS-1:0][BANK_QUEUE_DEPTH-1:0];
+    logic [BQ_BITS-1:0] bq_rd_ptr [NUM_BANKS-1:0];
+    logic [BQ_BITS-1:0] bq_wr_ptr [NUM_BANKS-1:0];
+    logic [BQ_BITS:0] bq_count [NUM_BANKS-1:0];
+    logic [NUM_BANKS-1:0] bq_push_gpu, bq_push_cpu, bq_pop;
+    
+    // CPU request tracking: cpu_req is held until cpu_ack
+    logic cpu_pending;
+    logic cpu_take;
+    logic cpu_push;
+    logic [BANK_BITS-1:0] cpu_bank;
+    
+    // Miss status holding registers, serviced in allocation order
+    logic [ADDR_WIDTH-1:0] mshr_addr [NUM_MSHRS-1:0];
+    logic [DATA_WIDTH-1:0] mshr_wdata [NUM_MSHRS-1:0];
+    logic [NUM_MSHRS-1:0] mshr_valid;
+    logic [NUM_MSHRS-1:0] mshr_we;
+    logic [NUM_MSHRS-1:0] mshr_gpu;
+    logic [NUM_MSHRS-1:0] mshr_line;
+    logic [CACHE_LINE_WIDTH/32-1:0] mshr_wmask [NUM_MSHRS-1:0];
+    logic [CACHE_LINE_WIDTH-1:0] mshr_line_wdata [NUM_MSHRS-1:0];
+    logic [GPU_TAG_WIDTH-1:0] mshr_tag [NUM_MSHRS-1:0];
+    logic [MSHR_BITS-1:0] mshr_rd_ptr, mshr_wr_ptr;
+    logic [MSHR_BITS:0] mshr_count;
+    
+    // Bank head lookup
+    logic [NUM_BANKS-1:0] head_valid;
+    logic [NUM_BANKS-1:0] head_hit;
+    logic [NUM_BANKS-1:0] head_in_mshr;
+    logic [NUM_BANKS-1:0] head_gpu;
+    logic [1:0] head_way [NUM_BANKS-1:0];
+    logic [NUM_BANKS-1:0] bank_blocked;
+    
+    // Per-cycle service picks: one GPU hit, one CPU hit, one miss allocation
+    logic [BANK_BITS-1:0] bank_rr_ptr;
+    logic gpu_hit_valid, cpu_hit_valid, miss_valid;
+    logic [BANK_BITS-1:0] gpu_hit_bank, cpu_hit_bank, miss_bank;
+    
+    // External memory engine: writes back the victim if dirty, then fills
+    typedef enum logic [1:0] {
+        MEM_IDLE,
+        MEM_WRITEBACK,
+        MEM_FILL
+    } mem_state_t;
+    
+    mem_state_t mem_state;
+    logic [1:0] mem_victim;
+    logic mem_start;
+    logic fill_done;
+    logic [ADDR_WIDTH-1:0] fill_addr;
+    logic [BANK_BITS-1:0] fill_bank;
+    logic [SET_BITS-1:0] fill_set;
+    logic [1:0] start_victim;
+    
+    // Address mapping
+    function automatic logic [TAG_BITS-1:0] addr_tag(input logic [ADDR_WIDTH-1:0] addr);
+        return addr[ADDR_WIDTH-1:SET_BITS+BANK_BITS+OFFSET_BITS];
+    endfunction
+    
+    function automatic logic [SET_BITS-1:0] addr_set(input logic [ADDR_WIDTH-1:0] addr);
+        return addr[SET_BITS+BANK_BITS+OFFSET_BITS-1:BANK_BITS+OFFSET_BITS];
+    endfunction
+    
+    // The hash only uses tag bits, so a line's bank and set together with
+    // its tag still give back its address on writeback
+    function automatic logic [BANK_BITS-1:0] bank_hash(input logic [TAG_BITS-1:0] tag);
+        return BANK_XOR_HASH ? tag[BANK_BITS-1:0] : '0;
+    endfunction
+    
+    function automatic logic [BANK_BITS-1:0] addr_bank(input logic [ADDR_WIDTH-1:0] addr);
+        return addr[BANK_BITS+OFFSET_BITS-1:OFFSET_BITS] ^ bank_hash(addr_tag(addr));
+    endfunction
+    
+    function automatic logic [ADDR_WIDTH-1:0] line_addr(
+        input logic [TAG_BITS-1:0] tag,
+        input logic [SET_BITS-1:0] set,
+        input logic [BANK_BITS-1:0] bank
+    );
+        return {tag, set, bank ^ bank_hash(tag), {OFFSET_BITS{1'b0}}};
+    endfunction
+    
+    // Dispatch: the GPU queue head and the CPU request each move to their
+    // bank's queue; the GPU wins a tie for the same bank
+    assign gpu_gnt = (gq_count < GPU_QUEUE_DEPTH);
+    assign gq_push = gpu_req && gpu_gnt;
+    assign gq_bank = addr_bank(gq_addr[gq_rd_ptr]);
+    assign gq_pop = (gq_count != 0) && (bq_count[gq_bank] < BANK_QUEUE_DEPTH);
+    
+    // A CPU request whose ack is still visible has just been served
+    assign cpu_take = cpu_req && !cpu_pending && !cpu_ack;
+    assign cpu_bank = addr_bank(cpu_addr);
+    assign cpu_push = cpu_take && (bq_count[cpu_bank] < BANK_QUEUE_DEPTH) &&
+                      !(gq_pop && gq_bank == cpu_bank);
+    
     always_comb begin
-        cache_hit = 1'b0;
-        hit_way = 2'b00;
-        for (int i = 0; i < CACHE_WAYS; i++) begin
-            if (cache_valid[cache_set][i] && 
-                cache_tags[cache_set][i] == cache_tag) begin
-                cache_hit = 1'b1;
-                hit_way = i[1:0];
-                break;
+        bq_push_gpu = '0;
+        bq_push_cpu = '0;
+        if (gq_pop) bq_push_gpu[gq_bank] = 1'b1;
+        if (cpu_push) bq_push_cpu[cpu_bank] = 1'b1;
+    end
+    
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            gq_rd_ptr <= '0;
+            gq_wr_ptr <= '0;
+            gq_count <= '0;
+        end else begin
+            if (gq_push) begin
+                gq_addr[gq_wr_ptr] <= gpu_addr;
+                gq_wdata[gq_wr_ptr] <= gpu_wdata;
+                gq_we[gq_wr_ptr] <= gpu_we;
+                gq_line[gq_wr_ptr] <= gpu_line;
+                gq_wmask[gq_wr_ptr] <= gpu_wmask;
+                gq_line_wdata[gq_wr_ptr] <= gpu_line_wdata;
+                gq_tag[gq_wr_ptr] <= gpu_tag;
+                gq_wr_ptr <= GQ_BITS'((gq_wr_ptr + 1) % GPU_QUEUE_DEPTH);
+            end
+            if (gq_pop) begin
+                gq_rd_ptr <= GQ_BITS'((gq_rd_ptr + 1) % GPU_QUEUE_DEPTH);
+            end
+            gq_count <= gq_count + (gq_push ? 1 : 0) - (gq_pop ? 1 : 0);
+        end
+    end
+    
+    // Bank head lookup. A head whose line already has an MSHR waits for the
+    // fill, which keeps same-line requests in order.
+    always_comb begin
+        for (int b = 0; b < NUM_BANKS; b++) begin
+            logic [ADDR_WIDTH-1:0] addr;
+            logic [SET_BITS-1:0] set;
+            
+            addr = bq_addr[b][bq_rd_ptr[b]];
+            set = addr_set(addr);
+            head_valid[b] = (bq_count[b] != 0);
+            head_gpu[b] = bq_gpu[b][bq_rd_ptr[b]];
+            head_hit[b] = 1'b0;
+            head_way[b] = 2'b00;
+            for (int w = 0; w < CACHE_WAYS; w++) begin
+                if (!head_hit[b] && cache_valid[b][set][w] &&
+                    cache_tags[b][set][w] == addr_tag(addr)) begin
+                    head_hit[b] = 1'b1;
+                    head_way[b] = w[1:0];
+                end
+            end
+            head_in_mshr[b] = 1'b0;
+            for (int m = 0; m < NUM_MSHRS; m++) begin
+                if (mshr_valid[m] &&
+                    mshr_addr[m][ADDR_WIDTH-1:OFFSET_BITS] == addr[ADDR_WIDTH-1:OFFSET_BITS]) begin
+                    head_in_mshr[b] = 1'b1;
+                end
             end
         end
     end
     
-    // LRU victim selection
+    // Memory engine handshake points
+    assign fill_addr = mshr_addr[mshr_rd_ptr];
+    assign fill_bank = addr_bank(fill_addr);
+    assign fill_set = addr_set(fill_addr);
+    assign start_victim = cache_lru[fill_bank][fill_set];
+    assign mem_start = (mem_state == MEM_IDLE) && (mshr_count != 0);
+    assign fill_done = (mem_state == MEM_FILL) && mem_req && mem_ack;
+    
+    // Banks touched by the memory engine this cycle skip hit service, so each
+    // bank slice sees one access per cycle
     always_comb begin
-        victim_way = cache_lru[cache_set];
+        bank_blocked = '0;
+        if (mem_start || fill_done) bank_blocked[fill_bank] = 1'b1;
+    end
+    
+    // Service picks. A fill completing for a source takes that source's
+    // response port this cycle.
+    always_comb begin
+        gpu_hit_valid = 1'b0;
+        gpu_hit_bank = '0;
+        cpu_hit_valid = 1'b0;
+        cpu_hit_bank = '0;
+        miss_valid = 1'b0;
+        miss_bank = '0;
+        for (int j = 0; j < NUM_BANKS; j++) begin
+            logic [BANK_BITS-1:0] b;
+            b = BANK_BITS'((bank_rr_ptr + j) % NUM_BANKS);
+            if (head_valid[b] && !head_in_mshr[b] && !bank_blocked[b]) begin
+                if (head_hit[b]) begin
+                    if (head_gpu[b] && !gpu_hit_valid && !(fill_done && mshr_gpu[mshr_rd_ptr])) begin
+                        gpu_hit_valid = 1'b1;
+                        gpu_hit_bank = b;
+                    end else if (!head_gpu[b] && !cpu_hit_valid &&
+                                 !(fill_done && !mshr_gpu[mshr_rd_ptr])) begin
+                        cpu_hit_valid = 1'b1;
+                        cpu_hit_bank = b;
+                    end
+                end else if (!miss_valid && mshr_count < NUM_MSHRS) begin
+                    miss_valid = 1'b1;
+                    miss_bank = b;
+                end
+            end
+        end
+        
+        bq_pop = '0;
+        if (gpu_hit_valid) bq_pop[gpu_hit_bank] = 1'b1;
+        if (cpu_hit_valid) bq_pop[cpu_hit_bank] = 1'b1;
+        if (miss_valid) bq_pop[miss_bank] = 1'b1;
+    end
+    
+    // Bank queues
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            for (int b = 0; b < NUM_BANKS; b++) begin
+                bq_rd_ptr[b] <= '0;
+                bq_wr_ptr[b] <= '0;
+                bq_count[b] <= '0;
+            end
+        end else begin
+            for (int b = 0; b < NUM_BANKS; b++) begin
+                if (bq_push_gpu[b]) begin
+                    bq_addr[b][bq_wr_ptr[b]] <= gq_addr[gq_rd_ptr];
+                    bq_wdata[b][bq_wr_ptr[b]] <= gq_wdata[gq_rd_ptr];
+                    bq_we[b][bq_wr_ptr[b]] <= gq_we[gq_rd_ptr];
+                    bq_gpu[b][bq_wr_ptr[b]] <= 1'b1;
+                    bq_line[b][bq_wr_ptr[b]] <= gq_line[gq_rd_ptr];
+                    bq_wmask[b][bq_wr_ptr[b]] <= gq_wmask[gq_rd_ptr];
+                    bq_line_wdata[b][bq_wr_ptr[b]] <= gq_line_wdata[gq_rd_ptr];
+                    bq_tag[b][bq_wr_ptr[b]] <= gq_tag[gq_rd_ptr];
+                end else if (bq_push_cpu[b]) begin
+                    bq_addr[b][bq_wr_ptr[b]] <= cpu_addr;
+                    bq_wdata[b][bq_wr_ptr[b]] <= cpu_wdata;
+                    bq_we[b][bq_wr_ptr[b]] <= cpu_we;
+                    bq_gpu[b][bq_wr_ptr[b]] <= 1'b0;
+                    bq_line[b][bq_wr_ptr[b]] <= 1'b0;
+                end
+                if (bq_push_gpu[b] || bq_push_cpu[b]) begin
+                    bq_wr_ptr[b] <= BQ_BITS'((bq_wr_ptr[b] + 1) % BANK_QUEUE_DEPTH);
+                end
+                if (bq_pop[b]) begin
+                    bq_rd_ptr[b] <= BQ_BITS'((bq_rd_ptr[b] + 1) % BANK_QUEUE_DEPTH);
+                end
+                bq_count[b] <= bq_count[b] + ((bq_push_gpu[b] || bq_push_cpu[b]) ? 1 : 0) -
+                               (bq_pop[b] ? 1 : 0);
+            end
+        end
     end
     
-    // Main state machine
+    // Hit service, MSHR allocation and the external memory engine
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            current_state <= IDLE;
             cpu_ack <= 1'b0;
+            cpu_pending <= 1'b0;
             gpu_ack <= 1'b0;
+            gpu_rtag <= '0;
             mem_req <= 1'b0;
+            mem_we <= 1'b0;
+            mem_state <= MEM_IDLE;
+            mem_victim <= 2'b00;
+            bank_rr_ptr <= '0;
+            mshr_rd_ptr <= '0;
+            mshr_wr_ptr <= '0;
+            mshr_count <= '0;
+            mshr_valid <= '0;
             
             // Initialize cache
-            for (int i = 0; i < CACHE_SETS; i++) begin
-                for (int j = 0; j < CACHE_WAYS; j++) begin
-                    cache_valid[i][j] <= 1'b0;
-                    cache_dirty[i][j] <= 1'b0;
-                    cache_tags[i][j] <= '0;
-                    cache_data[i][j] <= '0;
+            for (int b = 0; b < NUM_BANKS; b++) begin
+                for (int i = 0; i < BANK_SETS; i++) begin
+                    for (int j = 0; j < CACHE_WAYS; j++) begin
+                        cache_valid[b][i][j] <= 1'b0;
+                        cache_dirty[b][i][j] <= 1'b0;
+                        cache_tags[b][i][j] <= '0;
+                        cache_data[b][i][j] <= '0;
+                    end
+                    cache_lru[b][i] <= 2'b00;
                 end
-                cache_lru[i] <= 2'b00;
             end
         end else begin
-            current_state <= next_state;
+            // Acks are single-cycle pulses
+            cpu_ack <= 1'b0;
+            gpu_ack <= 1'b0;
+            
+            if (cpu_push) cpu_pending <= 1'b1;
             
-            case (current_state)
-                IDLE: begin
-                    cpu_ack <= 1'b0;
-                    gpu_ack <= 1'b0;
-                    
-                    // GPU has priority over CPU
-                    if (gpu_req) begin
-                        current_addr <= gpu_addr;
-                        current_wdata <= gpu_wdata;
-                        current_we <= gpu_we;
-                        is_gpu_req <= 1'b1;
-                    end else if (cpu_req) begin
-                        current_addr <= cpu_addr;
-                        current_wdata <= cpu_wdata;
-                        current_we <= cpu_we;
-                        is_gpu_req <= 1'b0;
+            // GPU hit
+            if (gpu_hit_valid) begin
+                logic [BANK_BITS-1:0] b;
+                logic [BQ_BITS-1:0] q;
+                logic [SET_BITS-1:0] set;
+                logic [1:0] way;
+                
+                b = gpu_hit_bank;
+                q = bq_rd_ptr[b];
+                set = addr_set(bq_addr[b][q]);
+                way = head_way[b];
+                if (bq_we[b][q]) begin
+                    if (bq_line[b][q]) begin
+                        cache_data[b][set][way] <= merge_cache_line(
+                            cache_data[b][set][way], bq_line_wdata[b][q], bq_wmask[b][q]
+                        );
+                    end else begin
+                        cache_data[b][set][way] <= update_cache_line(
+                            cache_data[b][set][way], bq_wdata[b][q], bq_addr[b][q][OFFSET_BITS-1:0]
+                        );
                     end
+                    cache_dirty[b][set][way] <= 1'b1;
+                end else if (bq_line[b][q]) begin
+                    gpu_line_rdata <= cache_data[b][set][way];
+                end else begin
+                    gpu_rdata <= extract_word(cache_data[b][set][way], bq_addr[b][q][OFFSET_BITS-1:0]);
                 end
+                cache_lru[b][set] <= update_lru(cache_lru[b][set], way);
+                gpu_ack <= 1'b1;
+                gpu_rtag <= bq_tag[b][q];
+                bank_rr_ptr <= BANK_BITS'((b + 1) % NUM_BANKS);
+            end
+            
+            // CPU hit
+            if (cpu_hit_valid) begin
+                logic [BANK_BITS-1:0] b;
+                logic [BQ_BITS-1:0] q;
+                logic [SET_BITS-1:0] set;
+                logic [1:0] way;
                 
-                GPU_ACCESS, CPU_ACCESS: begin
-                    if (cache_hit) begin
-                        // Cache hit - serve immediately
-                        if (current_we) begin
-                            // Write hit
-                            cache_data[cache_set][hit_way] <= update_cache_line(
-                                cache_data[cache_set][hit_way], 
-                                current_wdata, 
-                                cache_offset
-                            );
-                            cache_dirty[cache_set][hit_way] <= 1'b1;
-                        end else begin
-                            // Read hit
-                            if (is_gpu_req) begin
-                                gpu_rdata <= extract_word(cache_data[cache_set][hit_way], cache_offset);
-                            end else begin
-                                cpu_rdata <= extract_word(cache_data[cache_set][hit_way], cache_offset);
-                            end
-                        end
-                        
-                        // Update LRU
-                        cache_lru[cache_set] <= update_lru(cache_lru[cache_set], hit_way);
-                        
-                        // Acknowledge request
-                        if (is_gpu_req) gpu_ack <= 1'b1;
-                        else cpu_ack <= 1'b1;
-                        
-                    end else begin
-                        // Cache miss - need to fetch from memory
-                        if (cache_dirty[cache_set][victim_way] && 
-                            cache_valid[cache_set][victim_way]) begin
-                            // Need to writeback dirty line first
-                            // Will be handled in next state logic
+                b = cpu_hit_bank;
+                q = bq_rd_ptr[b];
+                set = addr_set(bq_addr[b][q]);
+                way = head_way[b];
+                if (bq_we[b][q]) begin
+                    cache_data[b][set][way] <= update_cache_line(
+                        cache_data[b][set][way], bq_wdata[b][q], bq_addr[b][q][OFFSET_BITS-1:0]
+                    );
+                    cache_dirty[b][set][way] <= 1'b1;
+                end else begin
+                    cpu_rdata <= extract_word(cache_data[b][set][way], bq_addr[b][q][OFFSET_BITS-1:0]);
+                end
+                cache_lru[b][set] <= update_lru(cache_lru[b][set], way);
+                cpu_ack <= 1'b1;
+                cpu_pending <= 1'b0;
+            end
+            
+            // Miss: move the bank head into an MSHR so the bank can continue
+            if (miss_valid) begin
+                logic [BQ_BITS-1:0] q;
+                q = bq_rd_ptr[miss_bank];
+                mshr_addr[mshr_wr_ptr] <= bq_addr[miss_bank][q];
+                mshr_wdata[mshr_wr_ptr] <= bq_wdata[miss_bank][q];
+                mshr_we[mshr_wr_ptr] <= bq_we[miss_bank][q];
+                mshr_gpu[mshr_wr_ptr] <= bq_gpu[miss_bank][q];
+                mshr_line[mshr_wr_ptr] <= bq_line[miss_bank][q];
+                mshr_wmask[mshr_wr_ptr] <= bq_wmask[miss_bank][q];
+                mshr_line_wdata[mshr_wr_ptr] <= bq_line_wdata[miss_bank][q];
+                mshr_tag[mshr_wr_ptr] <= bq_tag[miss_bank][q];
+                mshr_valid[mshr_wr_ptr] <= 1'b1;
+                mshr_wr_ptr <= MSHR_BITS'((mshr_wr_ptr + 1) % NUM_MSHRS);
+            end
+            mshr_count <= mshr_count + (miss_valid ? 1 : 0) - (fill_done ? 1 : 0);
+            
+            case (mem_state)
+                MEM_IDLE: begin
+                    // Claim the victim now: invalidating it keeps hits from
+                    // writing a line that is on its way out
+                    if (mem_start) begin
+                        mem_victim <= start_victim;
+                        cache_valid[fill_bank][fill_set][start_victim] <= 1'b0;
+                        if (cache_valid[fill_bank][fill_set][start_victim] &&
+                            cache_dirty[fill_bank][fill_set][start_victim]) begin
+                            mem_state <= MEM_WRITEBACK;
                         end else begin
-                            // Can directly fetch new line
-                            // Will be handled in next state logic
+                            mem_state <= MEM_FILL;
                         end
                     end
                 end
                 
-                CACHE_WRITEBACK: begin
+                MEM_WRITEBACK: begin
                     if (!mem_req) begin
-                        mem_addr <= {cache_tags[cache_set][victim_way], cache_set, {OFFSET_BITS{1'b0}}};
-                        mem_wdata <= cache_data[cache_set][victim_way];
+                        mem_addr <= line_addr(cache_tags[fill_bank][fill_set][mem_victim],
+                                              fill_set, fill_bank);
+                        mem_wdata <= cache_data[fill_bank][fill_set][mem_victim];
                         mem_we <= 1'b1;
                         mem_req <= 1'b1;
                     end else if (mem_ack) begin
                         mem_req <= 1'b0;
-                        cache_dirty[cache_set][victim_way] <= 1'b0;
+                        cache_dirty[fill_bank][fill_set][mem_victim] <= 1'b0;
+                        mem_state <= MEM_FILL;
                     end
                 end
                 
-                CACHE_FILL: begin
+                MEM_FILL: begin
                     if (!mem_req) begin
-                        mem_addr <= {cache_tag, cache_set, {OFFSET_BITS{1'b0}}};
+                        mem_addr <= {fill_addr[ADDR_WIDTH-1:OFFSET_BITS], {OFFSET_BITS{1'b0}}};
                         mem_we <= 1'b0;
                         mem_req <= 1'b1;
                     end else if (mem_ack) begin
                         // Fill cache line
-                        cache_data[cache_set][victim_way] <= mem_rdata;
-                        cache_tags[cache_set][victim_way] <= cache_tag;
-                        cache_valid[cache_set][victim_way] <= 1'b1;
-                        cache_dirty[cache_set][victim_way] <= 1'b0;
+                        cache_tags[fill_bank][fill_set][mem_victim] <= addr_tag(fill_addr);
+                        cache_valid[fill_bank][fill_set][mem_victim] <= 1'b1;
                         mem_req <= 1'b0;
+                        mem_state <= MEM_IDLE;
                         
                         // Now serve the original request
-                        if (current_we) begin
-                            cache_data[cache_set][victim_way] <= update_cache_line(
-                                mem_rdata, current_wdata, cache_offset
-                            );
-                            cache_dirty[cache_set][victim_way] <= 1'b1;
+                        if (mshr_we[mshr_rd_ptr]) begin
+                            if (mshr_line[mshr_rd_ptr]) begin
+                                cache_data[fill_bank][fill_set][mem_victim] <= merge_cache_line(
+                                    mem_rdata, mshr_line_wdata[mshr_rd_ptr], mshr_wmask[mshr_rd_ptr]
+                                );
+                            end else begin
+                                cache_data[fill_bank][fill_set][mem_victim] <= update_cache_line(
+                                    mem_rdata, mshr_wdata[mshr_rd_ptr], fill_addr[OFFSET_BITS-1:0]
+                                );
+                            end
+                            cache_dirty[fill_bank][fill_set][mem_victim] <= 1'b1;
                         end else begin
-                            if (is_gpu_req) begin
-                                gpu_rdata <= extract_word(mem_rdata, cache_offset);
+                            cache_data[fill_bank][fill_set][mem_victim] <= mem_rdata;
+                            cache_dirty[fill_bank][fill_set][mem_victim] <= 1'b0;
+                            if (mshr_line[mshr_rd_ptr]) begin
+                                gpu_line_rdata <= mem_rdata;
+                            end else if (mshr_gpu[mshr_rd_ptr]) begin
+                                gpu_rdata <= extract_word(mem_rdata, fill_addr[OFFSET_BITS-1:0]);
                             end else begin
-                                cpu_rdata <= extract_word(mem_rdata, cache_offset);
+                                cpu_rdata <= extract_word(mem_rdata, fill_addr[OFFSET_BITS-1:0]);
                             end
                         end
                         
-                        // Update LRU and acknowledge
-                        cache_lru[cache_set] <= update_lru(cache_lru[cache_set], victim_way);
-                        if (is_gpu_req) gpu_ack <= 1'b1;
-                        else cpu_ack <= 1'b1;
+                        // Update LRU, retire the MSHR and acknowledge
+                        cache_lru[fill_bank][fill_set] <= update_lru(cache_lru[fill_bank][fill_set],
+                                                                     mem_victim);
+                        mshr_valid[mshr_rd_ptr] <= 1'b0;
+                        mshr_rd_ptr <= MSHR_BITS'((mshr_rd_ptr + 1) % NUM_MSHRS);
+                        if (mshr_gpu[mshr_rd_ptr]) begin
+                            gpu_ack <= 1'b1;
+                            gpu_rtag <= mshr_tag[mshr_rd_ptr];
+                        end else begin
+                            cpu_ack <= 1'b1;
+                            cpu_pending <= 1'b0;
+                        end
                     end
                 end
+                
+                default: mem_state <= MEM_IDLE;
             endcase
         end
     end
     
-    // Next state logic
-    always_comb begin
-        next_state = current_state;
-        case (current_state)
-            IDLE: begin
-                if (gpu_req) next_state = GPU_ACCESS;
-                else if (cpu_req) next_state = CPU_ACCESS;
-            end
-            GPU_ACCESS, CPU_ACCESS: begin
-                if (cache_hit) begin
-                    next_state = IDLE;
-                end else begin
-                    // Cache miss - determine next action
-                    if (cache_dirty[cache_set][victim_way] && cache_valid[cache_set][victim_way]) begin
-                        next_state = CACHE_WRITEBACK;
-                    end else begin
-                        next_state = CACHE_FILL;
-                    end
-                end
-            end
-            CACHE_WRITEBACK: begin
-                if (mem_ack) next_state = CACHE_FILL;
-            end
-            CACHE_FILL: begin
-                if (mem_ack) next_state = IDLE;
-            end
-        endcase
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            cpu_hits <= 32'h0;
+            cpu_misses <= 32'h0;
+            gpu_hits <= 32'h0;
+            gpu_misses <= 32'h0;
+            bank_conflicts <= 32'h0;
+        end else begin
+            if (gpu_hit_valid) gpu_hits <= gpu_hits + 1;
+            if (cpu_hit_valid) cpu_hits <= cpu_hits + 1;
+            if (miss_valid && head_gpu[miss_bank]) gpu_misses <= gpu_misses + 1;
+            if (miss_valid && !head_gpu[miss_bank]) cpu_misses <= cpu_misses + 1;
+            bank_conflicts <= bank_conflicts +
+                              32'((gq_count != 0) && !gq_pop) +
+                              32'(cpu_take && !cpu_push) +
+                              32'(head_valid[fill_bank] && bank_blocked[fill_bank]);
+        end
     end
     
     // Helper functions
@@ -279,6 +576,20 @@ module unified_memory_controller #(
         return result;
     endfunction
     
+    // Write the enabled words of a whole-line store into a cache line
+    function logic [CACHE_LINE_WIDTH-1:0] merge_cache_line;
+        input logic [CACHE_LINE_WIDTH-1:0] cache_line;
+        input logic [CACHE_LINE_WIDTH-1:0] new_line;
+        input logic [CACHE_LINE_WIDTH/32-1:0] wmask;
+        
+        logic [CACHE_LINE_WIDTH-1:0] result;
+        result = cache_line;
+        for (int w = 0; w < CACHE_LINE_WIDTH/32; w++) begin
+            if (wmask[w]) result[w*32 +: 32] = new_line[w*32 +: 32];
+        end
+        return result;
+    endfunction
+    
     function logic [DATA_WIDTH-1:0] extract_word;
         input logic [CACHE_LINE_WIDTH-1:0] cache_line;
         input logic [OFFSET_BITS-1:0] offset;
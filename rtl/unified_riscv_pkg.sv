@@ -13,13 +13,15 @@ package unified_riscv_pkg;
 
     // Derived parameters
     parameter int NUM_MASTERS = NUM_GPU_UNITS + 1;  // CPU + GPU units
-    parameter int NUM_SLAVES = 4;                   // Memory, GPU ctrl, sys ctrl, debug
+    parameter int NUM_SLAVES = 5;                   // Memory, GPU ctrl, sys ctrl, debug, GPU spad
 
     // Address map constants
     parameter logic [31:0] MAIN_MEMORY_BASE = 32'h00000000;
     parameter logic [31:0] MAIN_MEMORY_SIZE = 32'h10000000; // 256MB
     parameter logic [31:0] GPU_CTRL_BASE    = 32'h10000000;
     parameter logic [31:0] GPU_CTRL_SIZE    = 32'h00010000; // 64KB
+    parameter logic [31:0] GPU_SPAD_BASE    = 32'h10010000;
+    parameter logic [31:0] GPU_SPAD_SIZE    = 32'h00010000; // 64KB scratchpad
     parameter logic [31:0] SYS_CTRL_BASE    = 32'h20000000;
     parameter logic [31:0] SYS_CTRL_SIZE    = 32'h00010000; // 64KB
     parameter logic [31:0] DEBUG_BASE       = 32'h30000000;
@@ -1,13 +1,24 @@
 // Simplified UnifiedRISCV for testing - without full interconnect
-// Just CPU + GPU + simple memory controller
+// Just CPU + GPU + simple memory controller, or the L1/L2/L3 cache_hierarchy
+// when built with USE_CACHE_HIERARCHY=1. With NUM_HARTS > 1 the CPU is a
+// riscv_cluster whose harts take turns on the one CPU port; the tile DMA
+// engine is one more requester on that port.
 
 module unified_riscv_simple #(
     parameter XLEN = 32,
+    parameter NUM_HARTS = 1,
     parameter NUM_GPU_UNITS = 8,
     parameter CACHE_LINE_WIDTH = 512,
     parameter NUM_MEMORY_BANKS = 16,
     parameter ADDR_WIDTH = 32,
-    parameter DATA_WIDTH = 32
+    parameter DATA_WIDTH = 32,
+    parameter GPU_CTRL_BASE = 32'h10000000,
+    parameter GPU_CTRL_SIZE = 32'h00010000, // 64KB
+    parameter GPU_SPAD_BASE = 32'h10010000,
+    parameter GPU_SPAD_SIZE = 32'h00010000, // 64KB
+    parameter SYS_CTRL_BASE = 32'h20000000,
+    parameter SYS_CTRL_SIZE = 32'h00010000, // 64KB
+    parameter USE_CACHE_HIERARCHY = 0       // 0: unified_memory_controller, 1: cache_hierarchy
 ) (
     input  logic clk,
     input  logic rst_n,
@@ -20,6 +31,12 @@ module unified_riscv_simple #(
     output logic mem_we,
     input  logic mem_ack,
     
+    // Host interface: CPU stores to the SYS_CTRL window skip the caches and
+    // are reported here (tohost-style exit, console output); reads return 0
+    output logic host_valid,
+    output logic [ADDR_WIDTH-1:0] host_addr,
+    output logic [DATA_WIDTH-1:0] host_data,
+    
     // Debug interface
     output logic [31:0] debug_pc,
     output logic [31:0] debug_inst,
@@ -33,6 +50,49 @@ module unified_riscv_simple #(
     logic cpu_req, gpu_req;
     logic cpu_we, gpu_we;
     logic cpu_ack, gpu_ack;
+    logic gpu_gnt;
+    logic [7:0] gpu_tag, gpu_rtag;
+    
+    // GPU line-wide (burst) accesses
+    logic gpu_line;
+    logic [CACHE_LINE_WIDTH/32-1:0] gpu_wmask;
+    logic [CACHE_LINE_WIDTH-1:0] gpu_line_wdata, gpu_line_rdata;
+    
+    // GPU scratchpad; CPU accesses in its window skip the memory controller
+    logic spad_req, spad_we, spad_line, spad_ack;
+    logic [31:0] spad_addr, spad_wdata, spad_rdata;
+    logic [CACHE_LINE_WIDTH/32-1:0] spad_wmask;
+    logic [CACHE_LINE_WIDTH-1:0] spad_line_wdata, spad_line_rdata;
+    logic cpu_spad_sel, cpu_ctrl_sel, cpu_host_sel, cpu_mem_sel;
+    logic mc_cpu_ack, spad_cpu_ack, ctrl_cpu_ack, host_cpu_ack;
+    logic [DATA_WIDTH-1:0] mc_cpu_rdata, spad_cpu_rdata, ctrl_cpu_rdata;
+    
+    assign cpu_spad_sel = (cpu_addr >= GPU_SPAD_BASE) &&
+                          (cpu_addr < GPU_SPAD_BASE + GPU_SPAD_SIZE);
+    assign cpu_ctrl_sel = (cpu_addr >= GPU_CTRL_BASE) &&
+                          (cpu_addr < GPU_CTRL_BASE + GPU_CTRL_SIZE);
+    assign cpu_host_sel = (cpu_addr >= SYS_CTRL_BASE) &&
+                          (cpu_addr < SYS_CTRL_BASE + SYS_CTRL_SIZE);
+    assign cpu_mem_sel = !cpu_spad_sel && !cpu_ctrl_sel && !cpu_host_sel;
+    assign cpu_ack = mc_cpu_ack | spad_cpu_ack | ctrl_cpu_ack | host_cpu_ack;
+    assign cpu_rdata = spad_cpu_ack ? spad_cpu_rdata :
+                       ctrl_cpu_ack ? ctrl_cpu_rdata :
+                       host_cpu_ack ? '0 : mc_cpu_rdata;
+    
+    // Host window: every access is acked on the next cycle
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            host_cpu_ack <= 1'b0;
+            host_valid <= 1'b0;
+            host_addr <= '0;
+            host_data <= '0;
+        end else begin
+            host_cpu_ack <= cpu_req && cpu_host_sel && !host_cpu_ack;
+            host_valid <= cpu_req && cpu_host_sel && !host_cpu_ack && cpu_we;
+            host_addr <= cpu_addr;
+            host_data <= cpu_wdata;
+        end
+    end
     
     // GPU compute interface
     logic [NUM_GPU_UNITS-1:0] gpu_unit_busy;
@@ -40,24 +100,115 @@ module unified_riscv_simple #(
     logic [31:0] gpu_matrix_a [NUM_GPU_UNITS-1:0];
     logic [31:0] gpu_matrix_b [NUM_GPU_UNITS-1:0];
     logic [31:0] gpu_matrix_c [NUM_GPU_UNITS-1:0];
+    logic [15:0] gpu_unit_config [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_ring_base [NUM_GPU_UNITS-1:0];
+    logic [7:0] gpu_ring_head [NUM_GPU_UNITS-1:0];
+    logic [7:0] gpu_ring_tail [NUM_GPU_UNITS-1:0];
+    
+    // Cache controls and statistics from/to the GPU control block
+    logic gpu_prefetch_enable;
+    logic [3:0] gpu_prefetch_degree;
+    logic [31:0] cache_partition;
+    logic [31:0] cache_hits [2:0];
+    logic [31:0] cache_misses [2:0];
+    logic [31:0] gpu_cache_hits [2:0];
+    logic [31:0] gpu_cache_misses [2:0];
+    logic [31:0] bank_conflicts;
+    
+    // Performance counters from the GPU array
+    logic [31:0] gpu_cycle_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_operation_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_stall_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_mem_wait_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_mac_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] arb_grants, arb_waits, fabric_stalls;
+    
+    // Per-hart memory ports of the CPU cluster
+    logic [NUM_HARTS-1:0][31:0] hart_addr, hart_wdata, hart_rdata;
+    logic [NUM_HARTS-1:0] hart_req, hart_we, hart_ack, hart_lock;
+    
+    // Tile DMA engine, which shares the CPU port with the harts
+    logic [31:0] dma_addr, dma_wdata;
+    logic dma_req, dma_we;
+    logic dma_queue_valid, dma_busy;
+    logic [31:0] dma_queue_addr, dma_done_count;
+    logic [7:0] dma_queue_free;
+    
+    // One transaction at a time on the CPU port, the harts first and the DMA
+    // engine last. A requester keeps the port while its request or lock is
+    // up, and after each ack the port idles for a cycle before the next one
+    // goes, as it would with a single hart.
+    localparam PORT_MASTERS = NUM_HARTS + 1;
+    
+    logic [PORT_MASTERS-1:0][31:0] port_addr, port_wdata;
+    logic [PORT_MASTERS-1:0] port_req, port_we, port_lock, port_grant;
+    logic [$clog2(PORT_MASTERS)-1:0] port_sel;
+    logic port_granted, cpu_acked;
+    
+    assign port_addr = {dma_addr, hart_addr};
+    assign port_wdata = {dma_wdata, hart_wdata};
+    assign port_req = {dma_req, hart_req};
+    assign port_we = {dma_we, hart_we};
+    assign port_lock = {1'b0, hart_lock};
+    
+    priority_arbiter #(
+        .NUM_REQUESTERS(PORT_MASTERS),
+        .NUM_CPUS(PORT_MASTERS),
+        .GPU_PRIORITY(0)
+    ) port_arbiter (
+        .clk(clk),
+        .rst_n(rst_n),
+        .requests(cpu_acked ? '0 : port_req),
+        .hold(port_req | port_lock),
+        .grants(port_grant),
+        .granted_id(port_sel),
+        .any_grant(port_granted)
+    );
     
-    // RISC-V CPU Core
-    riscv_cpu #(
-        .XLEN(XLEN)
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            cpu_acked <= 1'b0;
+        end else begin
+            cpu_acked <= cpu_ack;
+        end
+    end
+    
+    assign cpu_addr = port_addr[port_sel];
+    assign cpu_wdata = port_wdata[port_sel];
+    assign cpu_req = port_granted && port_req[port_sel];
+    assign cpu_we = port_we[port_sel];
+    
+    genvar h;
+    generate
+        for (h = 0; h < NUM_HARTS; h++) begin : gen_hart_ack
+            assign hart_ack[h] = cpu_ack && port_grant[h];
+            assign hart_rdata[h] = cpu_rdata;
+        end
+    endgenerate
+    
+    // RISC-V CPU harts
+    riscv_cluster #(
+        .XLEN(XLEN),
+        .NUM_HARTS(NUM_HARTS),
+        .NUM_GPU_UNITS(NUM_GPU_UNITS)
     ) cpu_core (
         .clk(clk),
         .rst_n(rst_n),
-        .mem_addr(cpu_addr),
-        .mem_wdata(cpu_wdata),
-        .mem_rdata(cpu_rdata),
-        .mem_req(cpu_req),
-        .mem_we(cpu_we),
-        .mem_ack(cpu_ack),
+        .hart_mem_addr(hart_addr),
+        .hart_mem_wdata(hart_wdata),
+        .hart_mem_rdata(hart_rdata),
+        .hart_mem_req(hart_req),
+        .hart_mem_we(hart_we),
+        .hart_mem_ack(hart_ack),
+        .hart_mem_lock(hart_lock),
         .gpu_unit_busy(gpu_unit_busy),
         .gpu_unit_start(gpu_unit_start),
         .gpu_matrix_a(gpu_matrix_a),
         .gpu_matrix_b(gpu_matrix_b),
         .gpu_matrix_c(gpu_matrix_c),
+        .gpu_ring_base(gpu_ring_base),
+        .gpu_ring_head(gpu_ring_head),
+        .gpu_ring_tail(gpu_ring_tail),
         .debug_pc(debug_pc),
         .debug_inst(debug_inst),
         .debug_valid(debug_valid)
@@ -65,7 +216,10 @@ module unified_riscv_simple #(
     
     // GPU Compute Array
     gpu_compute_array #(
-        .NUM_UNITS(NUM_GPU_UNITS)
+        .NUM_UNITS(NUM_GPU_UNITS),
+        .LINE_WIDTH(CACHE_LINE_WIDTH),
+        .SPAD_BASE(GPU_SPAD_BASE),
+        .SPAD_SIZE(GPU_SPAD_SIZE)
     ) gpu_array (
         .clk(clk),
         .rst_n(rst_n),
@@ -74,46 +228,307 @@ module unified_riscv_simple #(
         .mem_rdata(gpu_rdata),
         .mem_req(gpu_req),
         .mem_we(gpu_we),
+        .mem_tag(gpu_tag),
+        .mem_gnt(gpu_gnt),
         .mem_ack(gpu_ack),
+        .mem_rtag(gpu_rtag),
+        .mem_line(gpu_line),
+        .mem_wmask(gpu_wmask),
+        .mem_line_wdata(gpu_line_wdata),
+        .mem_line_rdata(gpu_line_rdata),
+        .spad_req(spad_req),
+        .spad_we(spad_we),
+        .spad_addr(spad_addr),
+        .spad_wdata(spad_wdata),
+        .spad_rdata(spad_rdata),
+        .spad_line(spad_line),
+        .spad_wmask(spad_wmask),
+        .spad_line_wdata(spad_line_wdata),
+        .spad_line_rdata(spad_line_rdata),
+        .spad_ack(spad_ack),
         .unit_busy(gpu_unit_busy),
         .unit_start(gpu_unit_start),
         .matrix_a(gpu_matrix_a),
         .matrix_b(gpu_matrix_b),
-        .matrix_c(gpu_matrix_c)
+        .unit_config(gpu_unit_config),
+        .matrix_c(gpu_matrix_c),
+        .ring_base(gpu_ring_base),
+        .ring_head(gpu_ring_head),
+        .ring_tail(gpu_ring_tail),
+        .unit_busy_cycles(gpu_cycle_count),
+        .unit_stall_cycles(gpu_stall_count),
+        .unit_mem_wait_cycles(gpu_mem_wait_count),
+        .unit_macs(gpu_mac_count),
+        .unit_ops(gpu_operation_count),
+        .arb_grants(arb_grants),
+        .arb_waits(arb_waits),
+        .fabric_stalls(fabric_stalls)
     );
     
-    // Unified Memory Controller with GPU Priority
-    unified_memory_controller #(
-        .CACHE_LINE_WIDTH(CACHE_LINE_WIDTH),
-        .NUM_BANKS(NUM_MEMORY_BANKS),
-        .ADDR_WIDTH(ADDR_WIDTH)
-    ) memory_controller (
+    // GPU Scratchpad
+    gpu_scratchpad #(
+        .SIZE_BYTES(GPU_SPAD_SIZE),
+        .LINE_WIDTH(CACHE_LINE_WIDTH),
+        .ADDR_WIDTH(ADDR_WIDTH),
+        .DATA_WIDTH(DATA_WIDTH)
+    ) gpu_spad (
         .clk(clk),
         .rst_n(rst_n),
-        
-        // CPU interface
+        .gpu_req(spad_req),
+        .gpu_we(spad_we),
+        .gpu_addr(spad_addr),
+        .gpu_wdata(spad_wdata),
+        .gpu_rdata(spad_rdata),
+        .gpu_line(spad_line),
+        .gpu_wmask(spad_wmask),
+        .gpu_line_wdata(spad_line_wdata),
+        .gpu_line_rdata(spad_line_rdata),
+        .gpu_ack(spad_ack),
+        .cpu_req(cpu_req && cpu_spad_sel),
+        .cpu_we(cpu_we),
         .cpu_addr(cpu_addr),
         .cpu_wdata(cpu_wdata),
-        .cpu_rdata(cpu_rdata),
-        .cpu_req(cpu_req),
-        .cpu_we(cpu_we),
-        .cpu_ack(cpu_ack),
-        
-        // GPU interface
-        .gpu_addr(gpu_addr),
-        .gpu_wdata(gpu_wdata),
-        .gpu_rdata(gpu_rdata),
-        .gpu_req(gpu_req),
-        .gpu_we(gpu_we),
-        .gpu_ack(gpu_ack),
-        
-        // External memory
-        .mem_addr(mem_addr),
-        .mem_wdata(mem_wdata),
-        .mem_rdata(mem_rdata),
-        .mem_req(mem_req),
-        .mem_we(mem_we),
-        .mem_ack(mem_ack)
+        .cpu_rdata(spad_cpu_rdata),
+        .cpu_ack(spad_cpu_ack)
+    );
+    
+    // GPU Control Block: per-unit config plus the cache control/stat registers.
+    // Units are started through the CPU's custom instructions here, so the
+    // block's start/address outputs are left unused.
+    gpu_control_interface #(
+        .NUM_GPU_UNITS(NUM_GPU_UNITS),
+        .ADDR_WIDTH(ADDR_WIDTH),
+        .DATA_WIDTH(DATA_WIDTH)
+    ) gpu_ctrl (
+        .clk(clk),
+        .rst_n(rst_n),
+        .req(cpu_req && cpu_ctrl_sel && !ctrl_cpu_ack),
+        .we(cpu_we),
+        .addr(cpu_addr),
+        .wdata(cpu_wdata),
+        .ack(ctrl_cpu_ack),
+        .rdata(ctrl_cpu_rdata),
+        .gpu_enable(),
+        .gpu_reset(),
+        .gpu_start(),
+        .gpu_busy(gpu_unit_busy),
+        .gpu_done('0),
+        .gpu_error('0),
+        .gpu_matrix_a_addr(),
+        .gpu_matrix_b_addr(),
+        .gpu_matrix_c_addr(),
+        .gpu_operation_config(gpu_unit_config),
+        .gpu_cycle_count(gpu_cycle_count),
+        .gpu_operation_count(gpu_operation_count),
+        .gpu_stall_count(gpu_stall_count),
+        .gpu_mem_wait_count(gpu_mem_wait_count),
+        .gpu_mac_count(gpu_mac_count),
+        .gpu_global_priority(),
+        .gpu_global_enable(),
+        .gpu_debug_enable(),
+        .gpu_prefetch_enable(gpu_prefetch_enable),
+        .gpu_prefetch_degree(gpu_prefetch_degree),
+        .gpu_cache_partition(cache_partition),
+        .cache_hits(cache_hits),
+        .cache_misses(cache_misses),
+        .gpu_cache_hits(gpu_cache_hits),
+        .gpu_cache_misses(gpu_cache_misses),
+        .bank_conflicts(bank_conflicts),
+        .arb_grants(arb_grants),
+        .arb_waits(arb_waits),
+        .fabric_stalls(fabric_stalls),
+        .dma_queue_valid(dma_queue_valid),
+        .dma_queue_addr(dma_queue_addr),
+        .dma_queue_free(dma_queue_free),
+        .dma_busy(dma_busy),
+        .dma_done_count(dma_done_count)
+    );
+    
+    // Tile DMA engine: reaches memory and the scratchpad through the CPU port
+    dma_engine #(
+        .ADDR_WIDTH(ADDR_WIDTH),
+        .DATA_WIDTH(DATA_WIDTH)
+    ) tile_dma (
+        .clk(clk),
+        .rst_n(rst_n),
+        .queue_valid(dma_queue_valid),
+        .queue_addr(dma_queue_addr),
+        .queue_free(dma_queue_free),
+        .busy(dma_busy),
+        .done_count(dma_done_count),
+        .mem_addr(dma_addr),
+        .mem_wdata(dma_wdata),
+        .mem_req(dma_req),
+        .mem_we(dma_we),
+        .mem_rdata(cpu_rdata),
+        .mem_ack(cpu_ack && port_grant[NUM_HARTS])
     );
+    
+    generate
+        if (USE_CACHE_HIERARCHY) begin : gen_cache_hierarchy
+            logic [ADDR_WIDTH-1:0] req_addr;
+            logic [31:0] req_wdata, req_rdata;
+            logic req_valid, req_we, req_ready, req_done, req_is_gpu, req_line;
+            logic [3:0] req_unit;
+            logic [CACHE_LINE_WIDTH/32-1:0] req_wmask;
+            logic [CACHE_LINE_WIDTH-1:0] req_line_wdata, req_line_rdata;
+            
+            cache_port_arbiter #(
+                .ADDR_WIDTH(ADDR_WIDTH),
+                .DATA_WIDTH(DATA_WIDTH),
+                .LINE_WIDTH(CACHE_LINE_WIDTH),
+                .TAG_WIDTH(8)
+            ) port_arbiter (
+                .clk(clk),
+                .rst_n(rst_n),
+                .cpu_req(cpu_req && cpu_mem_sel),
+                .cpu_we(cpu_we),
+                .cpu_addr(cpu_addr),
+                .cpu_wdata(cpu_wdata),
+                .cpu_rdata(mc_cpu_rdata),
+                .cpu_ack(mc_cpu_ack),
+                .gpu_req(gpu_req),
+                .gpu_we(gpu_we),
+                .gpu_addr(gpu_addr),
+                .gpu_wdata(gpu_wdata),
+                .gpu_rdata(gpu_rdata),
+                .gpu_tag(gpu_tag),
+                .gpu_gnt(gpu_gnt),
+                .gpu_ack(gpu_ack),
+                .gpu_rtag(gpu_rtag),
+                .gpu_line(gpu_line),
+                .gpu_wmask(gpu_wmask),
+                .gpu_line_wdata(gpu_line_wdata),
+                .gpu_line_rdata(gpu_line_rdata),
+                .req_addr(req_addr),
+                .req_wdata(req_wdata),
+                .req_rdata(req_rdata),
+                .req_valid(req_valid),
+                .req_we(req_we),
+                .req_ready(req_ready),
+                .req_done(req_done),
+                .req_is_gpu(req_is_gpu),
+                .req_unit(req_unit),
+                .req_line(req_line),
+                .req_wmask(req_wmask),
+                .req_line_wdata(req_line_wdata),
+                .req_line_rdata(req_line_rdata)
+            );
+            
+            // L1/L2/L3 with GPU/CPU way partitioning
+            cache_hierarchy #(
+                .CACHE_LINE_WIDTH(CACHE_LINE_WIDTH),
+                .ADDR_WIDTH(ADDR_WIDTH),
+                .PF_STREAMS(NUM_GPU_UNITS)
+            ) caches (
+                .clk(clk),
+                .rst_n(rst_n),
+                .req_addr(req_addr),
+                .req_wdata(req_wdata),
+                .req_rdata(req_rdata),
+                .req_valid(req_valid),
+                .req_we(req_we),
+                .req_ready(req_ready),
+                .req_done(req_done),
+                .req_is_gpu(req_is_gpu),
+                .req_unit(req_unit),
+                .req_line(req_line),
+                .req_wmask(req_wmask),
+                .req_line_wdata(req_line_wdata),
+                .req_line_rdata(req_line_rdata),
+                .pf_enable(gpu_prefetch_enable),
+                .pf_degree(gpu_prefetch_degree),
+                .l2_gpu_ways(cache_partition[3:0]),
+                .l2_cpu_ways(cache_partition[7:4]),
+                .l3_gpu_ways(cache_partition[12:8]),
+                .l3_cpu_ways(cache_partition[20:16]),
+                .l1_hits(cache_hits[0]),
+                .l1_misses(cache_misses[0]),
+                .l2_hits(cache_hits[1]),
+                .l2_misses(cache_misses[1]),
+                .l3_hits(cache_hits[2]),
+                .l3_misses(cache_misses[2]),
+                .l1_gpu_hits(gpu_cache_hits[0]),
+                .l1_gpu_misses(gpu_cache_misses[0]),
+                .l2_gpu_hits(gpu_cache_hits[1]),
+                .l2_gpu_misses(gpu_cache_misses[1]),
+                .l3_gpu_hits(gpu_cache_hits[2]),
+                .l3_gpu_misses(gpu_cache_misses[2]),
+                .mem_addr(mem_addr),
+                .mem_wdata(mem_wdata),
+                .mem_rdata(mem_rdata),
+                .mem_req(mem_req),
+                .mem_we(mem_we),
+                .mem_ack(mem_ack)
+            );
+            
+            // One blocking port in front of unbanked caches
+            assign bank_conflicts = '0;
+        end else begin : gen_memory_controller
+            logic [31:0] cpu_hits, cpu_misses, gpu_hits, gpu_misses;
+            
+            // The controller's banked cache is the only level
+            always_comb begin
+                for (int i = 0; i < 3; i++) begin
+                    cache_hits[i] = '0;
+                    cache_misses[i] = '0;
+                    gpu_cache_hits[i] = '0;
+                    gpu_cache_misses[i] = '0;
+                end
+                cache_hits[0] = cpu_hits + gpu_hits;
+                cache_misses[0] = cpu_misses + gpu_misses;
+                gpu_cache_hits[0] = gpu_hits;
+                gpu_cache_misses[0] = gpu_misses;
+            end
+            
+            // Unified Memory Controller with GPU Priority
+            unified_memory_controller #(
+                .CACHE_LINE_WIDTH(CACHE_LINE_WIDTH),
+                .NUM_BANKS(NUM_MEMORY_BANKS),
+                .ADDR_WIDTH(ADDR_WIDTH)
+            ) memory_controller (
+                .clk(clk),
+                .rst_n(rst_n),
+                
+                // CPU interface
+                .cpu_addr(cpu_addr),
+                .cpu_wdata(cpu_wdata),
+                .cpu_rdata(mc_cpu_rdata),
+                .cpu_req(cpu_req && cpu_mem_sel),
+                .cpu_we(cpu_we),
+                .cpu_ack(mc_cpu_ack),
+                
+                // GPU interface
+                .gpu_addr(gpu_addr),
+                .gpu_wdata(gpu_wdata),
+                .gpu_rdata(gpu_rdata),
+                .gpu_req(gpu_req),
+                .gpu_we(gpu_we),
+                .gpu_tag(gpu_tag),
+                .gpu_gnt(gpu_gnt),
+                .gpu_ack(gpu_ack),
+                .gpu_rtag(gpu_rtag),
+                .gpu_line(gpu_line),
+                .gpu_wmask(gpu_wmask),
+                .gpu_line_wdata(gpu_line_wdata),
+                .gpu_line_rdata(gpu_line_rdata),
+                
+                // External memory
+                .mem_addr(mem_addr),
+                .mem_wdata(mem_wdata),
+                .mem_rdata(mem_rdata),
+                .mem_req(mem_req),
+                .mem_we(mem_we),
+                .mem_ack(mem_ack),
+                
+                // Statistics
+                .cpu_hits(cpu_hits),
+                .cpu_misses(cpu_misses),
+                .gpu_hits(gpu_hits),
+                .gpu_misses(gpu_misses),
+                .bank_conflicts(bank_conflicts)
+            );
+        end
+    endgenerate
 
 endmodule
@@ -3,13 +3,14 @@
 
 module unified_riscv_system #(
     parameter XLEN = 32,
+    parameter NUM_HARTS = 1,
     parameter NUM_GPU_UNITS = 8,
     parameter CACHE_LINE_WIDTH = 512,
     parameter NUM_MEMORY_BANKS = 16,
     parameter ADDR_WIDTH = 32,
     parameter DATA_WIDTH = 32,
-    parameter NUM_MASTERS = NUM_GPU_UNITS + 1,  // CPU + GPU units
-    parameter NUM_SLAVES = 4,                   // Memory, GPU ctrl, sys ctrl, debug
+    parameter NUM_MASTERS = NUM_GPU_UNITS + NUM_HARTS + 1,  // CPU harts + GPU units + tile DMA
+    parameter NUM_SLAVES = 5,                   // Memory, GPU ctrl, sys ctrl, debug, GPU spad
     parameter ID_WIDTH = 4
 ) (
     input  logic clk,
@@ -52,6 +53,7 @@ module unified_riscv_system #(
 
     // Interconnect master interfaces
     logic [NUM_MASTERS-1:0] master_req;
+    logic [NUM_MASTERS-1:0] master_lock;
     logic [NUM_MASTERS-1:0] master_we;
     logic [NUM_MASTERS-1:0][ADDR_WIDTH-1:0] master_addr;
     logic [NUM_MASTERS-1:0][DATA_WIDTH-1:0] master_wdata;
@@ -79,11 +81,39 @@ module unified_riscv_system #(
     logic [31:0] gpu_matrix_b_addr [NUM_GPU_UNITS-1:0];
     logic [31:0] gpu_matrix_c_addr [NUM_GPU_UNITS-1:0];
     logic [15:0] gpu_operation_config [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_ring_base [NUM_GPU_UNITS-1:0];
+    logic [7:0] gpu_ring_head [NUM_GPU_UNITS-1:0];
+    logic [7:0] gpu_ring_tail [NUM_GPU_UNITS-1:0];
     logic [31:0] gpu_cycle_count [NUM_GPU_UNITS-1:0];
     logic [31:0] gpu_operation_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_stall_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_mem_wait_count [NUM_GPU_UNITS-1:0];
+    logic [31:0] gpu_mac_count [NUM_GPU_UNITS-1:0];
     logic [7:0] gpu_global_priority;
     logic gpu_global_enable;
     logic gpu_debug_enable;
+    logic gpu_prefetch_enable;        // Stride prefetcher controls for cache_hierarchy
+    logic [3:0] gpu_prefetch_degree;
+    logic [31:0] gpu_cache_partition; // Way reservation for cache_hierarchy
+    logic [31:0] cache_hits [2:0];
+    logic [31:0] cache_misses [2:0];
+    logic [31:0] gpu_cache_hits [2:0];
+    logic [31:0] gpu_cache_misses [2:0];
+    logic [31:0] mc_hits, mc_misses, mc_bank_conflicts;
+    
+    // The unified controller is the only cache level. Every master reaches
+    // it through the interconnect's single port, so there is no GPU share
+    // to report and no array arbiter.
+    always_comb begin
+        for (int i = 0; i < 3; i++) begin
+            cache_hits[i] = '0;
+            cache_misses[i] = '0;
+            gpu_cache_hits[i] = '0;
+            gpu_cache_misses[i] = '0;
+        end
+        cache_hits[0] = mc_hits;
+        cache_misses[0] = mc_misses;
+    end
     
     // Individual GPU unit memory interfaces
     logic [NUM_GPU_UNITS-1:0] gpu_unit_req;
@@ -93,52 +123,91 @@ module unified_riscv_system #(
     logic [NUM_GPU_UNITS-1:0] gpu_unit_ack;
     logic [NUM_GPU_UNITS-1:0][DATA_WIDTH-1:0] gpu_unit_rdata;
     
-    // CPU master interface
-    logic cpu_req, cpu_we, cpu_ack;
-    logic [ADDR_WIDTH-1:0] cpu_addr;
-    logic [DATA_WIDTH-1:0] cpu_wdata, cpu_rdata;
+    // CPU hart master interfaces
+    logic [NUM_HARTS-1:0] cpu_req, cpu_we, cpu_ack, cpu_lock;
+    logic [NUM_HARTS-1:0][ADDR_WIDTH-1:0] cpu_addr;
+    logic [NUM_HARTS-1:0][DATA_WIDTH-1:0] cpu_wdata, cpu_rdata;
     
     // Master interface assignments
-    // CPU is master 0
-    assign master_req[0] = cpu_req;
-    assign master_we[0] = cpu_we;
-    assign master_addr[0] = cpu_addr;
-    assign master_wdata[0] = cpu_wdata;
-    assign master_id[0] = 4'h0;
-    assign cpu_ack = master_ack[0];
-    assign cpu_rdata = master_rdata[0];
-    
-    // GPU units are masters 1-8
     genvar m;
     generate
+        // CPU harts are masters 0..NUM_HARTS-1
+        for (m = 0; m < NUM_HARTS; m++) begin : cpu_master_connections
+            assign master_req[m] = cpu_req[m];
+            assign master_lock[m] = cpu_lock[m];
+            assign master_we[m] = cpu_we[m];
+            assign master_addr[m] = cpu_addr[m];
+            assign master_wdata[m] = cpu_wdata[m];
+            assign master_id[m] = ID_WIDTH'(m);
+            assign cpu_ack[m] = master_ack[m];
+            assign cpu_rdata[m] = master_rdata[m];
+        end
+        
+        // GPU units follow the harts
         for (m = 0; m < NUM_GPU_UNITS; m++) begin : gpu_master_connections
-            assign master_req[m+1] = gpu_unit_req[m];
-            assign master_we[m+1] = gpu_unit_we[m];
-            assign master_addr[m+1] = gpu_unit_addr[m];
-            assign master_wdata[m+1] = gpu_unit_wdata[m];
-            assign master_id[m+1] = 4'h1 + m;
-            assign gpu_unit_ack[m] = master_ack[m+1];
-            assign gpu_unit_rdata[m] = master_rdata[m+1];
+            assign master_req[m+NUM_HARTS] = gpu_unit_req[m];
+            assign master_lock[m+NUM_HARTS] = 1'b0;
+            assign master_we[m+NUM_HARTS] = gpu_unit_we[m];
+            assign master_addr[m+NUM_HARTS] = gpu_unit_addr[m];
+            assign master_wdata[m+NUM_HARTS] = gpu_unit_wdata[m];
+            assign master_id[m+NUM_HARTS] = ID_WIDTH'(m + NUM_HARTS);
+            assign gpu_unit_ack[m] = master_ack[m+NUM_HARTS];
+            assign gpu_unit_rdata[m] = master_rdata[m+NUM_HARTS];
         end
     endgenerate
     
-    // RISC-V CPU Core
-    riscv_cpu #(
-        .XLEN(XLEN)
+    // The tile DMA engine is the last master
+    localparam DMA_MASTER = NUM_HARTS + NUM_GPU_UNITS;
+    
+    logic dma_queue_valid, dma_busy;
+    logic [31:0] dma_queue_addr, dma_done_count;
+    logic [7:0] dma_queue_free;
+    
+    assign master_lock[DMA_MASTER] = 1'b0;
+    assign master_id[DMA_MASTER] = ID_WIDTH'(DMA_MASTER);
+    
+    dma_engine #(
+        .ADDR_WIDTH(ADDR_WIDTH),
+        .DATA_WIDTH(DATA_WIDTH)
+    ) tile_dma (
+        .clk(clk),
+        .rst_n(rst_n),
+        .queue_valid(dma_queue_valid),
+        .queue_addr(dma_queue_addr),
+        .queue_free(dma_queue_free),
+        .busy(dma_busy),
+        .done_count(dma_done_count),
+        .mem_addr(master_addr[DMA_MASTER]),
+        .mem_wdata(master_wdata[DMA_MASTER]),
+        .mem_req(master_req[DMA_MASTER]),
+        .mem_we(master_we[DMA_MASTER]),
+        .mem_rdata(master_rdata[DMA_MASTER]),
+        .mem_ack(master_ack[DMA_MASTER])
+    );
+    
+    // RISC-V CPU harts
+    riscv_cluster #(
+        .XLEN(XLEN),
+        .NUM_HARTS(NUM_HARTS),
+        .NUM_GPU_UNITS(NUM_GPU_UNITS)
     ) cpu_core (
         .clk(clk),
         .rst_n(rst_n),
-        .mem_addr(cpu_addr),
-        .mem_wdata(cpu_wdata),
-        .mem_rdata(cpu_rdata),
-        .mem_req(cpu_req),
-        .mem_we(cpu_we),
-        .mem_ack(cpu_ack),
+        .hart_mem_addr(cpu_addr),
+        .hart_mem_wdata(cpu_wdata),
+        .hart_mem_rdata(cpu_rdata),
+        .hart_mem_req(cpu_req),
+        .hart_mem_we(cpu_we),
+        .hart_mem_ack(cpu_ack),
+        .hart_mem_lock(cpu_lock),
         .gpu_unit_busy(gpu_unit_busy),
         .gpu_unit_start(gpu_unit_start),
         .gpu_matrix_a(gpu_matrix_a_addr),
         .gpu_matrix_b(gpu_matrix_b_addr),
         .gpu_matrix_c(gpu_matrix_c_addr),
+        .gpu_ring_base(gpu_ring_base),
+        .gpu_ring_head(gpu_ring_head),
+        .gpu_ring_tail(gpu_ring_tail),
         .debug_pc(debug_pc),
         .debug_inst(debug_inst),
         .debug_valid(debug_valid)
@@ -148,7 +217,11 @@ module unified_riscv_system #(
     genvar g;
     generate
         for (g = 0; g < NUM_GPU_UNITS; g++) begin : gpu_units
-            gpu_compute_unit gpu_unit (
+            // Units sit on the 32-bit interconnect, so no line bursts here
+            gpu_compute_unit #(
+                .LINE_WIDTH(CACHE_LINE_WIDTH),
+                .BURST_EN(0)
+            ) gpu_unit (
                 .clk(clk),
                 .rst_n(rst_n & ~gpu_reset[g]),
                 .start(gpu_unit_start[g] & gpu_enable[g]),
@@ -157,12 +230,25 @@ module unified_riscv_system #(
                 .matrix_a_addr(gpu_matrix_a_addr[g]),
                 .matrix_b_addr(gpu_matrix_b_addr[g]),
                 .matrix_c_addr(gpu_matrix_c_addr[g]),
+                .operation_config(gpu_operation_config[g]),
+                .ring_base(gpu_ring_base[g]),
+                .ring_head(gpu_ring_head[g]),
+                .ring_tail(gpu_ring_tail[g]),
                 .mem_addr(gpu_unit_addr[g]),
                 .mem_wdata(gpu_unit_wdata[g]),
                 .mem_rdata(gpu_unit_rdata[g]),
                 .mem_req(gpu_unit_req[g]),
                 .mem_we(gpu_unit_we[g]),
-                .mem_ack(gpu_unit_ack[g])
+                .mem_ack(gpu_unit_ack[g]),
+                .mem_line(),
+                .mem_wmask(),
+                .mem_line_wdata(),
+                .mem_line_rdata('0),
+                .perf_busy_cycles(gpu_cycle_count[g]),
+                .perf_stall_cycles(gpu_stall_count[g]),
+                .perf_mem_wait_cycles(gpu_mem_wait_count[g]),
+                .perf_macs(gpu_mac_count[g]),
+                .perf_ops(gpu_operation_count[g])
             );
         end
     endgenerate
@@ -170,6 +256,7 @@ module unified_riscv_system #(
     // System Interconnect
     system_interconnect #(
         .NUM_MASTERS(NUM_MASTERS),
+        .NUM_CPUS(NUM_HARTS),
         .NUM_SLAVES(NUM_SLAVES),
         .ADDR_WIDTH(ADDR_WIDTH),
         .DATA_WIDTH(DATA_WIDTH),
@@ -178,6 +265,7 @@ module unified_riscv_system #(
         .clk(clk),
         .rst_n(rst_n),
         .master_req(master_req),
+        .master_lock(master_lock),
         .master_we(master_we),
         .master_addr(master_addr),
         .master_wdata(master_wdata),
@@ -212,13 +300,25 @@ module unified_riscv_system #(
         .gpu_rdata(),
         .gpu_req(1'b0),
         .gpu_we(1'b0),
+        .gpu_tag('0),
+        .gpu_gnt(),
         .gpu_ack(),
+        .gpu_rtag(),
+        .gpu_line(1'b0),
+        .gpu_wmask('0),
+        .gpu_line_wdata('0),
+        .gpu_line_rdata(),
         .mem_addr(mem_addr),
         .mem_wdata(mem_wdata),
         .mem_rdata(mem_rdata),
         .mem_req(mem_req),
         .mem_we(mem_we),
-        .mem_ack(mem_ack)
+        .mem_ack(mem_ack),
+        .cpu_hits(mc_hits),
+        .cpu_misses(mc_misses),
+        .gpu_hits(),
+        .gpu_misses(),
+        .bank_conflicts(mc_bank_conflicts)
     );
     
     // GPU Control Interface (Slave 1)
@@ -247,9 +347,28 @@ module unified_riscv_system #(
         .gpu_operation_config(gpu_operation_config),
         .gpu_cycle_count(gpu_cycle_count),
         .gpu_operation_count(gpu_operation_count),
+        .gpu_stall_count(gpu_stall_count),
+        .gpu_mem_wait_count(gpu_mem_wait_count),
+        .gpu_mac_count(gpu_mac_count),
         .gpu_global_priority(gpu_global_priority),
         .gpu_global_enable(gpu_global_enable),
-        .gpu_debug_enable(gpu_debug_enable)
+        .gpu_debug_enable(gpu_debug_enable),
+        .gpu_prefetch_enable(gpu_prefetch_enable),
+        .gpu_prefetch_degree(gpu_prefetch_degree),
+        .gpu_cache_partition(gpu_cache_partition),
+        .cache_hits(cache_hits),
+        .cache_misses(cache_misses),
+        .gpu_cache_hits(gpu_cache_hits),
+        .gpu_cache_misses(gpu_cache_misses),
+        .bank_conflicts(mc_bank_conflicts),
+        .arb_grants('0),
+        .arb_waits('0),
+        .fabric_stalls('0),
+        .dma_queue_valid(dma_queue_valid),
+        .dma_queue_addr(dma_queue_addr),
+        .dma_queue_free(dma_queue_free),
+        .dma_busy(dma_busy),
+        .dma_done_count(dma_done_count)
     );
     
     // System Control Registers (Slave 2) - Simple placeholder
@@ -274,6 +393,34 @@ module unified_riscv_system #(
         end
     end
     
+    // GPU Scratchpad (Slave 4). Units reach it through the interconnect here,
+    // so only the 32-bit port is used.
+    gpu_scratchpad #(
+        .SIZE_BYTES(32'h00010000),
+        .LINE_WIDTH(CACHE_LINE_WIDTH),
+        .ADDR_WIDTH(ADDR_WIDTH),
+        .DATA_WIDTH(DATA_WIDTH)
+    ) gpu_spad (
+        .clk(clk),
+        .rst_n(rst_n),
+        .gpu_req(1'b0),
+        .gpu_we(1'b0),
+        .gpu_addr(32'h0),
+        .gpu_wdata(32'h0),
+        .gpu_rdata(),
+        .gpu_line(1'b0),
+        .gpu_wmask('0),
+        .gpu_line_wdata('0),
+        .gpu_line_rdata(),
+        .gpu_ack(),
+        .cpu_req(slave_req[4]),
+        .cpu_we(slave_we[4]),
+        .cpu_addr(slave_addr[4]),
+        .cpu_wdata(slave_wdata[4]),
+        .cpu_rdata(slave_rdata[4]),
+        .cpu_ack(slave_ack[4])
+    );
+    
     // AXI4-Lite Bridge (optional external interface)
     axi_bridge #(
         .ADDR_WIDTH(ADDR_WIDTH),
@@ -0,0 +1,227 @@
+#!/usr/bin/env python3
+"""
+UnifiedRISCV parallel regression
+Runs every built-in testbench test (+test=<name>) and every bench.c kernel
+case (+program=) as its own simulator process, for each GPU unit count and
+memory configuration, spread over the host cores. Every job has its own DUT,
+memory, log and (with --trace) VCD; results are aggregated into a summary
+and build_regress/regress_results.json.
+"""
+
+import argparse
+import concurrent.futures
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+from pathlib import Path
+from typing import Dict, List, Optional
+
+REPO_ROOT = Path(__file__).resolve().parents[1]
+sys.path.insert(0, str(REPO_ROOT / "software" / "benchmarks"))
+from kernel_harness import DEFAULT_CASES, KernelHarness, case_name, parse_case  # noqa: E402
+
+REGRESS_DIR = REPO_ROOT / "build_regress"
+SIM_BINARY = "Vunified_riscv_simple"
+RESULT_LINE = re.compile(r"^RESULT (\S+) (PASS|FAIL) (\d+) cycles")
+
+# bench.c image the built-in gpu_matrix_multiply test runs (+gemm_image=)
+GEMM_TEST = "gpu_matrix_multiply"
+GEMM_CASE = {"kernel": "matmul", "m": 32, "n": 32, "k": 32}
+
+
+class ModelConfig:
+    """One Verilator build: memory system x GPU unit count"""
+    
+    def __init__(self, mem: str, units: int, trace: bool):
+        self.mem = mem
+        self.units = units
+        self.trace = trace
+        self.name = f"{mem}_u{units}"
+        self.build_dir = REGRESS_DIR / self.name
+        self.sim = self.build_dir / "obj_dir" / SIM_BINARY
+    
+    def build(self) -> bool:
+        """Verilate through the top-level Makefile. Regression models are
+        single-threaded: the parallelism is across jobs, not inside them."""
+        self.build_dir.mkdir(parents=True, exist_ok=True)
+        if self.trace:
+            target = ["verilate", f"BUILD_DIR={self.build_dir}"]
+        else:
+            target = ["verilate-fast", f"FAST_BUILD_DIR={self.build_dir}", "SIM_THREADS=1"]
+        cmd = ["make", "-C", str(REPO_ROOT)] + target + [
+            f"MEM_CONFIG={self.mem}", f"GPU_UNITS={self.units}"]
+        with open(self.build_dir / "build.log", "w") as log:
+            return subprocess.run(cmd, stdout=log, stderr=subprocess.STDOUT).returncode == 0
+    
+    def tests(self) -> List[str]:
+        proc = subprocess.run([str(self.sim), "+list_tests"], capture_output=True, text=True,
+                              check=True)
+        return proc.stdout.split()
+
+
+def run_test(config: ModelConfig, test: str, timeout: Optional[float],
+             image: Optional[Path] = None) -> Dict:
+    """One built-in test in a fresh simulator process"""
+    result = {"config": config.name, "name": test, "kind": "test"}
+    log = config.build_dir / f"{test}.log"
+    cmd = [str(config.sim), f"+test={test}"]
+    if image:
+        cmd.append(f"+gemm_image={image}")
+    if config.trace:
+        cmd += ["+trace", f"+trace_file={config.build_dir / (test + '.vcd')}"]
+    
+    start = time.perf_counter()
+    try:
+        proc = subprocess.run(cmd, cwd=config.build_dir, capture_output=True, text=True,
+                              timeout=timeout)
+    except subprocess.TimeoutExpired:
+        result.update(status="TIMEOUT", seconds=timeout, log=str(log))
+        return result
+    result["seconds"] = round(time.perf_counter() - start, 3)
+    log.write_text(proc.stdout + proc.stderr)
+    result["log"] = str(log)
+    
+    status = "FAIL"
+    for line in proc.stdout.splitlines():
+        match = RESULT_LINE.match(line)
+        if match and match.group(1) == test:
+            status = match.group(2)
+            result["cycles"] = int(match.group(3))
+    if proc.returncode != 0:
+        status = "FAIL"
+    result["status"] = status
+    return result
+
+
+def run_kernel(config: ModelConfig, harness: KernelHarness, case: Dict, image: Path) -> Dict:
+    """One bench.c image in a fresh simulator process"""
+    log = config.build_dir / f"{case_name(case)}.log"
+    run = harness.simulate(case, image, log)
+    result = {"config": config.name, "name": case_name(case), "kind": "kernel",
+              "status": "PASS" if run.get("status") == "ok" else "FAIL",
+              "detail": run.get("status"), "seconds": run.get("sim_seconds"),
+              "cycles": run.get("cycles"), "log": str(log)}
+    if "efficiency" in run:
+        result["efficiency"] = run["efficiency"]
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run UnifiedRISCV regressions in parallel")
+    parser.add_argument("--units", type=int, nargs="+", default=[8], choices=[1, 2, 4, 8, 16],
+                        help="GPU unit counts to build (default: 8)")
+    parser.add_argument("--mem", nargs="+", default=["unified", "hierarchy"],
+                        choices=["unified", "hierarchy"], help="Memory configurations")
+    parser.add_argument("--tests", default="all",
+                        help="Comma-separated built-in tests, 'all' or 'none'")
+    parser.add_argument("--case", action="append", type=parse_case, default=[],
+                        help="bench.c case, e.g. matmul:m=64,n=64,k=64 (default: the "
+                             "kernel_harness.py sweep)")
+    parser.add_argument("--no-kernels", action="store_true", help="Skip the bench.c cases")
+    parser.add_argument("--filter", help="Only run jobs whose config/name matches this regex")
+    parser.add_argument("-j", "--jobs", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--timeout", type=float, help="Wall-clock limit per job, in seconds")
+    parser.add_argument("--trace", action="store_true",
+                        help="Use traced models and dump every test to its own VCD")
+    parser.add_argument("--list", action="store_true", help="List the jobs and exit")
+    args = parser.parse_args()
+    
+    configs = [ModelConfig(mem, units, args.trace) for units in args.units for mem in args.mem]
+    cases = [] if args.no_kernels else (args.case or list(DEFAULT_CASES))
+    selector = re.compile(args.filter) if args.filter else None
+    
+    # Models first; their builds parallelize internally
+    for config in configs:
+        print(f"Building {config.name}...", flush=True)
+        if not config.build():
+            sys.exit(f"Build of {config.name} failed, see {config.build_dir / 'build.log'}")
+    
+    jobs = []
+    for config in configs:
+        tests = []
+        if args.tests == "all":
+            tests = config.tests()
+        elif args.tests != "none":
+            tests = args.tests.split(",")
+        for test in tests:
+            jobs.append((config, test, None))
+        for case in cases:
+            jobs.append((config, case_name(case), case))
+    if selector:
+        jobs = [job for job in jobs if selector.search(f"{job[0].name}/{job[1]}")]
+    
+    if args.list:
+        for config, name, _ in jobs:
+            print(f"{config.name}/{name}")
+        return
+    
+    # Kernel images depend only on the unit count and share object files per
+    # count, so they are built serially up front; the GEMM test runs its own
+    # bench.c image. A failed build fails only its jobs.
+    images = {}
+    for config, name, case in jobs:
+        if case is None and name == GEMM_TEST:
+            name, case = case_name(GEMM_CASE), GEMM_CASE
+        if case is None or (config.units, name) in images:
+            continue
+        builder = KernelHarness(work_dir=REGRESS_DIR / f"images_u{config.units}",
+                                gpu_units=config.units)
+        print(f"Building {name} for {config.units} units...", flush=True)
+        try:
+            images[(config.units, name)] = builder.build(case)
+        except subprocess.CalledProcessError:
+            images[(config.units, name)] = None
+    
+    print(f"Running {len(jobs)} jobs, {args.jobs} at a time", flush=True)
+    results = []
+    wall_start = time.perf_counter()
+    with concurrent.futures.ThreadPoolExecutor(max_workers=args.jobs) as pool:
+        futures = []
+        for config, name, case in jobs:
+            if case is None:
+                image = images.get((config.units, case_name(GEMM_CASE))) if name == GEMM_TEST else None
+                futures.append(pool.submit(run_test, config, name, args.timeout, image))
+                continue
+            image = images[(config.units, name)]
+            if image is None:
+                results.append({"config": config.name, "name": name, "kind": "kernel",
+                                "status": "FAIL", "detail": "build_failed"})
+                continue
+            harness = KernelHarness(config.sim, REGRESS_DIR / f"images_u{config.units}",
+                                    gpu_units=config.units)
+            futures.append(pool.submit(run_kernel, config, harness, case, image))
+        for done, future in enumerate(concurrent.futures.as_completed(futures), 1):
+            result = future.result()
+            results.append(result)
+            cycles = f"{result['cycles']} cycles" if result.get("cycles") is not None else ""
+            label = f"{result['config']}/{result['name']}"
+            print(f"[{done:3d}/{len(jobs)}] {result['status']:7s} {label:44s} {cycles:>16s} "
+                  f"{result.get('seconds') or 0:8.2f}s", flush=True)
+    
+    wall = time.perf_counter() - wall_start
+    job_seconds = sum(result.get("seconds") or 0 for result in results)
+    failed = sorted((r for r in results if r["status"] != "PASS"),
+                    key=lambda r: (r["config"], r["name"]))
+    results.sort(key=lambda r: (r["config"], r["kind"], r["name"]))
+    
+    REGRESS_DIR.mkdir(exist_ok=True)
+    with open(REGRESS_DIR / "regress_results.json", "w") as f:
+        json.dump({"generated": time.strftime("%Y-%m-%d %H:%M:%S"),
+                   "wall_seconds": round(wall, 1), "job_seconds": round(job_seconds, 1),
+                   "results": results}, f, indent=2)
+    
+    print("\n=== Regression Summary ===")
+    print(f"Passed: {len(results) - len(failed)}/{len(results)}")
+    print(f"Wall time: {wall:.1f}s for {job_seconds:.1f}s of simulation "
+          f"({job_seconds / wall if wall else 0:.1f}x)")
+    for result in failed:
+        print(f"  {result['status']} {result['config']}/{result['name']}: {result.get('log')}")
+    if failed:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
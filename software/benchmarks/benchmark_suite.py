@@ -14,9 +14,12 @@ import torch
 import subprocess
 import json
 import os
+import argparse
 from pathlib import Path
 from typing import Dict, List, Tuple, Optional
 
+from kernel_harness import KernelHarness, DEFAULT_CASES, DEFAULT_SIM, load_results, write_results
+
 # Try to import Apple-specific optimizations
 try:
     import tensorflow as tf
@@ -44,6 +47,9 @@ class UnifiedRISCVBenchmark:
         # Results storage
         self.results = {}
         
+        # Simulated kernel runs (kernel_harness.py); empty means analytic only
+        self.measured = []
+        
         print(f"UnifiedRISCV Benchmark Suite")
         print(f"Base configuration: {self.num_gpu_units} units @ {self.base_frequency/1e6:.0f} MHz")
         print(f"Target: M1 Neural Engine ({self.m1_neural_engine_tops} TOPS)")
@@ -77,6 +83,50 @@ class UnifiedRISCVBenchmark:
         
         return tops * precision_factors.get(precision, 1.0)
     
+    def theoretical_macs_per_cycle(self) -> float:
+        """MACs per cycle behind theoretical_performance at INT8"""
+        tops = self.theoretical_performance(self.base_frequency, self.num_gpu_units)
+        return tops * 1e12 / self.base_frequency
+    
+    def benchmark_simulation(self, sim: Path = DEFAULT_SIM,
+                             cases: Optional[List[Dict]] = None) -> List[Dict]:
+        """Build and run the kernels in the Verilator model"""
+        print("\n=== Simulated Kernel Benchmark ===")
+        
+        harness = KernelHarness(sim, self.results_dir,
+                                macs_per_cycle=self.theoretical_macs_per_cycle())
+        runs = harness.run_all(cases or DEFAULT_CASES)
+        write_results(runs, self.results_dir / "measured_results.json",
+                      self.results_dir / "measured_results.csv",
+                      self.theoretical_macs_per_cycle())
+        self._set_measured(runs)
+        return runs
+    
+    def load_measured(self, path: Path) -> List[Dict]:
+        """Use the runs from an earlier kernel_harness.py invocation"""
+        runs = load_results(path)
+        print(f"Loaded {len(runs)} measured kernel runs from {path}")
+        self._set_measured(runs)
+        return runs
+    
+    def _set_measured(self, runs: List[Dict]):
+        self.measured = [run for run in runs if run.get("status") == "ok"]
+        self.results["measured"] = runs
+    
+    def _measured_run(self, kernel: str, **sizes) -> Optional[Dict]:
+        """Measured run of kernel with exactly these sizes, if any"""
+        for run in self.measured:
+            if run["kernel"] == kernel and all(run.get(k) == v for k, v in sizes.items()):
+                return run
+        return None
+    
+    def _measured_macs_per_cycle(self, kernels: Tuple[str, ...]) -> Optional[float]:
+        """Throughput of the largest measured run of any of these kernels"""
+        runs = [run for run in self.measured if run["kernel"] in kernels]
+        if not runs:
+            return None
+        return max(runs, key=lambda run: run["macs"])["macs_per_cycle"]
+    
     def benchmark_matrix_multiply(self) -> Dict:
         """Benchmark matrix multiplication on CPU using numpy"""
         print("\n=== Matrix Multiplication Benchmark ===")
@@ -86,6 +136,7 @@ class UnifiedRISCVBenchmark:
             "sizes": sizes,
             "cpu_times": [],
             "gpu_theoretical_times": [],
+            "gpu_measured_times": [],  # None where the size was not simulated
             "operations": []
         }
         
@@ -106,12 +157,19 @@ class UnifiedRISCVBenchmark:
             gpu_ops_per_second = self.base_frequency / 20 * self.num_gpu_units * 64
             gpu_theoretical_time = total_ops / gpu_ops_per_second
             
+            measured = self._measured_run("matmul", m=size, n=size, k=size)
+            gpu_measured_time = measured["cycles"] / self.base_frequency if measured else None
+            
             results["cpu_times"].append(cpu_time)
             results["gpu_theoretical_times"].append(gpu_theoretical_time)
+            results["gpu_measured_times"].append(gpu_measured_time)
             results["operations"].append(total_ops)
             
             print(f"  CPU time: {cpu_time*1000:.3f} ms")
             print(f"  Theoretical GPU time: {gpu_theoretical_time*1000:.3f} ms")
+            if measured:
+                print(f"  Measured GPU time: {gpu_measured_time*1000:.3f} ms "
+                      f"({measured['efficiency']*100:.1f}% of theoretical)")
             print(f"  Speedup: {cpu_time/gpu_theoretical_time:.1f}x")
         
         self.results["matrix_multiply"] = results
@@ -133,6 +191,7 @@ class UnifiedRISCVBenchmark:
             "configs": [],
             "cpu_times": [],
             "gpu_theoretical_times": [],
+            "gpu_measured_times": [],
             "operations": []
         }
         
@@ -171,13 +230,22 @@ class UnifiedRISCVBenchmark:
             gpu_ops_per_second = self.base_frequency / 20 * self.num_gpu_units * 64 * gemm_efficiency
             gpu_theoretical_time = total_ops / gpu_ops_per_second
             
+            # Only square kernels are simulated
+            measured = self._measured_run("conv2d", h=h, w=w, c=c, f=f, ksize=kh) \
+                if kh == kw else None
+            gpu_measured_time = measured["cycles"] / self.base_frequency if measured else None
+            
             results["configs"].append(config_str)
             results["cpu_times"].append(cpu_time)
             results["gpu_theoretical_times"].append(gpu_theoretical_time)
+            results["gpu_measured_times"].append(gpu_measured_time)
             results["operations"].append(total_ops)
             
             print(f"  CPU time: {cpu_time*1000:.1f} ms")
             print(f"  Theoretical GPU time: {gpu_theoretical_time*1000:.1f} ms")
+            if measured:
+                print(f"  Measured GPU time: {gpu_measured_time*1000:.1f} ms "
+                      f"({measured['efficiency']*100:.1f}% of theoretical)")
             print(f"  Speedup: {cpu_time/gpu_theoretical_time:.1f}x")
             print(f"  Total MAC ops: {total_ops:,}")
         
@@ -214,11 +282,24 @@ class UnifiedRISCVBenchmark:
         
         results = {}
         
+        # Whole networks do not fit the simulated image; layers are scaled
+        # by the throughput measured on the largest run of the same kind.
+        # Depthwise and 1x1 layers without runs of their own use the conv2d rate.
+        conv_rate = self._measured_macs_per_cycle(("conv2d",))
+        measured_rates = {
+            "conv2d": conv_rate,
+            "pointwise": self._measured_macs_per_cycle(("conv1x1",)) or conv_rate,
+            "depthwise": self._measured_macs_per_cycle(("dwconv",)) or conv_rate,
+            "matmul": self._measured_macs_per_cycle(("matmul",)),
+        }
+        
         for network_name, network in networks.items():
             print(f"\nTesting {network_name}:")
             total_ops = 0
             total_cpu_time = 0
             total_gpu_time = 0
+            total_measured_time = 0
+            measured_layers = 0
             
             for op in network["operations"]:
                 if op["type"] == "conv2d":
@@ -248,19 +329,34 @@ class UnifiedRISCVBenchmark:
                 
                 total_cpu_time += cpu_time_estimate
                 total_gpu_time += gpu_time_estimate
+                
+                kind = op["type"]
+                if kind == "conv2d" and op["kernel"] == (1, 1) and op.get("stride", 1) == 1:
+                    kind = "pointwise"
+                rate = measured_rates[kind]
+                if rate:
+                    total_measured_time += ops / rate / self.base_frequency
+                    measured_layers += 1
             
             efficiency = total_cpu_time / total_gpu_time if total_gpu_time > 0 else 0
             
+            # Only reported when every layer has a measured rate
+            gpu_measured_time = (total_measured_time
+                                 if measured_layers == len(network["operations"]) else None)
+            
             results[network_name] = {
                 "total_ops": total_ops,
                 "cpu_time": total_cpu_time,
                 "gpu_time": total_gpu_time,
+                "gpu_measured_time": gpu_measured_time,
                 "speedup": efficiency
             }
             
             print(f"  Total operations: {total_ops:,}")
             print(f"  CPU time estimate: {total_cpu_time*1000:.1f} ms")
             print(f"  GPU time estimate: {total_gpu_time*1000:.1f} ms")
+            if gpu_measured_time is not None:
+                print(f"  GPU time from measured rates: {gpu_measured_time*1000:.1f} ms")
             print(f"  Speedup: {efficiency:.1f}x")
         
         self.results["neural_networks"] = results
@@ -435,6 +531,10 @@ class UnifiedRISCVBenchmark:
             
             ax1.loglog(sizes, cpu_times, 'o-', label='CPU (NumPy)', linewidth=2)
             ax1.loglog(sizes, gpu_times, 's-', label='GPU (Theoretical)', linewidth=2)
+            measured = [(size, t * 1000) for size, t in
+                        zip(sizes, data.get("gpu_measured_times", [])) if t is not None]
+            if measured:
+                ax1.loglog(*zip(*measured), '^-', label='GPU (Simulated)', linewidth=2)
             ax1.set_xlabel('Matrix Size')
             ax1.set_ylabel('Time (ms)')
             ax1.set_title('Matrix Multiplication Performance')
@@ -452,6 +552,26 @@ class UnifiedRISCVBenchmark:
             plt.savefig(self.results_dir / "matrix_performance.png", dpi=300, bbox_inches='tight')
             plt.close()
         
+        # Measured vs. theoretical efficiency per simulated kernel and size
+        if self.measured:
+            fig, ax = plt.subplots(figsize=(12, 5))
+            
+            names = [run["name"] for run in self.measured]
+            efficiency = [run["efficiency"] * 100 for run in self.measured]
+            
+            ax.bar(range(len(names)), efficiency, color='steelblue')
+            ax.axhline(y=100, color='red', linestyle='--', linewidth=1, label='Theoretical')
+            ax.set_xticks(range(len(names)))
+            ax.set_xticklabels(names, rotation=45, ha='right', fontsize=8)
+            ax.set_ylabel('Efficiency (% of theoretical)')
+            ax.set_title('Simulated Kernel Efficiency')
+            ax.legend()
+            ax.grid(True, axis='y', alpha=0.3)
+            
+            plt.tight_layout()
+            plt.savefig(self.results_dir / "measured_efficiency.png", dpi=300, bbox_inches='tight')
+            plt.close()
+        
         # Scaling analysis
         if "scaling" in self.results:
             fig, ax = plt.subplots(figsize=(10, 6))
@@ -544,8 +664,27 @@ class UnifiedRISCVBenchmark:
                 f.write(f"- Unit count gap: {comp['units_ratio']:.1f}x\n")
                 f.write(f"- Efficiency gap: {comp['efficiency_ratio']:.1f}x\n\n")
             
+            # Simulated kernels, including failed runs so regressions show up
+            if "measured" in self.results:
+                f.write("## Simulated Kernels\n\n")
+                f.write("| Kernel | Status | Cycles | Theoretical | Efficiency | MACs/cycle "
+                        "| GPU stall | Mem wait |\n")
+                f.write("|---|---|---|---|---|---|---|---|\n")
+                for run in self.results["measured"]:
+                    if "cycles" not in run:
+                        f.write(f"| {run['name']} | {run['status']} | | | | | | |\n")
+                        continue
+                    busy = run["busy"] or 1
+                    f.write(f"| {run['name']} | {run['status']} | {run['cycles']:,} "
+                            f"| {run['theoretical_cycles']:,.0f} | {run['efficiency']*100:.1f}% "
+                            f"| {run['macs_per_cycle']:.2f} | {run['stall']*100/busy:.0f}% "
+                            f"| {run['mem_wait']*100/busy:.0f}% |\n")
+                f.write("\n")
+            
             f.write("## Visualizations\n\n")
             f.write("![Matrix Performance](matrix_performance.png)\n\n")
+            if self.measured:
+                f.write("![Measured Efficiency](measured_efficiency.png)\n\n")
             f.write("![Scaling Options](scaling_options.png)\n\n")
             f.write("![Performance Scaling](performance_scaling.png)\n\n")
     
@@ -570,7 +709,20 @@ class UnifiedRISCVBenchmark:
 
 def main():
     """Main benchmark entry point"""
+    parser = argparse.ArgumentParser(description="UnifiedRISCV benchmark suite")
+    parser.add_argument("--simulate", action="store_true",
+                        help="Run the kernels in the Verilator model first")
+    parser.add_argument("--sim", type=Path, default=DEFAULT_SIM,
+                        help="Verilator model for --simulate")
+    parser.add_argument("--measured", type=Path,
+                        help="Use an existing measured_results.json instead")
+    args = parser.parse_args()
+    
     benchmark = UnifiedRISCVBenchmark()
+    if args.simulate:
+        benchmark.benchmark_simulation(args.sim)
+    elif args.measured:
+        benchmark.load_measured(args.measured)
     benchmark.run_full_benchmark()
 
 if __name__ == "__main__":
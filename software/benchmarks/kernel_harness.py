@@ -0,0 +1,248 @@
+#!/usr/bin/env python3
+"""
+UnifiedRISCV kernel benchmark harness
+Builds single-kernel images (software/kernels/bench.c) at each configured
+size, runs them in the Verilator model and records measured cycles and
+hardware counters next to the analytic estimate, as JSON and CSV.
+Standard library only, so regression runs do not need the plotting stack.
+"""
+
+import argparse
+import csv
+import json
+import subprocess
+import sys
+import time
+from pathlib import Path
+from typing import Dict, List, Optional
+
+REPO_ROOT = Path(__file__).resolve().parents[2]
+KERNELS_DIR = REPO_ROOT / "software" / "kernels"
+DEFAULT_SIM = REPO_ROOT / "build_fast" / "obj_dir" / "Vunified_riscv_simple"
+
+# Same analytic model as UnifiedRISCVBenchmark.theoretical_performance:
+# one 4x4x4 tile (64 MACs) per unit every 20 cycles
+NUM_GPU_UNITS = 8
+THEORETICAL_MACS_PER_CYCLE = NUM_GPU_UNITS * 64 / 20
+
+# Default sweep: the suite's matrix sizes that fit the 1MB image and its
+# smaller convolution configs
+DEFAULT_CASES = (
+    [{"kernel": "matmul", "m": n, "n": n, "k": n} for n in (4, 8, 16, 32, 64, 128)] +
+    [{"kernel": kernel, "h": 16, "w": 16, "c": 8, "f": 16, "ksize": 3}
+     for kernel in ("conv2d", "conv3x3")] +
+    [{"kernel": "conv2d", "h": 32, "w": 32, "c": 16, "f": 32, "ksize": 3},
+     {"kernel": "dwconv", "h": 16, "w": 16, "c": 8, "f": 8, "ksize": 3},
+     {"kernel": "conv1x1", "h": 16, "w": 16, "c": 8, "f": 16, "ksize": 1}]
+)
+
+# Sizes bench.c builds when a case leaves them out
+KERNEL_DEFAULTS = {
+    "matmul": {"m": 32, "n": 32, "k": 32},
+    "conv2d": {"h": 16, "w": 16, "c": 8, "f": 16, "ksize": 3},
+    "conv3x3": {"h": 16, "w": 16, "c": 8, "f": 16, "ksize": 3},
+    "dwconv": {"h": 16, "w": 16, "c": 8, "f": 8, "ksize": 3},  # f is always c
+    "conv1x1": {"h": 16, "w": 16, "c": 8, "f": 16, "ksize": 1},
+}
+
+# Keys of a case; the BENCH line repeats all of them, used or not
+SIZE_KEYS = ("kernel", "m", "n", "k", "h", "w", "c", "f", "ksize")
+
+# Columns written to the CSV, in order
+CSV_FIELDS = [
+    "name", "kernel", "m", "n", "k", "h", "w", "c", "f", "ksize",
+    "cycles", "macs", "hw_macs", "gpu_ops", "busy", "stall", "mem_wait",
+    "l1_hits", "l1_misses", "l2_hits", "l2_misses", "l3_hits", "l3_misses",
+    "bank_conflicts", "arb_grants", "arb_waits", "fabric_stalls", "errors",
+    "macs_per_cycle", "theoretical_cycles", "efficiency", "sim_cycles",
+    "sim_seconds", "status",
+]
+
+
+def case_name(case: Dict) -> str:
+    """Stable identifier used to match runs across result files"""
+    if case["kernel"] == "matmul":
+        return f"matmul_{case['m']}x{case['n']}x{case['k']}"
+    return (f"{case['kernel']}_{case['h']}x{case['w']}x{case['c']}"
+            f"_f{case['f']}_k{case['ksize']}")
+
+
+def parse_bench_line(line: str) -> Dict:
+    """Parse 'BENCH key=value ...' into a dict; numeric values become ints"""
+    fields = {}
+    for token in line.split()[1:]:
+        key, _, value = token.partition("=")
+        fields[key] = int(value) if value.lstrip("-").isdigit() else value
+    return fields
+
+
+class KernelHarness:
+    """Builds and runs bench.c images and collects their measurements"""
+    
+    def __init__(self, sim: Path = DEFAULT_SIM, work_dir: Path = Path("benchmark_results"),
+                 macs_per_cycle: float = THEORETICAL_MACS_PER_CYCLE,
+                 max_cycles: int = 200000000, sim_args: Optional[List[str]] = None,
+                 gpu_units: int = NUM_GPU_UNITS):
+        self.sim = Path(sim).resolve()
+        self.work_dir = Path(work_dir).resolve()
+        self.image_dir = self.work_dir / "images"
+        self.macs_per_cycle = macs_per_cycle
+        self.max_cycles = max_cycles
+        self.sim_args = sim_args or []
+        self.gpu_units = gpu_units  # Must match the model's GPU_UNITS
+    
+    def build(self, case: Dict) -> Path:
+        """Build the image for one case; returns its path"""
+        self.image_dir.mkdir(parents=True, exist_ok=True)
+        image = self.image_dir / case_name(case)
+        args = [f"BENCH_{key.upper()}={value}" for key, value in case.items()]
+        subprocess.run(["make", "-s", "-C", str(KERNELS_DIR), "bench",
+                        f"BENCH_TARGET={image}", f"GPU_UNITS={self.gpu_units}"] + args,
+                       check=True, stdout=subprocess.DEVNULL)
+        return image
+    
+    def run(self, case: Dict) -> Dict:
+        """Build and simulate one case. Failed runs are recorded, not raised."""
+        try:
+            image = self.build(case)
+        except subprocess.CalledProcessError:
+            return {"name": case_name(case), **case, "status": "build_failed"}
+        return self.simulate(case, image)
+    
+    def simulate(self, case: Dict, image: Path, log: Optional[Path] = None) -> Dict:
+        """Run a built image once; the full simulator output goes to log if given.
+        Safe to call from several threads at once."""
+        result = {"name": case_name(case), **case}
+        cmd = [str(self.sim), f"+program={image}",
+               f"+max_cycles={self.max_cycles}"] + self.sim_args
+        start = time.perf_counter()
+        proc = subprocess.run(cmd, cwd=self.sim.parent, capture_output=True, text=True)
+        result["sim_seconds"] = round(time.perf_counter() - start, 3)
+        if log:
+            log.write_text(proc.stdout + proc.stderr)
+        
+        bench = None
+        for line in proc.stdout.splitlines():
+            if line.startswith("[console] BENCH "):
+                bench = parse_bench_line(line[len("[console] "):])
+            elif line.startswith("Cycles: "):
+                result["sim_cycles"] = int(line.split()[1])
+        if bench is None:
+            result["status"] = "timeout" if "TIMEOUT" in proc.stdout else "no_result"
+            return result
+        
+        result.update({key: value for key, value in bench.items() if key not in SIZE_KEYS})
+        result["status"] = "ok" if proc.returncode == 0 else "wrong_result"
+        self._derive(result)
+        return result
+    
+    def _derive(self, result: Dict):
+        """Measured vs. theoretical figures for one run"""
+        cycles = result.get("cycles", 0)
+        result["theoretical_cycles"] = round(result["macs"] / self.macs_per_cycle, 1)
+        result["macs_per_cycle"] = round(result["macs"] / cycles, 4) if cycles else 0.0
+        result["efficiency"] = (round(result["theoretical_cycles"] / cycles, 4)
+                                if cycles else 0.0)
+    
+    def run_all(self, cases: List[Dict]) -> List[Dict]:
+        results = []
+        for case in cases:
+            print(f"Running {case_name(case)}...", flush=True)
+            result = self.run(case)
+            if result["status"] in ("ok", "wrong_result"):
+                print(f"  {result['cycles']} cycles, {result['macs_per_cycle']:.2f} MACs/cycle, "
+                      f"efficiency {result['efficiency'] * 100:.1f}% [{result['status']}]")
+            else:
+                print(f"  {result['status']}")
+            results.append(result)
+        return results
+
+
+def write_results(results: List[Dict], json_path: Path, csv_path: Path,
+                  macs_per_cycle: float = THEORETICAL_MACS_PER_CYCLE):
+    """Write the runs as JSON (consumed by benchmark_suite.py) and CSV"""
+    payload = {
+        "generated": time.strftime("%Y-%m-%d %H:%M:%S"),
+        "theoretical_macs_per_cycle": macs_per_cycle,
+        "runs": results,
+    }
+    json_path.parent.mkdir(parents=True, exist_ok=True)
+    with open(json_path, "w") as f:
+        json.dump(payload, f, indent=2)
+    with open(csv_path, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=CSV_FIELDS, extrasaction="ignore")
+        writer.writeheader()
+        writer.writerows(results)
+
+
+def load_results(json_path: Path) -> List[Dict]:
+    with open(json_path) as f:
+        return json.load(f)["runs"]
+
+
+def compare(results: List[Dict], baseline: List[Dict], tolerance: float) -> List[str]:
+    """Runs that got slower than the baseline by more than tolerance (a
+    fraction), that stopped producing results, or that became wrong"""
+    previous = {run["name"]: run for run in baseline}
+    regressions = []
+    for run in results:
+        old = previous.get(run["name"])
+        if old is None or old.get("status") != "ok":
+            continue
+        if run.get("status") != "ok":
+            regressions.append(f"{run['name']}: {run.get('status')}")
+        elif run["cycles"] > old["cycles"] * (1 + tolerance):
+            regressions.append(f"{run['name']}: {old['cycles']} -> {run['cycles']} cycles "
+                               f"(+{(run['cycles'] / old['cycles'] - 1) * 100:.1f}%)")
+    return regressions
+
+
+def parse_case(spec: str) -> Dict:
+    """'matmul:m=64,n=64,k=64' or 'conv2d:h=32,w=32,c=16,f=32,ksize=3';
+    sizes left out take the bench.c defaults"""
+    kernel, _, sizes = spec.partition(":")
+    if kernel not in KERNEL_DEFAULTS:
+        raise argparse.ArgumentTypeError(f"unknown kernel {kernel}")
+    case = {"kernel": kernel, **KERNEL_DEFAULTS[kernel]}
+    for item in filter(None, sizes.split(",")):
+        key, _, value = item.partition("=")
+        case[key] = int(value)
+    return case
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run UnifiedRISCV kernels in simulation")
+    parser.add_argument("--sim", type=Path, default=DEFAULT_SIM,
+                        help="Verilator model to run (default: build_fast)")
+    parser.add_argument("--results-dir", type=Path, default=Path("benchmark_results"))
+    parser.add_argument("--case", action="append", type=parse_case, default=[],
+                        help="Kernel and sizes, e.g. matmul:m=64,n=64,k=64 (repeatable)")
+    parser.add_argument("--max-cycles", type=int, default=200000000)
+    parser.add_argument("--baseline", type=Path,
+                        help="Earlier measured_results.json to check for regressions")
+    parser.add_argument("--tolerance", type=float, default=5.0,
+                        help="Allowed cycle increase over the baseline, in percent")
+    args = parser.parse_args()
+    
+    if not args.sim.exists():
+        sys.exit(f"{args.sim} not found; build it first (make verilate-fast)")
+    
+    harness = KernelHarness(args.sim, args.results_dir, max_cycles=args.max_cycles)
+    results = harness.run_all(args.case or DEFAULT_CASES)
+    write_results(results, args.results_dir / "measured_results.json",
+                  args.results_dir / "measured_results.csv")
+    print(f"Results written to {args.results_dir}/measured_results.{{json,csv}}")
+    
+    failed = [run["name"] for run in results if run.get("status") != "ok"]
+    if args.baseline:
+        regressions = compare(results, load_results(args.baseline), args.tolerance / 100)
+        for line in regressions:
+            print(f"REGRESSION {line}")
+        if regressions:
+            sys.exit(1)
+    if failed:
+        sys.exit(f"Failed: {', '.join(failed)}")
+
+
+if __name__ == "__main__":
+    main()
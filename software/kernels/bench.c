@@ -0,0 +1,226 @@
+/*
+ * Single-kernel benchmark image for UnifiedRISCV
+ * Built by "make bench" in place of main.c with the kernel and its size
+ * fixed at compile time, so every run is one measurement. The result is a
+ * single "BENCH key=value ..." console line that
+ * software/benchmarks/kernel_harness.py parses; perf_report follows it for
+ * humans. A sample of the outputs is checked against a CPU reference.
+ */
+
+#include "gpu_interface.h"
+#include "matrix_ops.h"
+
+#define BENCH_KERNEL_MATMUL  1  // gpu_matrix_multiply_tiled
+#define BENCH_KERNEL_CONV2D  2  // conv2d_gpu_gemm
+#define BENCH_KERNEL_CONV3X3 3  // conv2d_3x3_optimized
+#define BENCH_KERNEL_DWCONV  4  // depthwise_conv2d_gpu
+#define BENCH_KERNEL_CONV1X1 5  // conv2d_1x1_gpu
+
+#ifndef BENCH_KERNEL
+#define BENCH_KERNEL BENCH_KERNEL_MATMUL
+#endif
+#ifndef BENCH_KERNEL_NAME
+#define BENCH_KERNEL_NAME "matmul"
+#endif
+
+// GEMM sizes: C[M x N] = A[M x K] * B[K x N]
+#ifndef BENCH_M
+#define BENCH_M 32
+#endif
+#ifndef BENCH_N
+#define BENCH_N 32
+#endif
+#ifndef BENCH_K
+#define BENCH_K 32
+#endif
+
+// Convolution sizes: CHW input, F filters of KSIZE x KSIZE, stride 1, no padding
+#ifndef BENCH_H
+#define BENCH_H 16
+#endif
+#ifndef BENCH_W
+#define BENCH_W 16
+#endif
+#ifndef BENCH_C
+#define BENCH_C 8
+#endif
+#ifndef BENCH_F
+#define BENCH_F 16
+#endif
+#ifndef BENCH_KSIZE
+#define BENCH_KSIZE 3
+#endif
+
+// Outputs compared against the CPU reference. The reference runs on the
+// rv32i core with software multiply, so checking everything would cost
+// more than the kernel itself.
+#ifndef BENCH_CHECKS
+#define BENCH_CHECKS 64
+#endif
+
+#if BENCH_KERNEL == BENCH_KERNEL_CONV3X3
+#undef BENCH_KSIZE
+#define BENCH_KSIZE 3
+#elif BENCH_KERNEL == BENCH_KERNEL_CONV1X1
+#undef BENCH_KSIZE
+#define BENCH_KSIZE 1
+#elif BENCH_KERNEL == BENCH_KERNEL_DWCONV
+// One filter per channel
+#undef BENCH_F
+#define BENCH_F BENCH_C
+#endif
+
+#if BENCH_KERNEL == BENCH_KERNEL_MATMUL
+#define BENCH_IN_SIZE      (BENCH_M * BENCH_K)
+#define BENCH_WEIGHT_SIZE  (BENCH_K * BENCH_N)
+#define BENCH_OUT_SIZE     (BENCH_M * BENCH_N)
+#define BENCH_MACS         ((uint32_t)BENCH_M * BENCH_N * BENCH_K)
+#elif BENCH_KERNEL == BENCH_KERNEL_DWCONV
+#define BENCH_OUT_H        (BENCH_H - BENCH_KSIZE + 1)
+#define BENCH_OUT_W        (BENCH_W - BENCH_KSIZE + 1)
+#define BENCH_IN_SIZE      (BENCH_C * BENCH_H * BENCH_W)
+#define BENCH_WEIGHT_SIZE  (BENCH_C * BENCH_KSIZE * BENCH_KSIZE)
+#define BENCH_OUT_SIZE     (BENCH_C * BENCH_OUT_H * BENCH_OUT_W)
+#define BENCH_MACS         ((uint32_t)BENCH_OUT_SIZE * BENCH_KSIZE * BENCH_KSIZE)
+#else
+#define BENCH_OUT_H        (BENCH_H - BENCH_KSIZE + 1)
+#define BENCH_OUT_W        (BENCH_W - BENCH_KSIZE + 1)
+#define BENCH_IN_SIZE      (BENCH_C * BENCH_H * BENCH_W)
+#define BENCH_WEIGHT_SIZE  (BENCH_F * BENCH_C * BENCH_KSIZE * BENCH_KSIZE)
+#define BENCH_OUT_SIZE     (BENCH_F * BENCH_OUT_H * BENCH_OUT_W)
+#define BENCH_MACS         ((uint32_t)BENCH_OUT_SIZE * BENCH_C * BENCH_KSIZE * BENCH_KSIZE)
+#endif
+
+static int8_t bench_input[BENCH_IN_SIZE] __attribute__((aligned(64)));
+static int8_t bench_weights[BENCH_WEIGHT_SIZE] __attribute__((aligned(64)));
+static int16_t bench_output[BENCH_OUT_SIZE] __attribute__((aligned(64)));
+
+#if BENCH_KERNEL == BENCH_KERNEL_MATMUL
+// GEMM shape, read back with the buffers above by the testbench's
+// gpu_matrix_multiply test (tb_unified_riscv_system.cpp)
+const int32_t bench_dims[3] = { BENCH_M, BENCH_N, BENCH_K };
+#endif
+
+// Same test patterns as the benchmarks in main.c
+static void bench_init(void) {
+    for (int i = 0; i < BENCH_IN_SIZE; i++) {
+        bench_input[i] = (i % 256) - 128;
+    }
+    for (int i = 0; i < BENCH_WEIGHT_SIZE; i++) {
+        bench_weights[i] = ((i * 7) % 256) - 128;
+    }
+}
+
+static void bench_run(void) {
+#if BENCH_KERNEL == BENCH_KERNEL_MATMUL
+    gpu_matrix_multiply_tiled(bench_input, bench_weights, bench_output,
+                              BENCH_M, BENCH_N, BENCH_K);
+#elif BENCH_KERNEL == BENCH_KERNEL_CONV2D
+    conv2d_gpu_gemm(bench_input, bench_weights, bench_output,
+                    BENCH_H, BENCH_W, BENCH_C, BENCH_F,
+                    BENCH_KSIZE, BENCH_KSIZE, 1, 1, 0, 0);
+#elif BENCH_KERNEL == BENCH_KERNEL_DWCONV
+    depthwise_conv2d_gpu(bench_input, bench_weights, bench_output,
+                         BENCH_H, BENCH_W, BENCH_C,
+                         BENCH_KSIZE, BENCH_KSIZE, 1, 1, 0, 0);
+#elif BENCH_KERNEL == BENCH_KERNEL_CONV1X1
+    conv2d_1x1_gpu(bench_input, bench_weights, bench_output,
+                   BENCH_H, BENCH_W, BENCH_C, BENCH_F);
+#else
+    conv2d_3x3_optimized(bench_input, bench_weights, bench_output,
+                         BENCH_H, BENCH_W, BENCH_C, BENCH_F);
+#endif
+}
+
+// Reference value of one output element, truncated like the kernels' int16 results
+static int16_t bench_reference(int index) {
+    int32_t sum = 0;
+#if BENCH_KERNEL == BENCH_KERNEL_MATMUL
+    int row = index / BENCH_N, col = index % BENCH_N;
+    for (int k = 0; k < BENCH_K; k++) {
+        sum += bench_input[row * BENCH_K + k] * bench_weights[k * BENCH_N + col];
+    }
+#elif BENCH_KERNEL == BENCH_KERNEL_DWCONV
+    int c = index / (BENCH_OUT_H * BENCH_OUT_W);
+    int oh = (index / BENCH_OUT_W) % BENCH_OUT_H;
+    int ow = index % BENCH_OUT_W;
+    const int8_t *kernel = bench_weights + c * BENCH_KSIZE * BENCH_KSIZE;
+    for (int kh = 0; kh < BENCH_KSIZE; kh++) {
+        for (int kw = 0; kw < BENCH_KSIZE; kw++) {
+            sum += bench_input[(c * BENCH_H + oh + kh) * BENCH_W + ow + kw] *
+                   kernel[kh * BENCH_KSIZE + kw];
+        }
+    }
+#else
+    int f = index / (BENCH_OUT_H * BENCH_OUT_W);
+    int oh = (index / BENCH_OUT_W) % BENCH_OUT_H;
+    int ow = index % BENCH_OUT_W;
+    const int8_t *kernel = bench_weights + f * BENCH_C * BENCH_KSIZE * BENCH_KSIZE;
+    for (int c = 0; c < BENCH_C; c++) {
+        for (int kh = 0; kh < BENCH_KSIZE; kh++) {
+            for (int kw = 0; kw < BENCH_KSIZE; kw++) {
+                sum += bench_input[(c * BENCH_H + oh + kh) * BENCH_W + ow + kw] *
+                       kernel[(c * BENCH_KSIZE + kh) * BENCH_KSIZE + kw];
+            }
+        }
+    }
+#endif
+    return (int16_t)sum;
+}
+
+// Evenly spaced sample that always includes the first and last element
+static int bench_check(void) {
+    int checks = BENCH_OUT_SIZE < BENCH_CHECKS ? BENCH_OUT_SIZE : BENCH_CHECKS;
+    int errors = 0;
+    
+    for (int i = 0; i < checks; i++) {
+        int index = checks > 1 ? (int)((uint32_t)i * (BENCH_OUT_SIZE - 1) / (checks - 1)) : 0;
+        if (bench_output[index] != bench_reference(index)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+int main(void) {
+    perf_counter_t perf;
+    uint32_t busy = 0, stall = 0, mem_wait = 0, hw_macs = 0;
+    
+    bench_init();
+    
+    // Everything up to here is the same for every run of this image
+    host_checkpoint();
+    
+    host_region_begin(BENCH_KERNEL_NAME);
+    perf_start(&perf);
+    bench_run();
+    perf_end(&perf);
+    host_region_end();
+    
+    int errors = bench_check();
+    
+    for (int unit = 0; unit < NUM_GPU_UNITS; unit++) {
+        busy += perf.unit[unit].busy_cycles;
+        stall += perf.unit[unit].stall_cycles;
+        mem_wait += perf.unit[unit].mem_wait_cycles;
+        hw_macs += perf.unit[unit].macs;
+    }
+    
+    // One line, split only to keep the format strings readable
+    debug_printf("BENCH kernel=%s m=%d n=%d k=%d h=%d w=%d c=%d f=%d ksize=%d ",
+                 BENCH_KERNEL_NAME, BENCH_M, BENCH_N, BENCH_K,
+                 BENCH_H, BENCH_W, BENCH_C, BENCH_F, BENCH_KSIZE);
+    debug_printf("cycles=%u macs=%u hw_macs=%u gpu_ops=%u busy=%u stall=%u mem_wait=%u ",
+                 perf.end_cycles - perf.start_cycles, BENCH_MACS, hw_macs,
+                 perf.gpu_operations, busy, stall, mem_wait);
+    for (int level = 0; level < GPU_CACHE_LEVELS; level++) {
+        debug_printf("l%d_hits=%u l%d_misses=%u ", level + 1, perf.cache.hits[level],
+                     level + 1, perf.cache.misses[level]);
+    }
+    debug_printf("bank_conflicts=%u arb_grants=%u arb_waits=%u fabric_stalls=%u errors=%d\n",
+                 perf.bank_conflicts, perf.arb_grants, perf.arb_waits,
+                 perf.fabric_stalls, errors);
+    
+    perf_report(&perf, BENCH_KERNEL_NAME);
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * CPU Cluster Runtime for UnifiedRISCV
+ * Hart 0 publishes a job, runs its share and waits for the others. Items
+ * are taken with one AMOADD on a queue's next index, so a hart draining its
+ * own queue and a hart stealing from it never need a lock; an index past
+ * the end just means that queue is empty.
+ */
+
+#include "gpu_interface.h"
+
+typedef struct {
+    volatile int32_t next;
+    int32_t end;
+} cluster_queue_t;
+
+static cluster_queue_t cluster_queues[NUM_HARTS];
+static int cluster_victim[NUM_HARTS];  // Queues each hart has found empty
+
+static cluster_fn cluster_job_fn;
+static void *cluster_job_ctx;
+static volatile int32_t cluster_generation;
+static volatile int32_t cluster_finished;
+static int cluster_gpu_ready;
+
+void cluster_run(int count, cluster_fn fn, void *ctx) {
+    int start = 0;
+    
+    for (int hart = 0; hart < NUM_HARTS; hart++) {
+        int end = (int)((uint32_t)count * (hart + 1) / NUM_HARTS);
+        cluster_queues[hart].next = start;
+        cluster_queues[hart].end = end;
+        cluster_victim[hart] = 0;
+        start = end;
+    }
+    
+    if (NUM_HARTS > 1) {
+        // gpu_submit sets the rings up lazily, which only hart 0 may do
+        if (!cluster_gpu_ready) {
+            gpu_queue_init();
+            cluster_gpu_ready = 1;
+        }
+        cluster_job_fn = fn;
+        cluster_job_ctx = ctx;
+        cluster_finished = 0;
+        // The job is in memory before the workers can see the new generation:
+        // the port keeps each hart's accesses in program order
+        asm volatile ("" ::: "memory");
+        cluster_generation++;
+    }
+    
+    fn(ctx, 0);
+    
+    while (cluster_finished != NUM_HARTS - 1) {
+        asm volatile ("nop");
+    }
+}
+
+int cluster_next_item(int hart) {
+    while (cluster_victim[hart] < NUM_HARTS) {
+        int queue = hart + cluster_victim[hart];
+        if (queue >= NUM_HARTS) {
+            queue -= NUM_HARTS;
+        }
+        
+        int32_t item = amo_add(&cluster_queues[queue].next, 1);
+        if (item < cluster_queues[queue].end) {
+            return item;
+        }
+        cluster_victim[hart]++;
+    }
+    return -1;
+}
+
+void cluster_worker(void) {
+    int hart = hart_id();
+    int32_t seen = 0;
+    
+    // Harts beyond the ones the image was built for stay parked
+    while (hart >= NUM_HARTS) {
+        asm volatile ("nop");
+    }
+    
+    for (;;) {
+        while (cluster_generation == seen) {
+            asm volatile ("nop");
+        }
+        // Read the job only after seeing its generation, the order hart 0
+        // published them in
+        asm volatile ("" ::: "memory");
+        seen = cluster_generation;
+        cluster_job_fn(cluster_job_ctx, hart);
+        amo_add(&cluster_finished, 1);
+    }
+}
@@ -35,6 +35,41 @@ void conv2d_direct(int8_t *input, int8_t *kernel, int16_t *output,
     }
 }
 
+// Direct multi-channel convolution: CHW input, [F][C][KH][KW] kernel,
+// int32 sums truncated to int16 like the GPU paths' int16 outputs. The
+// reference the GPU kernels are checked against.
+void conv2d_direct_multichannel(int8_t *input, int8_t *kernel, int16_t *output,
+                                int input_h, int input_w, int channels,
+                                int num_filters, int kernel_h, int kernel_w,
+                                int stride_h, int stride_w, int pad_h, int pad_w) {
+    int output_h = (input_h + 2 * pad_h - kernel_h) / stride_h + 1;
+    int output_w = (input_w + 2 * pad_w - kernel_w) / stride_w + 1;
+    
+    for (int f = 0; f < num_filters; f++) {
+        for (int oh = 0; oh < output_h; oh++) {
+            for (int ow = 0; ow < output_w; ow++) {
+                int32_t sum = 0;
+                
+                for (int c = 0; c < channels; c++) {
+                    const int8_t *plane = input + c * input_h * input_w;
+                    const int8_t *taps = kernel + (f * channels + c) * kernel_h * kernel_w;
+                    for (int kh = 0; kh < kernel_h; kh++) {
+                        for (int kw = 0; kw < kernel_w; kw++) {
+                            int ih = oh * stride_h - pad_h + kh;
+                            int iw = ow * stride_w - pad_w + kw;
+                            if (ih >= 0 && ih < input_h && iw >= 0 && iw < input_w) {
+                                sum += plane[ih * input_w + iw] * taps[kh * kernel_w + kw];
+                            }
+                        }
+                    }
+                }
+                
+                output[(f * output_h + oh) * output_w + ow] = (int16_t)sum;
+            }
+        }
+    }
+}
+
 // Im2col transformation for GEMM-based convolution
 void im2col(int8_t *input, int8_t *output,
            int input_h, int input_w, int channels,
@@ -67,22 +102,121 @@ void im2col(int8_t *input, int8_t *output,
     }
 }
 
-// GPU-accelerated convolution using GEMM approach
-void conv2d_gpu_gemm(int8_t *input, int8_t *kernel, int16_t *output,
-                     int input_h, int input_w, int channels,
-                     int num_filters, int kernel_h, int kernel_w,
-                     int stride_h, int stride_w, int pad_h, int pad_w) {
+// Implicit-GEMM geometry: the im2col matrix is never materialized, B tiles
+// are read straight out of the CHW input tensor
+typedef struct {
+    const int8_t *input;
+    int input_h, input_w;
+    int kernel_h, kernel_w;
+    int stride_h, stride_w;
+    int pad_h, pad_w;
+    int output_w;
+    int output_size;
+    int kernel_size;  // channels * kernel_h * kernel_w
+} conv_im2col_ctx_t;
+
+// Build the 4x4 im2col tile for rows k0..k0+3 (channel/kernel taps) and
+// columns p0..p0+3 (output pixels), zero padded outside the layer
+static void gather_im2col_tile(const void *ctx, int8_t *tile, int k0, int p0) {
+    const conv_im2col_ctx_t *g = (const conv_im2col_ctx_t *)ctx;
+    int taps = g->kernel_h * g->kernel_w;
+    
+    // Decompose the first column once and step through the rest
+    int oh0 = p0 / g->output_w;
+    int ow0 = p0 % g->output_w;
+    
+    for (int kk = 0; kk < 4; kk++) {
+        int k = k0 + kk;
+        int c = k / taps;
+        int kh = (k % taps) / g->kernel_w;
+        int kw = (k % taps) % g->kernel_w;
+        const int8_t *channel = g->input + c * g->input_h * g->input_w;
+        int oh = oh0;
+        int ow = ow0;
+        
+        for (int jj = 0; jj < 4; jj++) {
+            int8_t value = 0;
+            if (k < g->kernel_size && p0 + jj < g->output_size) {
+                int ih = oh * g->stride_h - g->pad_h + kh;
+                int iw = ow * g->stride_w - g->pad_w + kw;
+                if (ih >= 0 && ih < g->input_h && iw >= 0 && iw < g->input_w) {
+                    value = channel[ih * g->input_w + iw];
+                }
+            }
+            tile[kk * 4 + jj] = value;
+            
+            if (++ow == g->output_w) {
+                ow = 0;
+                oh++;
+            }
+        }
+    }
+}
+
+// Shared implicit-GEMM path; kernel is row-major or pre-packed and out
+// selects the result format
+static void conv2d_implicit(int8_t *input, int8_t *kernel, const int8_t *packed_kernel,
+                            const gpu_gemm_out_t *out, int input_h, int input_w, int channels,
+                            int num_filters, int kernel_h, int kernel_w,
+                            int stride_h, int stride_w, int pad_h, int pad_w) {
+    conv_im2col_ctx_t ctx;
+    ctx.input = input;
+    ctx.input_h = input_h;
+    ctx.input_w = input_w;
+    ctx.kernel_h = kernel_h;
+    ctx.kernel_w = kernel_w;
+    ctx.stride_h = stride_h;
+    ctx.stride_w = stride_w;
+    ctx.pad_h = pad_h;
+    ctx.pad_w = pad_w;
+    ctx.output_w = (input_w + 2 * pad_w - kernel_w) / stride_w + 1;
+    ctx.output_size = ((input_h + 2 * pad_h - kernel_h) / stride_h + 1) * ctx.output_w;
+    ctx.kernel_size = channels * kernel_h * kernel_w;
+    
+    // Working set is only the per-unit staging tiles, whatever the layer size
+    gpu_gemm_os(kernel, packed_kernel, 0, 0, gather_im2col_tile, &ctx, out,
+                num_filters, ctx.output_size, ctx.kernel_size);
+}
+
+// Implicit-GEMM convolution: no im2col buffer, any layer size
+void conv2d_gpu_implicit_gemm(int8_t *input, int8_t *kernel, int16_t *output,
+                              int input_h, int input_w, int channels,
+                              int num_filters, int kernel_h, int kernel_w,
+                              int stride_h, int stride_w, int pad_h, int pad_w) {
+    gpu_gemm_out_t out = { output, 0, 0, 0, 0 };
+    conv2d_implicit(input, kernel, 0, &out, input_h, input_w, channels,
+                    num_filters, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
+}
+
+// Shared GEMM convolution: explicit im2col when it fits, implicit otherwise
+static void conv2d_gemm(int8_t *input, int8_t *kernel, const int8_t *packed_kernel,
+                        const gpu_gemm_out_t *out, int input_h, int input_w, int channels,
+                        int num_filters, int kernel_h, int kernel_w,
+                        int stride_h, int stride_w, int pad_h, int pad_w) {
     
     int output_h = (input_h + 2 * pad_h - kernel_h) / stride_h + 1;
     int output_w = (input_w + 2 * pad_w - kernel_w) / stride_w + 1;
     int output_size = output_h * output_w;
     
+    // Pointwise: the im2col matrix of an unpadded stride-1 1x1 conv is the
+    // CHW input itself
+    if (kernel_h == 1 && kernel_w == 1 && stride_h == 1 && stride_w == 1 &&
+        pad_h == 0 && pad_w == 0) {
+        gpu_gemm_os(kernel, packed_kernel, input, 0, 0, 0, out,
+                    num_filters, output_size, channels);
+        return;
+    }
+    
     // Allocate im2col buffer
     int col_size = channels * kernel_h * kernel_w * output_size;
     static int8_t im2col_buffer[32768]; // Statically allocated buffer
     
-    if (col_size > sizeof(im2col_buffer)) {
-        debug_print("Error: im2col buffer too small\n");
+    // Layers whose im2col matrix does not fit use the implicit path, and so
+    // does a cluster: every hart gathers its own tiles instead of hart 0
+    // building the whole matrix while the others wait
+    if (NUM_HARTS > 1 || col_size > (int)sizeof(im2col_buffer)) {
+        conv2d_implicit(input, kernel, packed_kernel, out, input_h, input_w, channels,
+                        num_filters, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
         return;
     }
     
@@ -97,74 +231,424 @@ void conv2d_gpu_gemm(int8_t *input, int8_t *kernel, int16_t *output,
     
     int kernel_size = channels * kernel_h * kernel_w;
     
-    // Use tiled matrix multiplication with GPU
-    gpu_matrix_multiply_tiled(kernel, im2col_buffer, output,
-                             num_filters, output_size, kernel_size);
+    // Use output-stationary tiled matrix multiplication with GPU; packed
+    // weight tiles go to the units straight from the packed buffer
+    gpu_gemm_os(kernel, packed_kernel, im2col_buffer, 0, 0, 0, out,
+                num_filters, output_size, kernel_size);
 }
 
-// Optimized 3x3 convolution with stride 1
-void conv2d_3x3_optimized(int8_t *input, int8_t *kernel, int16_t *output,
-                          int input_h, int input_w, int channels, int num_filters) {
+// GPU-accelerated convolution using GEMM approach
+void conv2d_gpu_gemm(int8_t *input, int8_t *kernel, int16_t *output,
+                     int input_h, int input_w, int channels,
+                     int num_filters, int kernel_h, int kernel_w,
+                     int stride_h, int stride_w, int pad_h, int pad_w) {
+    gpu_gemm_out_t out = { output, 0, 0, 0, 0 };
+    conv2d_gemm(input, kernel, 0, &out, input_h, input_w, channels,
+                num_filters, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
+}
+
+// GEMM convolution with int32 outputs, exact for any channels * kernel size
+void conv2d_gpu_gemm_int32(int8_t *input, int8_t *kernel, int32_t *output,
+                           int input_h, int input_w, int channels,
+                           int num_filters, int kernel_h, int kernel_w,
+                           int stride_h, int stride_w, int pad_h, int pad_w) {
+    gpu_gemm_out_t out = { 0, output, 0, 0, 0 };
+    conv2d_gemm(input, kernel, 0, &out, input_h, input_w, channels,
+                num_filters, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
+}
+
+// GEMM convolution with weights pre-packed by
+// gpu_pack_weights_4x4(kernel, packed_kernel, num_filters, channels * kernel_h * kernel_w)
+void conv2d_gpu_gemm_packed(int8_t *input, const int8_t *packed_kernel, int16_t *output,
+                            int input_h, int input_w, int channels,
+                            int num_filters, int kernel_h, int kernel_w,
+                            int stride_h, int stride_w, int pad_h, int pad_w) {
+    gpu_gemm_out_t out = { output, 0, 0, 0, 0 };
+    conv2d_gemm(input, 0, packed_kernel, &out, input_h, input_w, channels,
+                num_filters, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
+}
+
+// Fused conv + per-filter bias + requantize (+ ReLU): int8 activations are
+// written once, straight from the accumulator tiles
+void conv2d_gpu_gemm_requant(int8_t *input, int8_t *kernel, int8_t *output,
+                             int input_h, int input_w, int channels,
+                             int num_filters, int kernel_h, int kernel_w,
+                             int stride_h, int stride_w, int pad_h, int pad_w,
+                             const gpu_requant_t *requant) {
+    gpu_gemm_out_t out = { 0, 0, output, requant, 0 };
+    conv2d_gemm(input, kernel, 0, &out, input_h, input_w, channels,
+                num_filters, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
+}
+
+void conv2d_gpu_gemm_packed_requant(int8_t *input, const int8_t *packed_kernel, int8_t *output,
+                                    int input_h, int input_w, int channels,
+                                    int num_filters, int kernel_h, int kernel_w,
+                                    int stride_h, int stride_w, int pad_h, int pad_w,
+                                    const gpu_requant_t *requant) {
+    gpu_gemm_out_t out = { 0, 0, output, requant, 0 };
+    conv2d_gemm(input, 0, packed_kernel, &out, input_h, input_w, channels,
+                num_filters, kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
+}
+
+// Pointwise (1x1, stride 1) convolution: one GEMM of the weights
+// [num_filters x channels] by the CHW input [channels x input_h * input_w]
+void conv2d_1x1_gpu(int8_t *input, int8_t *kernel, int16_t *output,
+                    int input_h, int input_w, int channels, int num_filters) {
+    gpu_gemm_out_t out = { output, 0, 0, 0, 0 };
+    conv2d_gemm(input, kernel, 0, &out, input_h, input_w, channels,
+                num_filters, 1, 1, 1, 1, 0, 0);
+}
+
+// Weights packed by gpu_pack_weights_4x4(kernel, packed_kernel, num_filters, channels)
+void conv2d_1x1_gpu_packed(int8_t *input, const int8_t *packed_kernel, int16_t *output,
+                           int input_h, int input_w, int channels, int num_filters) {
+    gpu_gemm_out_t out = { output, 0, 0, 0, 0 };
+    conv2d_gemm(input, 0, packed_kernel, &out, input_h, input_w, channels,
+                num_filters, 1, 1, 1, 1, 0, 0);
+}
+
+// Pointwise conv straight to int8 activations for the next layer
+void conv2d_1x1_gpu_requant(int8_t *input, const int8_t *packed_kernel, int8_t *output,
+                            int input_h, int input_w, int channels, int num_filters,
+                            const gpu_requant_t *requant) {
+    gpu_gemm_out_t out = { 0, 0, output, requant, 0 };
+    conv2d_gemm(input, 0, packed_kernel, &out, input_h, input_w, channels,
+                num_filters, 1, 1, 1, 1, 0, 0);
+}
+
+// Pack 3x3 kernels [num_filters][channels][3][3] into one zero-padded
+// 4x4 tile per (filter, channel), 16 bytes each in the same order
+void gpu_pack_conv3x3_weights(const int8_t *kernel, int8_t *packed,
+                              int channels, int num_filters) {
+    for (int i = 0; i < num_filters * channels; i++) {
+        gpu_pack_weights_4x4(kernel + i * 9, packed + i * 16, 3, 3);
+    }
+}
+
+// Winograd F(2x2,3x3): each 4x4 input tile d (stride 2) gives a 2x2 output
+// tile Y = A^T [sum_c (G g_c G^T) . (B^T d_c B)] A. The elementwise products
+// summed over channels are 16 independent GEMMs, one per tile position, of
+// transformed weights [filters x channels] by transformed inputs
+// [channels x tiles]; the units run them with INT16 operands, since the
+// transformed values outgrow int8. G is scaled by 2 so the weight transform
+// is integer (U = 4 G g G^T) and the output transform shifts the 4 back out
+// exactly. That is 16 multiplies per output tile and channel instead of 36.
+#define WINOGRAD_MAX_GROUPS  8   // Groups of 4 tiles transformed at once
+#define WINOGRAD_SLICE_TILES 8   // Channel blocks per pass (32 channels)
+
+// Transformed inputs of one pass: B tiles [position][channel block][group]
+static int16_t winograd_v[16 * WINOGRAD_SLICE_TILES * WINOGRAD_MAX_GROUPS * 16]
+    __attribute__((aligned(64)));
+// GEMM results, double-buffered across filter blocks: [position][group] int32 C tiles
+static int32_t winograd_m[2][16 * WINOGRAD_MAX_GROUPS * 16] __attribute__((aligned(64)));
+
+// U = (2G) g (2G)^T for one 3x3 kernel with the given row stride; entries
+// stay within +-1152
+static void winograd_weight_tile(const int8_t *g, int row_stride, int16_t *u) {
+    int16_t t[4][3];
     
-    int output_h = input_h - 2; // No padding, 3x3 kernel
-    int output_w = input_w - 2;
+    for (int j = 0; j < 3; j++) {
+        int16_t g0 = g[j], g1 = g[row_stride + j], g2 = g[2 * row_stride + j];
+        t[0][j] = g0 << 1;
+        t[1][j] = g0 + g1 + g2;
+        t[2][j] = g0 - g1 + g2;
+        t[3][j] = g2 << 1;
+    }
+    for (int i = 0; i < 4; i++) {
+        u[i * 4 + 0] = t[i][0] << 1;
+        u[i * 4 + 1] = t[i][0] + t[i][1] + t[i][2];
+        u[i * 4 + 2] = t[i][0] - t[i][1] + t[i][2];
+        u[i * 4 + 3] = t[i][2] << 1;
+    }
+}
+
+// Transform every (filter, channel) kernel into INT16 A tiles laid out
+// [position][filter block][channel block], zero padded to whole blocks.
+// The strides select plain 3x3 or packed 4x4 kernels, or a subset of them.
+static void winograd_weights(const int8_t *kernel, int filter_stride, int kernel_stride,
+                             int row_stride, int16_t *transformed, int channels,
+                             int num_filters) {
+    int f_tiles = (num_filters + 3) / 4;
+    int c_tiles = (channels + 3) / 4;
+    int position_stride = f_tiles * c_tiles * 16;
+    
+    for (int i = 0; i < 16 * position_stride; i++) {
+        transformed[i] = 0;
+    }
     
-    // Process 4 output pixels at once using GPU 4x4 matrix units
     for (int f = 0; f < num_filters; f++) {
-       for (int c = 0; c < channels; c++) {
-           for (int oh = 0; oh < output_h; oh += 2) {
-               for (int ow = 0; ow < output_w; ow += 2) {
-                   
-                   // Extract 4x4 input patch for 2x2 output
-                   int8_t input_patch[16];
-                   int16_t output_patch[4] = {0};
-                   
-                   // Fill input patch (4x4)
-                   for (int i = 0; i < 4; i++) {
-                       for (int j = 0; j < 4; j++) {
-                           int ih = oh + i;
-                           int iw = ow + j;
-                           if (ih < input_h && iw < input_w) {
-                               input_patch[i * 4 + j] = 
-                                   input[c * input_h * input_w + ih * input_w + iw];
-                           } else {
-                               input_patch[i * 4 + j] = 0;
-                           }
-                       }
-                   }
-                   
-                   // Create 4x4 kernel matrix (replicated 3x3 kernel)
-                   int8_t kernel_matrix[16];
-                   for (int i = 0; i < 16; i++) {
-                       kernel_matrix[i] = 0;
-                   }
-                   
-                   // Copy 3x3 kernel to top-left of 4x4 matrix
-                   for (int i = 0; i < 3; i++) {
-                       for (int j = 0; j < 3; j++) {  
-                           kernel_matrix[i * 4 + j] = 
-                               kernel[f * channels * 9 + c * 9 + i * 3 + j];
-                       }
-                   }
-                   
-                   // Use GPU for 4x4 matrix multiply
-                   gpu_matrix_multiply_4x4(input_patch, kernel_matrix, output_patch, 
-                                         f % 8); // Use GPU unit based on filter
-                   
-                   // Accumulate results to output (only use top-left 2x2)
-                   for (int i = 0; i < 2 && (oh + i) < output_h; i++) {
-                       for (int j = 0; j < 2 && (ow + j) < output_w; j++) {
-                           int out_idx = f * output_h * output_w + 
-                                       (oh + i) * output_w + (ow + j);
-                           output[out_idx] += output_patch[i * 4 + j];
-                       }
-                   }
-               }
-           }
-       }
+        const int8_t *g = kernel + f * filter_stride;
+        for (int c = 0; c < channels; c++) {
+            int16_t u[16];
+            int16_t *dst = transformed + ((f >> 2) * c_tiles + (c >> 2)) * 16 +
+                           (f & 3) * 4 + (c & 3);
+            
+            winograd_weight_tile(g, row_stride, u);
+            for (int p = 0; p < 16; p++) {
+                *dst = u[p];
+                dst += position_stride;
+            }
+            g += kernel_stride;
+        }
+    }
+}
+
+// Pre-transform 3x3 kernels [num_filters][channels][3][3] for
+// conv2d_3x3_winograd, once per model; transformed holds
+// WINOGRAD_3X3_WEIGHTS(channels, num_filters) values
+void gpu_winograd_conv3x3_weights(const int8_t *kernel, int16_t *transformed,
+                                  int channels, int num_filters) {
+    winograd_weights(kernel, channels * 9, 9, 3, transformed, channels, num_filters);
+}
+
+// B^T d B for channels c0.. of one pass and tiles t0.. of one chunk.
+// Channels and tiles past the layer give zero columns and rows.
+static void winograd_input_pass(const int8_t *input, int input_h, int input_w, int channels,
+                                int c0, int slice_tiles, int tiles_w, int num_tiles,
+                                int t0, int groups) {
+    int position_stride = slice_tiles * groups * 16;
+    int th0 = t0 / tiles_w;
+    int tw0 = t0 - th0 * tiles_w;
+    int plane_size = input_h * input_w;
+    
+    for (int cl = 0; cl < slice_tiles * 4; cl++) {
+        int c = c0 + cl;
+        const int8_t *plane = input + c * plane_size;
+        int th = th0, tw = tw0;
+        
+        for (int tl = 0; tl < groups * 4; tl++) {
+            int16_t *dst = winograd_v + ((cl >> 2) * groups + (tl >> 2)) * 16 +
+                           (cl & 3) * 4 + (tl & 3);
+            int16_t d[16], r[16];
+            int valid = c < channels && t0 + tl < num_tiles;
+            
+            for (int i = 0; i < 4; i++) {
+                for (int j = 0; j < 4; j++) {
+                    int ih = th * 2 + i;
+                    int iw = tw * 2 + j;
+                    d[i * 4 + j] = (valid && ih < input_h && iw < input_w) ?
+                                   plane[ih * input_w + iw] : 0;
+                }
+            }
+            
+            // Rows, then columns; only adds and subtracts
+            for (int j = 0; j < 4; j++) {
+                r[0 + j] = d[0 + j] - d[8 + j];
+                r[4 + j] = d[4 + j] + d[8 + j];
+                r[8 + j] = d[8 + j] - d[4 + j];
+                r[12 + j] = d[4 + j] - d[12 + j];
+            }
+            for (int i = 0; i < 16; i += 4) {
+                dst[0] = r[i + 0] - r[i + 2];
+                dst += position_stride;
+                dst[0] = r[i + 1] + r[i + 2];
+                dst += position_stride;
+                dst[0] = r[i + 2] - r[i + 1];
+                dst += position_stride;
+                dst[0] = r[i + 1] - r[i + 3];
+                dst += position_stride;
+            }
+            
+            if (++tw == tiles_w) {
+                tw = 0;
+                th++;
+            }
+        }
     }
 }
 
+// Y = A^T M A / 4 for filters f0..f0+3 of one chunk. Later channel passes
+// add to the output; int16 wraps like truncating the full sum would.
+static void winograd_output_block(const int32_t *m, int16_t *output, int f0, int num_filters,
+                                  int output_h, int output_w, int tiles_w, int num_tiles,
+                                  int t0, int groups, int accumulate) {
+    int th0 = t0 / tiles_w;
+    int tw0 = t0 - th0 * tiles_w;
+    
+    for (int fi = 0; fi < 4 && f0 + fi < num_filters; fi++) {
+        int16_t *plane = output + (f0 + fi) * output_h * output_w;
+        int th = th0, tw = tw0;
+        
+        for (int tl = 0; tl < groups * 4 && t0 + tl < num_tiles; tl++) {
+            const int32_t *src = m + (tl >> 2) * 16 + fi * 4 + (tl & 3);
+            int32_t s[16], r0[4], r1[4], y[4];
+            
+            for (int p = 0; p < 16; p++) {
+                s[p] = *src;
+                src += groups * 16;
+            }
+            for (int j = 0; j < 4; j++) {
+                r0[j] = s[j] + s[4 + j] + s[8 + j];
+                r1[j] = s[4 + j] - s[8 + j] - s[12 + j];
+            }
+            // Exact: every sum is a multiple of 4
+            y[0] = (r0[0] + r0[1] + r0[2]) >> 2;
+            y[1] = (r0[1] - r0[2] - r0[3]) >> 2;
+            y[2] = (r1[0] + r1[1] + r1[2]) >> 2;
+            y[3] = (r1[1] - r1[2] - r1[3]) >> 2;
+            
+            int oh = th * 2, ow = tw * 2;
+            for (int i = 0; i < 2 && oh + i < output_h; i++) {
+                int16_t *row = plane + (oh + i) * output_w + ow;
+                for (int j = 0; j < 2 && ow + j < output_w; j++) {
+                    row[j] = accumulate ? (int16_t)(row[j] + y[i * 2 + j]) : (int16_t)y[i * 2 + j];
+                }
+            }
+            
+            if (++tw == tiles_w) {
+                tw = 0;
+                th++;
+            }
+        }
+    }
+}
+
+// Queue the 16 position GEMMs of one filter block: every (position, group)
+// C tile is one accumulation chain over the pass's channel blocks, kept on
+// one unit. Records each unit's last ticket; returns the units used.
+static int winograd_submit_block(const int16_t *weights, int32_t *m, uint32_t *last_ticket,
+                                 int fb, int f_tiles, int c_tiles, int cb0, int slice_tiles,
+                                 int groups) {
+    int unit = 0;
+    int used = 0;
+    
+    for (int p = 0; p < 16; p++) {
+        const int16_t *a_row = weights + ((p * f_tiles + fb) * c_tiles + cb0) * 16;
+        const int16_t *b_pos = winograd_v + p * slice_tiles * groups * 16;
+        
+        for (int g = 0; g < groups; g++) {
+            int32_t *c = m + (p * groups + g) * 16;
+            const int16_t *b = b_pos + g * 16;
+            
+            for (int cb = 0; cb < slice_tiles; cb++) {
+                uint32_t config = GPU_CFG_INT16 | GPU_CFG_ACC32;
+                if (cb > 0) config |= GPU_CFG_ACCUMULATE;
+                if (cb < slice_tiles - 1) config |= GPU_CFG_DEFER_STORE;
+                last_ticket[unit] = gpu_submit(unit, a_row + cb * 16, b, c, config);
+                b += groups * 16;
+            }
+            
+            if (++unit > used) used = unit;
+            if (unit == NUM_GPU_UNITS) unit = 0;
+        }
+    }
+    return used;
+}
+
+static void winograd_wait(const uint32_t *last_ticket, int used) {
+    for (int unit = 0; unit < used; unit++) {
+        gpu_wait_ticket(unit, last_ticket[unit]);
+    }
+}
+
+// Tiles go in chunks and channels in passes small enough for the static
+// transform buffers; within a pass the output transform of one filter
+// block overlaps the GEMMs of the next. accumulate adds to the output.
+static void winograd_conv(const int8_t *input, const int16_t *transformed_kernel,
+                          int16_t *output, int input_h, int input_w, int channels,
+                          int num_filters, int accumulate) {
+    int output_h = input_h - 2;
+    int output_w = input_w - 2;
+    int tiles_w = (output_w + 1) / 2;
+    int num_tiles = ((output_h + 1) / 2) * tiles_w;
+    int f_tiles = (num_filters + 3) / 4;
+    int c_tiles = (channels + 3) / 4;
+    uint32_t last_ticket[2][NUM_GPU_UNITS];
+    int used[2];
+    
+    if (output_h <= 0 || output_w <= 0) {
+        return;
+    }
+    
+    int slice_tiles = c_tiles < WINOGRAD_SLICE_TILES ? c_tiles : WINOGRAD_SLICE_TILES;
+    int groups = (WINOGRAD_SLICE_TILES * WINOGRAD_MAX_GROUPS) / slice_tiles;
+    if (groups > WINOGRAD_MAX_GROUPS) groups = WINOGRAD_MAX_GROUPS;
+    
+    for (int t0 = 0; t0 < num_tiles; t0 += groups * 4) {
+        // The last chunk shrinks to the tiles that are left
+        int chunk = (num_tiles - t0 + 3) / 4;
+        if (chunk > groups) chunk = groups;
+        
+        for (int cb0 = 0; cb0 < c_tiles; cb0 += slice_tiles) {
+            int pass_tiles = c_tiles - cb0 < slice_tiles ? c_tiles - cb0 : slice_tiles;
+            int prev_fb = -1;
+            
+            winograd_input_pass(input, input_h, input_w, channels, cb0 * 4, pass_tiles,
+                                tiles_w, num_tiles, t0, chunk);
+            
+            for (int fb = 0; fb < f_tiles; fb++) {
+                int buf = fb & 1;
+                used[buf] = winograd_submit_block(transformed_kernel, winograd_m[buf],
+                                                  last_ticket[buf], fb, f_tiles, c_tiles,
+                                                  cb0, pass_tiles, chunk);
+                if (prev_fb >= 0) {
+                    winograd_wait(last_ticket[buf ^ 1], used[buf ^ 1]);
+                    winograd_output_block(winograd_m[buf ^ 1], output, prev_fb * 4,
+                                          num_filters, output_h, output_w, tiles_w,
+                                          num_tiles, t0, chunk, accumulate || cb0 > 0);
+                }
+                prev_fb = fb;
+            }
+            
+            // The next pass overwrites the transformed inputs
+            winograd_wait(last_ticket[prev_fb & 1], used[prev_fb & 1]);
+            winograd_output_block(winograd_m[prev_fb & 1], output, prev_fb * 4, num_filters,
+                                  output_h, output_w, tiles_w, num_tiles, t0, chunk,
+                                  accumulate || cb0 > 0);
+        }
+    }
+}
+
+// Winograd 3x3 convolution, stride 1, no padding, with weights from
+// gpu_winograd_conv3x3_weights
+void conv2d_3x3_winograd(int8_t *input, const int16_t *transformed_kernel, int16_t *output,
+                         int input_h, int input_w, int channels, int num_filters) {
+    winograd_conv(input, transformed_kernel, output, input_h, input_w, channels,
+                  num_filters, 0);
+}
+
+// Scratch for the entry points that transform their weights per call
+#define WINOGRAD_WEIGHT_BUFFER 8192
+static int16_t winograd_weight_buffer[WINOGRAD_WEIGHT_BUFFER] __attribute__((aligned(64)));
+
+// Winograd over blocks of filters and channels whose transformed weights
+// fit the scratch buffer; channel blocks after the first add to the output
+static void winograd_conv_blocked(const int8_t *input, const int8_t *kernel, int kernel_stride,
+                                  int row_stride, int16_t *output, int input_h, int input_w,
+                                  int channels, int num_filters) {
+    int c_block = channels < 128 ? channels : 128;
+    int f_block = 4 * (WINOGRAD_WEIGHT_BUFFER / WINOGRAD_3X3_WEIGHTS(c_block, 4));
+    int plane_in = input_h * input_w;
+    int plane_out = (input_h - 2) * (input_w - 2);
+    
+    for (int f0 = 0; f0 < num_filters; f0 += f_block) {
+        int fn = num_filters - f0 < f_block ? num_filters - f0 : f_block;
+        for (int c0 = 0; c0 < channels; c0 += c_block) {
+            int cn = channels - c0 < c_block ? channels - c0 : c_block;
+            winograd_weights(kernel + (f0 * channels + c0) * kernel_stride,
+                             channels * kernel_stride, kernel_stride, row_stride,
+                             winograd_weight_buffer, cn, fn);
+            winograd_conv(input + c0 * plane_in, winograd_weight_buffer,
+                          output + f0 * plane_out, input_h, input_w, cn, fn, c0 > 0);
+        }
+    }
+}
+
+// Optimized 3x3 convolution with stride 1 (Winograd, weights transformed per call)
+void conv2d_3x3_optimized(int8_t *input, int8_t *kernel, int16_t *output,
+                          int input_h, int input_w, int channels, int num_filters) {
+    winograd_conv_blocked(input, kernel, 9, 3, output, input_h, input_w,
+                          channels, num_filters);
+}
+
+// 3x3 convolution with kernels pre-packed by gpu_pack_conv3x3_weights;
+// the taps are read back out of the padded tiles
+void conv2d_3x3_packed(int8_t *input, const int8_t *packed_kernel, int16_t *output,
+                       int input_h, int input_w, int channels, int num_filters) {
+    winograd_conv_blocked(input, packed_kernel, 16, 4, output, input_h, input_w,
+                          channels, num_filters);
+}
+
 // Depthwise separable convolution (MobileNet style)
 void depthwise_conv2d(int8_t *input, int8_t *depthwise_kernel, int16_t *output,
                      int input_h, int input_w, int channels,
@@ -198,17 +682,181 @@ void depthwise_conv2d(int8_t *input, int8_t *depthwise_kernel, int16_t *output,
     }
 }
 
+// Depthwise on the GPU: one 4x4 output tile of one channel is the C tile
+// of A[4 output rows x K] * B[K x 4 output columns]. K runs over (kh, t),
+// t being the input column offset from the tile's first output column,
+// 0 .. 3 * stride_w + kernel_w - 1. B holds the channel's kernel as a band,
+// B[(kh, t)][j] = kernel[kh][t - j * stride_w], built once per channel;
+// A tiles are gathered from the input. Each unit takes its own channel, so
+// NUM_GPU_UNITS channels run side by side.
+#define DW_MAX_K_STEPS 16   // K up to 64: 3x3 at stride 1 is 18, 5x5 at stride 2 is 55
+
+static int8_t dw_band[NUM_GPU_UNITS][DW_MAX_K_STEPS][16] __attribute__((aligned(64)));
+static int8_t dw_slots[NUM_GPU_UNITS][GPU_RING_DEPTH][16] __attribute__((aligned(64)));
+static int16_t dw_out[NUM_GPU_UNITS][2][16] __attribute__((aligned(64)));
+
+// Per K index: kernel row, column offset, and input offset from the tile origin
+typedef struct {
+    int k_steps;
+    int taps;
+    int8_t kh[DW_MAX_K_STEPS * 4];
+    int8_t t[DW_MAX_K_STEPS * 4];
+    int offset[DW_MAX_K_STEPS * 4];
+} dw_geometry_t;
+
+static void dw_build_band(const dw_geometry_t *geo, const int8_t *kernel, int8_t band[][16],
+                          int kernel_w, int stride_w) {
+    for (int k = 0; k < geo->k_steps * 4; k++) {
+        int8_t *row = band[k >> 2] + (k & 3) * 4;
+        for (int j = 0; j < 4; j++) {
+            int tap = geo->t[k] - j * stride_w;
+            row[j] = (k < geo->taps && tap >= 0 && tap < kernel_w) ?
+                     kernel[geo->kh[k] * kernel_w + tap] : 0;
+        }
+    }
+}
+
+// A tile for K rows 4 * ks .. 4 * ks + 3 of the output tile at (oh0, ow0);
+// taps outside the input are the zero padding
+static void dw_gather_tile(const dw_geometry_t *geo, int8_t *tile, const int8_t *plane,
+                           int ks, int oh0, int ow0, int input_h, int input_w, int output_h,
+                           int stride_h, int stride_w, int pad_h, int pad_w) {
+    int iw0 = ow0 * stride_w - pad_w;
+    
+    for (int i = 0; i < 4; i++) {
+        int ih0 = (oh0 + i) * stride_h - pad_h;
+        int origin = ih0 * input_w + iw0;
+        
+        for (int kk = 0; kk < 4; kk++) {
+            int k = ks * 4 + kk;
+            int ih = ih0 + geo->kh[k];
+            int iw = iw0 + geo->t[k];
+            int valid = oh0 + i < output_h && k < geo->taps &&
+                        ih >= 0 && ih < input_h && iw >= 0 && iw < input_w;
+            tile[i * 4 + kk] = valid ? plane[origin + geo->offset[k]] : 0;
+        }
+    }
+}
+
+static void dw_store_tile(int16_t *plane, const int16_t *tile, int oh0, int ow0,
+                          int output_h, int output_w) {
+    for (int i = 0; i < 4 && oh0 + i < output_h; i++) {
+        int16_t *row = plane + (oh0 + i) * output_w + ow0;
+        for (int j = 0; j < 4 && ow0 + j < output_w; j++) {
+            row[j] = tile[i * 4 + j];
+        }
+    }
+}
+
+void depthwise_conv2d_gpu(int8_t *input, int8_t *depthwise_kernel, int16_t *output,
+                          int input_h, int input_w, int channels,
+                          int kernel_h, int kernel_w,
+                          int stride_h, int stride_w, int pad_h, int pad_w) {
+    int output_h = (input_h + 2 * pad_h - kernel_h) / stride_h + 1;
+    int output_w = (input_w + 2 * pad_w - kernel_w) / stride_w + 1;
+    int span = 3 * stride_w + kernel_w;
+    int tiles_w = (output_w + 3) / 4;
+    int num_tiles = ((output_h + 3) / 4) * tiles_w;
+    dw_geometry_t geo;
+    uint32_t tickets[NUM_GPU_UNITS][GPU_RING_DEPTH];
+    uint32_t last_ticket[2][NUM_GPU_UNITS];
+    uint32_t submitted[NUM_GPU_UNITS];
+    
+    geo.taps = kernel_h * span;
+    geo.k_steps = (geo.taps + 3) / 4;
+    
+    if (output_h <= 0 || output_w <= 0) {
+        return;
+    }
+    
+    // Wide kernels or strides do not fit the band tiles
+    if (geo.k_steps > DW_MAX_K_STEPS) {
+        depthwise_conv2d(input, depthwise_kernel, output, input_h, input_w, channels,
+                         kernel_h, kernel_w, stride_h, stride_w, pad_h, pad_w);
+        return;
+    }
+    for (int k = 0; k < geo.k_steps * 4; k++) {
+        geo.kh[k] = k < geo.taps ? k / span : 0;
+        geo.t[k] = k < geo.taps ? k % span : 0;
+        geo.offset[k] = geo.kh[k] * input_w + geo.t[k];
+    }
+    for (int unit = 0; unit < NUM_GPU_UNITS; unit++) {
+        submitted[unit] = 0;
+    }
+    
+    for (int c0 = 0; c0 < channels; c0 += NUM_GPU_UNITS) {
+        int batch = channels - c0 < NUM_GPU_UNITS ? channels - c0 : NUM_GPU_UNITS;
+        int prev_tile = -1;
+        
+        // The previous channels are fully drained, so their bands are free
+        for (int unit = 0; unit < batch; unit++) {
+            dw_build_band(&geo, depthwise_kernel + (c0 + unit) * kernel_h * kernel_w,
+                          dw_band[unit], kernel_w, stride_w);
+        }
+        
+        // Every unit computes the same output tile of its own channel;
+        // the previous tile is drained while the next one is queued
+        for (int tile = 0; tile < num_tiles; tile++) {
+            int buf = tile & 1;
+            int oh0 = (tile / tiles_w) * 4;
+            int ow0 = (tile % tiles_w) * 4;
+            
+            for (int unit = 0; unit < batch; unit++) {
+                const int8_t *plane = input + (c0 + unit) * input_h * input_w;
+                
+                for (int ks = 0; ks < geo.k_steps; ks++) {
+                    int slot = submitted[unit] % GPU_RING_DEPTH;
+                    uint32_t config = 0;
+                    if (ks > 0) config |= GPU_CFG_ACCUMULATE;
+                    if (ks < geo.k_steps - 1) config |= GPU_CFG_DEFER_STORE;
+                    
+                    // Staging slots are recycled in ring order
+                    if (submitted[unit] >= GPU_RING_DEPTH) {
+                        gpu_wait_ticket(unit, tickets[unit][slot]);
+                    }
+                    dw_gather_tile(&geo, dw_slots[unit][slot], plane, ks, oh0, ow0,
+                                   input_h, input_w, output_h, stride_h, stride_w,
+                                   pad_h, pad_w);
+                    tickets[unit][slot] = gpu_submit(unit, dw_slots[unit][slot],
+                                                     dw_band[unit][ks], dw_out[unit][buf],
+                                                     config);
+                    last_ticket[buf][unit] = tickets[unit][slot];
+                    submitted[unit]++;
+                }
+            }
+            
+            if (prev_tile >= 0) {
+                for (int unit = 0; unit < batch; unit++) {
+                    gpu_wait_ticket(unit, last_ticket[buf ^ 1][unit]);
+                    dw_store_tile(output + (c0 + unit) * output_h * output_w,
+                                  dw_out[unit][buf ^ 1], (prev_tile / tiles_w) * 4,
+                                  (prev_tile % tiles_w) * 4, output_h, output_w);
+                }
+            }
+            prev_tile = tile;
+        }
+        
+        for (int unit = 0; unit < batch; unit++) {
+            gpu_wait_ticket(unit, last_ticket[prev_tile & 1][unit]);
+            dw_store_tile(output + (c0 + unit) * output_h * output_w,
+                          dw_out[unit][prev_tile & 1], (prev_tile / tiles_w) * 4,
+                          (prev_tile % tiles_w) * 4, output_h, output_w);
+        }
+    }
+}
+
 // Benchmark different convolution implementations
 void benchmark_conv2d() {
     // Test parameters
-    const int INPUT_H = 16, INPUT_W = 16, CHANNELS = 8, NUM_FILTERS = 16;
-    const int KERNEL_H = 3, KERNEL_W = 3;
+    enum { INPUT_H = 16, INPUT_W = 16, CHANNELS = 8, NUM_FILTERS = 16 };
+    enum { KERNEL_H = 3, KERNEL_W = 3 };
     
     // Allocate test data
     static int8_t input[INPUT_H * INPUT_W * CHANNELS];
     static int8_t kernel[NUM_FILTERS * CHANNELS * KERNEL_H * KERNEL_W];
     static int16_t output_direct[NUM_FILTERS * (INPUT_H-2) * (INPUT_W-2)];
     static int16_t output_gemm[NUM_FILTERS * (INPUT_H-2) * (INPUT_W-2)];
+    static int16_t output_winograd[NUM_FILTERS * (INPUT_H-2) * (INPUT_W-2)];
     
     // Initialize test data
     for (int i = 0; i < INPUT_H * INPUT_W * CHANNELS; i++) {
@@ -221,34 +869,44 @@ void benchmark_conv2d() {
     
     uint32_t start_cycles, end_cycles;
     
-    // Test direct convolution
+    // Test direct convolution (the reference for the GPU paths)
+    host_region_begin("conv2d_direct");
     asm volatile ("rdcycle %0" : "=r"(start_cycles));
-    conv2d_direct(input, kernel, output_direct,
-                  INPUT_H, INPUT_W, KERNEL_H, KERNEL_W,
-                  1, 1, 0, 0); // stride=1, no padding
+    conv2d_direct_multichannel(input, kernel, output_direct,
+                               INPUT_H, INPUT_W, CHANNELS, NUM_FILTERS,
+                               KERNEL_H, KERNEL_W, 1, 1, 0, 0); // stride=1, no padding
     asm volatile ("rdcycle %0" : "=r"(end_cycles));
+    host_region_end();
     uint32_t direct_cycles = end_cycles - start_cycles;
     
     // Test GPU GEMM convolution
-    asm volatile ("rdcycle %0" : "=r"(start_cycles));
+    perf_counter_t gemm_perf;
+    host_region_begin("conv2d_gpu_gemm");
+    perf_start(&gemm_perf);
     conv2d_gpu_gemm(input, kernel, output_gemm,
                     INPUT_H, INPUT_W, CHANNELS, NUM_FILTERS,
                     KERNEL_H, KERNEL_W, 1, 1, 0, 0);
+    perf_end(&gemm_perf);
+    host_region_end();
+    uint32_t gemm_cycles = gemm_perf.end_cycles - gemm_perf.start_cycles;
+    
+    // Winograd path
+    host_region_begin("conv2d_3x3_optimized");
+    asm volatile ("rdcycle %0" : "=r"(start_cycles));
+    conv2d_3x3_optimized(input, kernel, output_winograd,
+                         INPUT_H, INPUT_W, CHANNELS, NUM_FILTERS);
     asm volatile ("rdcycle %0" : "=r"(end_cycles));
-    uint32_t gemm_cycles = end_cycles - start_cycles;
+    host_region_end();
+    uint32_t winograd_cycles = end_cycles - start_cycles;
     
-    // Verify results match (within tolerance for different algorithms)
-    int correct = 1;
-    int max_diff = 0;
+    // Both GPU paths are exact, so every output must match the reference
+    int gemm_errors = 0;
+    int winograd_errors = 0;
     int output_size = NUM_FILTERS * (INPUT_H-2) * (INPUT_W-2);
     
     for (int i = 0; i < output_size; i++) {
-        int diff = output_direct[i] - output_gemm[i];
-        if (diff < 0) diff = -diff;
-        if (diff > max_diff) max_diff = diff;
-        if (diff > 10) { // Allow small differences due to algorithm variations
-            correct = 0;
-        }
+        if (output_gemm[i] != output_direct[i]) gemm_errors++;
+        if (output_winograd[i] != output_direct[i]) winograd_errors++;
     }
     
     debug_printf("Conv2D Benchmark Results:\n");
@@ -256,13 +914,24 @@ void benchmark_conv2d() {
     debug_printf("Kernel size: %dx%d, Filters: %d\n", KERNEL_H, KERNEL_W, NUM_FILTERS);
     debug_printf("Direct cycles: %d\n", direct_cycles);
     debug_printf("GPU GEMM cycles: %d\n", gemm_cycles);
+    debug_printf("Winograd cycles: %d\n", winograd_cycles);
     debug_printf("Speedup: %dx\n", direct_cycles / gemm_cycles);
-    debug_printf("Max difference: %d\n", max_diff);
-    debug_printf("Results match: %s\n", correct ? "YES" : "NO");
+    debug_printf("GEMM mismatches: %d of %d\n", gemm_errors, output_size);
+    debug_printf("Winograd mismatches: %d of %d\n", winograd_errors, output_size);
+    debug_printf("Results match: %s\n", gemm_errors == 0 && winograd_errors == 0 ? "YES" : "NO");
     
     // Calculate throughput
     uint32_t total_ops = (uint32_t)NUM_FILTERS * (INPUT_H-2) * (INPUT_W-2) * 
                         CHANNELS * KERNEL_H * KERNEL_W;
     debug_printf("Total MAC operations: %d\n", total_ops);
     debug_printf("GPU MAC ops/cycle: %d\n", total_ops / gemm_cycles);
+    
+    // Per-level hit rates over the GEMM run (L2/L3 stay zero without the hierarchy)
+    for (int level = 0; level < GPU_CACHE_LEVELS; level++) {
+        uint32_t hits = gemm_perf.cache.hits[level];
+        uint32_t accesses = hits + gemm_perf.cache.misses[level];
+        debug_printf("L%d hit rate: %d%% (%d/%d)\n", level + 1,
+                     accesses ? (int)(hits * 100 / accesses) : 0, hits, accesses);
+    }
+    perf_report(&gemm_perf, "GPU GEMM conv2d");
 }
\ No newline at end of file
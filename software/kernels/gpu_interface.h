@@ -7,15 +7,96 @@
 #define GPU_INTERFACE_H
 
 #include <stdint.h>
+#include <stddef.h>
 
-// GPU Configuration
+// GPU Configuration (the kernels Makefile passes GPU_UNITS as NUM_GPU_UNITS)
+#ifndef NUM_GPU_UNITS
 #define NUM_GPU_UNITS 8
+#endif
+// gpu_fence takes a 32-bit unit mask
+_Static_assert(NUM_GPU_UNITS >= 1 && NUM_GPU_UNITS <= 32, "NUM_GPU_UNITS must be 1..32");
 #define GPU_MATRIX_SIZE 4  // 4x4 matrices
 
+// CPU harts the image runs on (the kernels Makefile passes CPU_HARTS)
+#ifndef NUM_HARTS
+#define NUM_HARTS 1
+#endif
+
 // Custom instruction opcodes
 #define GPU_MATMUL_OPCODE   0x0b  // custom-0
 #define GPU_STATUS_OPCODE   0x2b  // custom-1
 
+// Custom instruction function codes (funct3)
+#define GPU_FN_MATMUL       0x0   // custom-0: direct matmul setup
+#define GPU_FN_RING_BASE    0x2   // custom-0: set unit command ring base
+#define GPU_FN_DOORBELL     0x3   // custom-0: publish new ring head
+#define GPU_FN_STATUS       0x1   // custom-1: unit busy (incl. queued work)
+#define GPU_FN_RING_TAIL    0x2   // custom-1: descriptors retired by unit
+
+// CPU packed SIMD (custom-2): funct3 picks the lanes, funct7 the op
+#define SIMD_OPCODE         0x5b  // custom-2
+#define SIMD_W8             0x0   // 4x int8 per register
+#define SIMD_W16            0x1   // 2x int16 per register
+#define SIMD_FN_ADD         0x00  // Wrapping add
+#define SIMD_FN_SUB         0x01  // Wrapping subtract
+#define SIMD_FN_KADD        0x02  // Signed saturating add
+#define SIMD_FN_KSUB        0x03  // Signed saturating subtract
+#define SIMD_FN_MAX         0x04  // Signed max
+#define SIMD_FN_MIN         0x05  // Signed min
+#define SIMD_FN_SRA         0x06  // Arithmetic shift of every lane by b
+#define SIMD_FN_KMUL        0x07  // Signed saturating multiply
+#define SIMD_FN_NARROW      0x08  // SIMD_W16 only: 4x int16 (a, b) -> 4x sat int8
+
+// Command ring configuration
+#define GPU_RING_DEPTH      16    // Descriptors per unit (power of two)
+#define GPU_RING_INDEX_MASK 0xff  // Hardware head/tail counters are 8 bits
+
+// Descriptor config bits
+#define GPU_CFG_ACCUMULATE  (1u << 0) // Keep partial sums from the previous op
+#define GPU_CFG_DEFER_STORE (1u << 1) // Leave C on the unit (no write-back)
+#define GPU_CFG_ACC32       (1u << 2) // Write C back as int32 instead of int16
+#define GPU_CFG_PREC_SHIFT  3         // Operand precision field, 2 bits
+#define GPU_CFG_INT16       (1u << GPU_CFG_PREC_SHIFT) // A and B are 4x4 int16, 32 bytes each
+#define GPU_CFG_INT4        (2u << GPU_CFG_PREC_SHIFT) // 4x8 A and 8x4 B, two int4 per byte, 16 bytes each
+#define GPU_CFG_FP16        (3u << GPU_CFG_PREC_SHIFT) // A and B are 4x4 fp16, fp32 accumulate and C
+#define GPU_CFG_UNIT_PREC   (1u << 5) // Ignore the precision field, use UNIT_CONFIG's
+
+// GPU control block (memory mapped)
+#define GPU_CTRL_BASE          0x10000000
+#define GPU_PREFETCH_CTRL      0x10      // Cache stride prefetcher
+#define GPU_PF_ENABLE          (1u << 0)
+#define GPU_PF_DEGREE_SHIFT    4         // Lines fetched ahead, 4 bits
+#define GPU_CACHE_PARTITION    0x14      // L2/L3 ways reserved for GPU and CPU fills
+#define GPU_CACHE_STATS        0x20      // L1..L3 {hits, misses}, read only
+#define GPU_GPU_CACHE_STATS    0x38      // Same layout, GPU requests only
+#define GPU_CACHE_LEVELS       3
+#define GPU_BANK_CONFLICTS     0x50      // Requests held back by a busy L1 bank
+#define GPU_ARB_GRANTS         0x54      // GPU array fabric arbiter grants
+#define GPU_ARB_WAITS          0x58      // Unit-cycles spent waiting for a grant
+#define GPU_FABRIC_STALLS      0x5C      // Cycles the array waited for the fabric
+#define GPU_DMA_QUEUE          0x60      // W: start a descriptor chain, R: free queue entries
+#define GPU_DMA_STATUS         0x64      // [0] busy
+#define GPU_DMA_DONE           0x68      // Chains completed, read only
+#define GPU_UNIT_REG_BASE      0x100     // Per-unit register blocks
+#define GPU_UNIT_REG_SIZE      0x40
+#define GPU_UNIT_CONFIG_OFFSET 0x14      // Default config bits for the unit
+#define GPU_UNIT_PERF_OFFSET   0x18      // {busy, ops, stall, mem wait, MACs}, read only
+
+// Host interface (SYS_CTRL window, uncached): the testbench sees every store.
+// The linker script places the tohost/hostcon symbols here.
+#define HOST_BASE              0x20000000
+#define HOST_TOHOST            0x0       // (exit code << 1) | 1 ends the simulation
+#define HOST_PUTCHAR           0x4       // Low byte is printed by the testbench
+#define HOST_PROF_NAME         0x8       // Profiler region name, one byte per store
+#define HOST_PROF_CTRL         0xC       // 1 opens the named region, 0 closes the innermost
+#define HOST_CHECKPOINT        0x10      // Any store saves a +checkpoint_save snapshot
+
+// GPU scratchpad (TCM) next to the control block. GPU loads and stores here
+// bypass the L1 and complete in one cycle; the CPU side is word access only.
+#define GPU_SPAD_BASE          0x10010000
+#define GPU_SPAD_SIZE          0x10000   // 64KB
+#define GPU_SPAD_ALIGN         64        // Allocations start on a line
+
 // GPU unit status flags
 #define GPU_UNIT_IDLE       0x0
 #define GPU_UNIT_BUSY       0x1
@@ -27,6 +108,65 @@ void gpu_matrix_multiply_4x4(int8_t *a, int8_t *b, int16_t *c, int gpu_unit);
 void cpu_matrix_multiply_4x4(int8_t *a, int8_t *b, int16_t *c);
 void gpu_matrix_multiply_tiled(int8_t *a, int8_t *b, int16_t *c, 
                                int rows, int cols, int inner_dim);
+void gpu_matrix_multiply_tiled_os(int8_t *a, int8_t *b, int16_t *c,
+                                  int rows, int cols, int inner_dim);
+
+// Command descriptor fetched by a unit from its ring (16 bytes)
+typedef struct {
+    uint32_t a_addr;
+    uint32_t b_addr;
+    uint32_t c_addr;
+    uint32_t config;
+} gpu_cmd_t;
+
+// Per-unit command ring: head is owned by software, tail by the unit
+typedef struct {
+    gpu_cmd_t cmds[GPU_RING_DEPTH];
+    uint32_t head;
+} gpu_ring_t;
+
+// Asynchronous dispatch API
+void gpu_queue_init(void);
+uint32_t gpu_submit(int gpu_unit, const void *a, const void *b, void *c,
+                    uint32_t config);
+uint32_t gpu_submit_4x4(int8_t *a, int8_t *b, int16_t *c, int gpu_unit);
+int gpu_ticket_done(int gpu_unit, uint32_t ticket);
+void gpu_wait_ticket(int gpu_unit, uint32_t ticket);
+void gpu_fence(uint32_t unit_mask);
+
+// Scratchpad allocator: a bump pointer, released all at once by reset
+void gpu_spad_reset(void);
+void *gpu_spad_alloc(uint32_t bytes);
+void *gpu_spad_stage(const void *src, uint32_t bytes);
+
+// Tile DMA engine descriptor (32 bytes, word aligned). The engine reads it
+// from memory while the chain runs, so it must stay put until its ticket is
+// done. A copy moves rows x cols bytes, rounded up to words, between word
+// aligned rows; a tile gather reads a row-major int8 matrix at any alignment
+// and writes zero-padded 4x4 tiles in the gpu_pack_weights_4x4 layout.
+#define GPU_DMA_TILE        (1u << 0) // Flag: 4x4 tile gather
+
+typedef struct gpu_dma_desc {
+    uint32_t next;        // Next descriptor of the chain, 0 ends it
+    uint32_t src;
+    uint32_t dst;         // Word aligned
+    uint32_t src_stride;  // Bytes between source rows
+    uint16_t rows;
+    uint16_t cols;        // Bytes per row
+    uint32_t dst_stride;  // Bytes between destination rows, copies only
+    uint32_t flags;
+    uint32_t reserved;
+} gpu_dma_desc_t;
+
+// Only hart 0 may submit (gpu_dma_owned). Tickets complete in order.
+void gpu_dma_copy_desc(gpu_dma_desc_t *desc, void *dst, uint32_t dst_stride,
+                       const void *src, uint32_t src_stride, int rows, int row_bytes);
+void gpu_dma_tile_desc(gpu_dma_desc_t *desc, void *dst, const int8_t *src,
+                       uint32_t src_stride, int rows, int cols);
+uint32_t gpu_dma_submit(const gpu_dma_desc_t *chain);
+int gpu_dma_done(uint32_t ticket);
+void gpu_dma_wait(uint32_t ticket);
+int gpu_dma_copy_words(void *dst, const void *src, uint32_t words);
 
 // GPU control functions
 static inline uint32_t gpu_get_status(int unit) {
@@ -39,6 +179,144 @@ static inline uint32_t gpu_get_status(int unit) {
     return status;
 }
 
+static inline uint32_t gpu_get_ring_tail(int unit) {
+    uint32_t tail;
+    asm volatile (
+        ".insn r %1, %2, 0x0, %0, %3, x0"
+        : "=r"(tail)
+        : "i"(GPU_STATUS_OPCODE), "i"(GPU_FN_RING_TAIL), "r"(unit)
+    );
+    return tail;
+}
+
+static inline void gpu_ring_set_base(int unit, const gpu_ring_t *ring) {
+    asm volatile (
+        ".insn r %0, %1, 0x0, x0, %2, %3"
+        :
+        : "i"(GPU_MATMUL_OPCODE), "i"(GPU_FN_RING_BASE), "r"(unit), "r"(ring)
+        : "memory"
+    );
+}
+
+static inline void gpu_ring_doorbell(int unit, uint32_t head) {
+    // "memory" clobber keeps descriptor stores ahead of the doorbell
+    asm volatile (
+        ".insn r %0, %1, 0x0, x0, %2, %3"
+        :
+        : "i"(GPU_MATMUL_OPCODE), "i"(GPU_FN_DOORBELL), "r"(unit), "r"(head)
+        : "memory"
+    );
+}
+
+// UNIT_CONFIG is the config of direct starts; its GPU_CFG_ACC32 bit also
+// applies to ring commands, switching all of the unit's output to int32.
+// Its precision reaches ring commands only through GPU_CFG_UNIT_PREC.
+static inline void gpu_set_unit_config(int unit, uint32_t config) {
+    uintptr_t addr = GPU_CTRL_BASE + GPU_UNIT_REG_BASE + unit * GPU_UNIT_REG_SIZE +
+                     GPU_UNIT_CONFIG_OFFSET;
+    *(volatile uint32_t *)addr = config;
+}
+
+// Let GPU tile streams prefetch `degree` lines ahead once their stride repeats
+static inline void gpu_set_prefetch(int enable, uint32_t degree) {
+    uintptr_t addr = GPU_CTRL_BASE + GPU_PREFETCH_CTRL;
+    *(volatile uint32_t *)addr = (enable ? GPU_PF_ENABLE : 0) |
+                                 ((degree & 0xf) << GPU_PF_DEGREE_SHIFT);
+}
+
+// Reserve L2/L3 ways for GPU and CPU fills (the rest are shared). Each side
+// must keep at least one way; otherwise the partition is ignored.
+static inline void gpu_set_cache_partition(uint32_t l2_gpu, uint32_t l2_cpu,
+                                           uint32_t l3_gpu, uint32_t l3_cpu) {
+    uintptr_t addr = GPU_CTRL_BASE + GPU_CACHE_PARTITION;
+    *(volatile uint32_t *)addr = (l2_gpu & 0xf) | ((l2_cpu & 0xf) << 4) |
+                                 ((l3_gpu & 0x1f) << 8) | ((l3_cpu & 0x1f) << 16);
+}
+
+// Demand hit/miss counts per cache level, index 0 = L1. Without the cache
+// hierarchy only the L1 (the memory controller's cache) advances.
+typedef struct {
+    uint32_t hits[GPU_CACHE_LEVELS];
+    uint32_t misses[GPU_CACHE_LEVELS];
+} gpu_cache_stats_t;
+
+static inline void gpu_read_cache_stats_at(uint32_t offset, gpu_cache_stats_t *stats) {
+    uintptr_t addr = GPU_CTRL_BASE + offset;
+    volatile uint32_t *regs = (volatile uint32_t *)addr;
+    for (int level = 0; level < GPU_CACHE_LEVELS; level++) {
+        stats->hits[level] = regs[level * 2];
+        stats->misses[level] = regs[level * 2 + 1];
+    }
+}
+
+static inline void gpu_read_cache_stats(gpu_cache_stats_t *stats) {
+    gpu_read_cache_stats_at(GPU_CACHE_STATS, stats);
+}
+
+// Free-running per-unit counters. Stall cycles are busy cycles in which the
+// MAC array did no work; memory wait cycles have a load or store in flight.
+typedef struct {
+    uint32_t busy_cycles;
+    uint32_t ops;
+    uint32_t stall_cycles;
+    uint32_t mem_wait_cycles;
+    uint32_t macs;
+} gpu_unit_perf_t;
+
+static inline void gpu_read_unit_perf(int unit, gpu_unit_perf_t *perf) {
+    uintptr_t addr = GPU_CTRL_BASE + GPU_UNIT_REG_BASE + unit * GPU_UNIT_REG_SIZE +
+                     GPU_UNIT_PERF_OFFSET;
+    volatile uint32_t *regs = (volatile uint32_t *)addr;
+    perf->busy_cycles = regs[0];
+    perf->ops = regs[1];
+    perf->stall_cycles = regs[2];
+    perf->mem_wait_cycles = regs[3];
+    perf->macs = regs[4];
+}
+
+static inline uint32_t gpu_read_counter(uint32_t offset) {
+    uintptr_t addr = GPU_CTRL_BASE + offset;
+    return *(volatile uint32_t *)addr;
+}
+
+// Packed SIMD intrinsics. Lane 0 is the least significant, so a word loaded
+// from an int8/int16 array holds its elements in order.
+#define SIMD_INTRINSIC(name, width, fn)                                     \
+    static inline uint32_t name(uint32_t a, uint32_t b) {                   \
+        uint32_t result;                                                    \
+        asm (".insn r %1, %2, %3, %0, %4, %5"                               \
+             : "=r"(result)                                                 \
+             : "i"(SIMD_OPCODE), "i"(width), "i"(fn), "r"(a), "r"(b));      \
+        return result;                                                      \
+    }
+
+SIMD_INTRINSIC(simd_add8, SIMD_W8, SIMD_FN_ADD)
+SIMD_INTRINSIC(simd_sub8, SIMD_W8, SIMD_FN_SUB)
+SIMD_INTRINSIC(simd_kadd8, SIMD_W8, SIMD_FN_KADD)
+SIMD_INTRINSIC(simd_ksub8, SIMD_W8, SIMD_FN_KSUB)
+SIMD_INTRINSIC(simd_max8, SIMD_W8, SIMD_FN_MAX)
+SIMD_INTRINSIC(simd_min8, SIMD_W8, SIMD_FN_MIN)
+SIMD_INTRINSIC(simd_sra8, SIMD_W8, SIMD_FN_SRA)
+SIMD_INTRINSIC(simd_kmul8, SIMD_W8, SIMD_FN_KMUL)
+SIMD_INTRINSIC(simd_add16, SIMD_W16, SIMD_FN_ADD)
+SIMD_INTRINSIC(simd_sub16, SIMD_W16, SIMD_FN_SUB)
+SIMD_INTRINSIC(simd_kadd16, SIMD_W16, SIMD_FN_KADD)
+SIMD_INTRINSIC(simd_ksub16, SIMD_W16, SIMD_FN_KSUB)
+SIMD_INTRINSIC(simd_max16, SIMD_W16, SIMD_FN_MAX)
+SIMD_INTRINSIC(simd_min16, SIMD_W16, SIMD_FN_MIN)
+SIMD_INTRINSIC(simd_sra16, SIMD_W16, SIMD_FN_SRA)
+SIMD_INTRINSIC(simd_kmul16, SIMD_W16, SIMD_FN_KMUL)
+SIMD_INTRINSIC(simd_narrow16, SIMD_W16, SIMD_FN_NARROW)
+
+// Replicate a scalar into every lane
+static inline uint32_t simd_splat8(int8_t value) {
+    return (uint32_t)(uint8_t)value * 0x01010101u;
+}
+
+static inline uint32_t simd_splat16(int16_t value) {
+    return (uint32_t)(uint16_t)value * 0x00010001u;
+}
+
 static inline void gpu_wait_idle(int unit) {
     while (gpu_get_status(unit) != GPU_UNIT_IDLE) {
         // Busy wait
@@ -52,23 +330,81 @@ static inline void gpu_wait_all_idle(void) {
     }
 }
 
+// CPU cluster: hart 0 runs main, the other harts wait in cluster_worker
+static inline int hart_id(void) {
+    uint32_t id;
+    asm volatile ("csrr %0, mhartid" : "=r"(id));
+    return (int)id;
+}
+
+// There is one tile DMA engine and its tickets are hart 0's
+static inline int gpu_dma_owned(void) {
+    return NUM_HARTS == 1 || hart_id() == 0;
+}
+
+// A-extension AMO*.W through .insn so images still build for rv32i_zicsr.
+// Both return the old value.
+static inline int32_t amo_add(volatile int32_t *addr, int32_t value) {
+    int32_t old;
+    asm volatile (".insn r 0x2f, 0x2, 0x00, %0, %1, %2"
+                  : "=r"(old) : "r"(addr), "r"(value) : "memory");
+    return old;
+}
+
+static inline int32_t amo_swap(volatile int32_t *addr, int32_t value) {
+    int32_t old;
+    asm volatile (".insn r 0x2f, 0x2, 0x04, %0, %1, %2"
+                  : "=r"(old) : "r"(addr), "r"(value) : "memory");
+    return old;
+}
+
+// Run fn(ctx, hart) on every hart and return when all of them have. The
+// job's items 0..count-1 start out split evenly between per-hart queues;
+// fn takes items with cluster_next_item until it gets -1, which happens
+// once its own queue and every other hart's are empty.
+// On a cluster every hart, hart 0 included, has 16KB of stack before it
+// runs into the next hart's (startup.s HART_STACK_SHIFT), which fn and
+// main's call chain have to fit in.
+typedef void (*cluster_fn)(void *ctx, int hart);
+void cluster_run(int count, cluster_fn fn, void *ctx);
+int cluster_next_item(int hart);
+void cluster_worker(void) __attribute__((noreturn));
+
 // Debug and utility functions
 void debug_print(const char *str);
 void debug_printf(const char *format, ...);
 uint32_t get_cycle_count(void);
 void delay_cycles(uint32_t cycles);
+void host_exit(int code) __attribute__((noreturn));
+
+// Named regions for the testbench's stall-attribution profiler; they nest
+// and cost a few uncached stores, so keep them around whole kernels
+void host_region_begin(const char *name);
+void host_region_end(void);
+
+// Marks the end of boot and warm-up: a testbench run with +checkpoint_save
+// snapshots the simulation here so later runs can start from it
+void host_checkpoint(void);
 
 // Memory management helpers
 void* gpu_malloc(size_t size);
 void gpu_free(void* ptr);
 void gpu_memcpy(void* dest, const void* src, size_t n);
 
-// Performance monitoring
+// Performance monitoring. perf_start snapshots the counters and perf_end
+// turns every field except the cycle stamps into the delta since then.
 typedef struct {
     uint32_t start_cycles;
     uint32_t end_cycles;
-    uint32_t gpu_operations;
-    uint32_t cache_misses;
+    uint32_t gpu_operations;               // Summed over all units
+    uint32_t cache_misses;                 // L1 misses, all requesters
+    gpu_unit_perf_t unit[NUM_GPU_UNITS];
+    gpu_cache_stats_t cache;               // All requesters
+    gpu_cache_stats_t gpu_cache;           // GPU requests only
+    uint32_t bank_conflicts;
+    uint32_t arb_grants;
+    uint32_t arb_waits;
+    uint32_t fabric_stalls;
 } perf_counter_t;
 
 void perf_start(perf_counter_t* counter);
@@ -0,0 +1,209 @@
+/*
+ * GPU Command Queue for UnifiedRISCV
+ * Per-unit descriptor rings so kernels can keep every GPU unit busy,
+ * the allocator for the GPU scratchpad, and the tile DMA engine's queue
+ */
+
+#include "gpu_interface.h"
+
+// One ring per unit; the unit fetches descriptors from here on its own
+static gpu_ring_t gpu_rings[NUM_GPU_UNITS] __attribute__((aligned(64)));
+static int gpu_queue_ready = 0;
+
+// Number of descriptors queued on a unit that it has not retired yet
+static inline uint32_t gpu_ring_pending(int gpu_unit) {
+    return (gpu_rings[gpu_unit].head - gpu_get_ring_tail(gpu_unit)) & GPU_RING_INDEX_MASK;
+}
+
+void gpu_queue_init(void) {
+    for (int unit = 0; unit < NUM_GPU_UNITS; unit++) {
+        gpu_wait_idle(unit);
+        
+        // Resync with the hardware tail so a re-init never replays old slots
+        gpu_rings[unit].head = gpu_get_ring_tail(unit);
+        gpu_ring_set_base(unit, &gpu_rings[unit]);
+    }
+    gpu_queue_ready = 1;
+}
+
+// Queue a descriptor on a unit without waiting for it to run.
+// Returns a ticket that can be passed to gpu_wait_ticket().
+uint32_t gpu_submit(int gpu_unit, const void *a, const void *b, void *c,
+                    uint32_t config) {
+    if (!gpu_queue_ready) {
+        gpu_queue_init();
+    }
+    
+    gpu_ring_t *ring = &gpu_rings[gpu_unit];
+    
+    // Only blocks when the ring is full
+    while (gpu_ring_pending(gpu_unit) >= GPU_RING_DEPTH) {
+        asm volatile ("nop");
+    }
+    
+    uint32_t ticket = ring->head;
+    gpu_cmd_t *cmd = &ring->cmds[ticket & (GPU_RING_DEPTH - 1)];
+    cmd->a_addr = (uint32_t)(uintptr_t)a;
+    cmd->b_addr = (uint32_t)(uintptr_t)b;
+    cmd->c_addr = (uint32_t)(uintptr_t)c;
+    cmd->config = config;
+    
+    ring->head = (ticket + 1) & GPU_RING_INDEX_MASK;
+    gpu_ring_doorbell(gpu_unit, ring->head);
+    
+    return ticket;
+}
+
+uint32_t gpu_submit_4x4(int8_t *a, int8_t *b, int16_t *c, int gpu_unit) {
+    return gpu_submit(gpu_unit, a, b, c, 0);
+}
+
+int gpu_ticket_done(int gpu_unit, uint32_t ticket) {
+    uint32_t tail = gpu_get_ring_tail(gpu_unit);
+    uint32_t pending = (gpu_rings[gpu_unit].head - tail) & GPU_RING_INDEX_MASK;
+    
+    // A ticket is outstanding while it lies in [tail, head)
+    return ((ticket - tail) & GPU_RING_INDEX_MASK) >= pending;
+}
+
+void gpu_wait_ticket(int gpu_unit, uint32_t ticket) {
+    while (!gpu_ticket_done(gpu_unit, ticket)) {
+        asm volatile ("nop");
+    }
+}
+
+// Wait until every unit in unit_mask has drained its ring and gone idle
+void gpu_fence(uint32_t unit_mask) {
+    for (int unit = 0; unit < NUM_GPU_UNITS; unit++) {
+        if (unit_mask & (1u << unit)) {
+            gpu_wait_idle(unit);
+        }
+    }
+}
+
+static uint32_t gpu_spad_top = 0;
+
+void gpu_spad_reset(void) {
+    gpu_spad_top = 0;
+}
+
+// Returns 0 when the request does not fit in what is left of the scratchpad
+void *gpu_spad_alloc(uint32_t bytes) {
+    uint32_t offset = (gpu_spad_top + GPU_SPAD_ALIGN - 1) & ~(uint32_t)(GPU_SPAD_ALIGN - 1);
+    
+    if (bytes > GPU_SPAD_SIZE || offset > GPU_SPAD_SIZE - bytes) {
+        return 0;
+    }
+    gpu_spad_top = offset + bytes;
+    return (void *)(uintptr_t)(GPU_SPAD_BASE + offset);
+}
+
+// Copy a buffer into the scratchpad, rounded up to whole words since the
+// scratchpad has no byte writes. Returns the scratchpad copy, or 0.
+void *gpu_spad_stage(const void *src, uint32_t bytes) {
+    uint32_t words = (bytes + 3) / 4;
+    volatile uint32_t *dst = gpu_spad_alloc(words * 4);
+    const uint8_t *from = src;
+    uint32_t w = 0;
+    
+    if (!dst) {
+        return 0;
+    }
+    if (gpu_dma_copy_words((void *)dst, src, bytes / 4)) {
+        w = bytes / 4;
+    }
+    for (; w < words; w++) {
+        uint32_t word = 0;
+        for (uint32_t i = 0; i < 4 && w * 4 + i < bytes; i++) {
+            word |= (uint32_t)from[w * 4 + i] << (i * 8);
+        }
+        dst[w] = word;
+    }
+    return (void *)dst;
+}
+
+// Chains handed to the DMA engine so far; chain n is done once the engine's
+// completion counter passes n
+static uint32_t gpu_dma_issued = 0;
+
+void gpu_dma_copy_desc(gpu_dma_desc_t *desc, void *dst, uint32_t dst_stride,
+                       const void *src, uint32_t src_stride, int rows, int row_bytes) {
+    desc->next = 0;
+    desc->src = (uint32_t)(uintptr_t)src;
+    desc->dst = (uint32_t)(uintptr_t)dst;
+    desc->src_stride = src_stride;
+    desc->rows = (uint16_t)rows;
+    desc->cols = (uint16_t)row_bytes;
+    desc->dst_stride = dst_stride;
+    desc->flags = 0;
+    desc->reserved = 0;
+}
+
+void gpu_dma_tile_desc(gpu_dma_desc_t *desc, void *dst, const int8_t *src,
+                       uint32_t src_stride, int rows, int cols) {
+    gpu_dma_copy_desc(desc, dst, 0, src, src_stride, rows, cols);
+    desc->flags = GPU_DMA_TILE;
+}
+
+// Start a descriptor chain. Returns a ticket for gpu_dma_wait().
+uint32_t gpu_dma_submit(const gpu_dma_desc_t *chain) {
+    volatile uint32_t *queue = (volatile uint32_t *)(GPU_CTRL_BASE + GPU_DMA_QUEUE);
+    
+    // Only blocks when the engine already holds a full queue of chains
+    while (*queue == 0) {
+        asm volatile ("nop");
+    }
+    
+    // The descriptors are in memory before the engine hears of them
+    asm volatile ("" ::: "memory");
+    *queue = (uint32_t)(uintptr_t)chain;
+    return gpu_dma_issued++;
+}
+
+int gpu_dma_done(uint32_t ticket) {
+    return (int32_t)(gpu_read_counter(GPU_DMA_DONE) - ticket) > 0;
+}
+
+void gpu_dma_wait(uint32_t ticket) {
+    while (!gpu_dma_done(ticket)) {
+        asm volatile ("nop");
+    }
+    asm volatile ("" ::: "memory");
+}
+
+// Copy whole words with the DMA engine and wait for them. Returns 0, having
+// copied nothing, when the engine is not this hart's or either side is not
+// word aligned.
+int gpu_dma_copy_words(void *dst, const void *src, uint32_t words) {
+    gpu_dma_desc_t chain[2];
+    
+    if (!gpu_dma_owned() || (((uintptr_t)dst | (uintptr_t)src) & 3) != 0) {
+        return 0;
+    }
+    if (words == 0) {
+        return 1;
+    }
+    
+    // 4KB rows, then the remainder as one short row
+    gpu_dma_copy_desc(&chain[0], dst, 4096, src, 4096, (int)(words >> 10), 4096);
+    gpu_dma_copy_desc(&chain[1], (uint8_t *)dst + (words & ~1023u) * 4, 0,
+                      (const uint8_t *)src + (words & ~1023u) * 4, 0,
+                      1, (int)(words & 1023) * 4);
+    chain[0].next = (uint32_t)(uintptr_t)&chain[1];
+    gpu_dma_wait(gpu_dma_submit(chain));
+    return 1;
+}
+
+// Word-aligned bulk goes through the DMA engine, the tail a byte at a time
+void gpu_memcpy(void *dest, const void *src, size_t n) {
+    uint8_t *to = dest;
+    const uint8_t *from = src;
+    size_t done = 0;
+    
+    if (gpu_dma_copy_words(dest, src, (uint32_t)(n / 4))) {
+        done = n & ~(size_t)3;
+    }
+    for (; done < n; done++) {
+        to[done] = from[done];
+    }
+}
@@ -0,0 +1,267 @@
+/*
+ * Layer-graph executor for UnifiedRISCV
+ * Static arena planning over buffer lifetimes, and weight staging into
+ * the GPU scratchpad by the DMA engine while the previous layer runs
+ */
+
+#include "gpu_interface.h"
+#include "graph.h"
+
+static uint32_t graph_round(uint32_t bytes) {
+    return (bytes + GRAPH_ALIGN - 1) & ~(uint32_t)(GRAPH_ALIGN - 1);
+}
+
+static int graph_new_buffer(graph_t *graph, uint32_t bytes, int first, int last) {
+    graph_buffer_t *buffer = &graph->buffers[graph->num_buffers];
+    
+    buffer->bytes = graph_round(bytes);
+    buffer->offset = 0;
+    buffer->first = first;
+    buffer->last = last;
+    return graph->num_buffers++;
+}
+
+void graph_init(graph_t *graph, int channels, int height, int width) {
+    graph->num_layers = 0;
+    graph->num_buffers = 0;
+    graph->arena_bytes = 0;
+    graph->peak_live_bytes = 0;
+    graph->slot_bytes = 0;
+    
+    graph->tensors[0].channels = channels;
+    graph->tensors[0].height = height;
+    graph->tensors[0].width = width;
+    graph->tensors[0].buffer = graph_new_buffer(graph, channels * height * width, 0, 0);
+}
+
+int graph_add(graph_t *graph, const graph_layer_t *layer) {
+    int index = graph->num_layers;
+    const graph_tensor_t *in = &graph->tensors[index];
+    graph_tensor_t *out = &graph->tensors[index + 1];
+    int inputs = in->channels * in->height * in->width;
+    
+    if (index >= GRAPH_MAX_LAYERS) {
+        return -1;
+    }
+    
+    *out = *in;
+    graph->scratch[index] = -1;
+    graph->weight_bytes[index] = 0;
+    
+    switch (layer->op) {
+    case GRAPH_CONV:
+    case GRAPH_DEPTHWISE:
+        if (layer->op == GRAPH_CONV) {
+            out->channels = layer->out_channels;
+        }
+        out->height = (in->height + 2 * layer->pad - layer->kernel_h) / layer->stride + 1;
+        out->width = (in->width + 2 * layer->pad - layer->kernel_w) / layer->stride + 1;
+        break;
+    case GRAPH_GEMM:
+        out->channels = layer->out_channels;
+        out->height = 1;
+        out->width = 1;
+        break;
+    case GRAPH_RELU:
+        break;
+    }
+    if (out->channels <= 0 || out->height <= 0 || out->width <= 0) {
+        return -1;
+    }
+    
+    // Lifetimes are in layers: a layer's output lives from that layer until
+    // the next one reads it, and the result until the end
+    if (layer->op == GRAPH_RELU) {
+        graph->buffers[in->buffer].last = index + 1;
+    } else {
+        out->buffer = graph_new_buffer(graph, out->channels * out->height * out->width,
+                                       index, index + 1);
+    }
+    
+    if (layer->op == GRAPH_CONV) {
+        graph->weight_bytes[index] = gpu_packed_size_4x4(
+            layer->out_channels, in->channels * layer->kernel_h * layer->kernel_w);
+    } else if (layer->op == GRAPH_GEMM) {
+        graph->weight_bytes[index] = gpu_packed_size_4x4(layer->out_channels, inputs);
+    } else if (layer->op == GRAPH_DEPTHWISE) {
+        // int16 results ahead of the epilogue
+        graph->scratch[index] = graph_new_buffer(
+            graph, 2 * out->channels * out->height * out->width, index, index);
+    }
+    
+    graph->layers[index] = *layer;
+    graph->num_layers++;
+    return index;
+}
+
+static int graph_buffers_overlap(const graph_buffer_t *a, const graph_buffer_t *b) {
+    return a->first <= b->last && b->first <= a->last &&
+           a->offset < b->offset + b->bytes && b->offset < a->offset + a->bytes;
+}
+
+// Largest buffers first, each at the lowest offset clear of every placed
+// buffer it is live alongside
+uint32_t graph_plan(graph_t *graph) {
+    int order[GRAPH_MAX_BUFFERS];
+    int placed = 0;
+    
+    for (int i = 0; i < graph->num_buffers; i++) {
+        int j = i;
+        while (j > 0 && graph->buffers[order[j - 1]].bytes < graph->buffers[i].bytes) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+    
+    graph->arena_bytes = 0;
+    for (; placed < graph->num_buffers; placed++) {
+        graph_buffer_t *buffer = &graph->buffers[order[placed]];
+        int moved = 1;
+        
+        buffer->offset = 0;
+        while (moved) {
+            moved = 0;
+            for (int p = 0; p < placed; p++) {
+                const graph_buffer_t *other = &graph->buffers[order[p]];
+                if (graph_buffers_overlap(buffer, other)) {
+                    buffer->offset = other->offset + other->bytes;
+                    moved = 1;
+                }
+            }
+        }
+        if (buffer->offset + buffer->bytes > graph->arena_bytes) {
+            graph->arena_bytes = buffer->offset + buffer->bytes;
+        }
+    }
+    
+    // The lower bound the placement is measured against
+    graph->peak_live_bytes = 0;
+    for (int layer = 0; layer <= graph->num_layers; layer++) {
+        uint32_t live = 0;
+        for (int i = 0; i < graph->num_buffers; i++) {
+            if (graph->buffers[i].first <= layer && layer <= graph->buffers[i].last) {
+                live += graph->buffers[i].bytes;
+            }
+        }
+        if (live > graph->peak_live_bytes) {
+            graph->peak_live_bytes = live;
+        }
+    }
+    
+    // Two slots so one layer's weights load while the other's are in use
+    graph->slot_bytes = 0;
+    for (int i = 0; i < graph->num_layers; i++) {
+        uint32_t bytes = graph_round(graph->weight_bytes[i]);
+        if (bytes > graph->slot_bytes) {
+            graph->slot_bytes = bytes;
+        }
+    }
+    if (graph->slot_bytes > GPU_SPAD_SIZE / 2) {
+        graph->slot_bytes = GPU_SPAD_SIZE / 2;
+    }
+    return graph->arena_bytes;
+}
+
+int8_t *graph_tensor(const graph_t *graph, int8_t *arena, int index) {
+    return arena + graph->buffers[graph->tensors[index].buffer].offset;
+}
+
+// Start copying a layer's packed weights into a scratchpad slot. To the
+// engine the tiles are a (bytes / 4) x 4 matrix, so the gather hands them
+// over unchanged from any source alignment.
+static uint32_t graph_stage(gpu_dma_desc_t *desc, const int8_t *weights, uint32_t bytes,
+                            void *slot) {
+    gpu_dma_tile_desc(desc, slot, weights, 4, (int)(bytes / 4), 4);
+    return gpu_dma_submit(desc);
+}
+
+static void graph_run_layer(const graph_t *graph, int index, int8_t *arena,
+                            const int8_t *weights) {
+    const graph_layer_t *layer = &graph->layers[index];
+    const graph_tensor_t *in = &graph->tensors[index];
+    const graph_tensor_t *out = &graph->tensors[index + 1];
+    int8_t *input = graph_tensor(graph, arena, index);
+    int8_t *output = graph_tensor(graph, arena, index + 1);
+    
+    switch (layer->op) {
+    case GRAPH_CONV:
+        conv2d_gpu_gemm_packed_requant(input, weights, output, in->height, in->width,
+                                       in->channels, layer->out_channels,
+                                       layer->kernel_h, layer->kernel_w,
+                                       layer->stride, layer->stride, layer->pad, layer->pad,
+                                       &layer->requant);
+        break;
+    case GRAPH_DEPTHWISE: {
+        int16_t *acc = (int16_t *)(arena + graph->buffers[graph->scratch[index]].offset);
+        depthwise_conv2d_gpu(input, (int8_t *)layer->weights, acc, in->height, in->width,
+                             in->channels, layer->kernel_h, layer->kernel_w,
+                             layer->stride, layer->stride, layer->pad, layer->pad);
+        gpu_requant_int16(acc, output, out->channels, out->height * out->width,
+                          &layer->requant);
+        break;
+    }
+    case GRAPH_GEMM:
+        gpu_matrix_multiply_packed_a_requant(weights, input, output, layer->out_channels, 1,
+                                             in->channels * in->height * in->width,
+                                             &layer->requant);
+        break;
+    case GRAPH_RELU:
+        vector_relu_int8(input, output, in->channels * in->height * in->width);
+        break;
+    }
+}
+
+// Next layer at or after index with weights that fit a slot, or -1
+static int graph_next_staged(const graph_t *graph, int index) {
+    for (; index < graph->num_layers; index++) {
+        uint32_t bytes = graph->weight_bytes[index];
+        if (bytes && bytes <= graph->slot_bytes) {
+            return index;
+        }
+    }
+    return -1;
+}
+
+int graph_run(graph_t *graph, int8_t *arena, uint32_t arena_bytes) {
+    gpu_dma_desc_t stage;
+    uint32_t stage_ticket = 0;
+    void *slots[2] = { 0, 0 };
+    int slot = 0;
+    
+    if (arena_bytes < graph->arena_bytes) {
+        return -1;
+    }
+    
+    gpu_spad_reset();
+    if (graph->slot_bytes) {
+        slots[0] = gpu_spad_alloc(graph->slot_bytes);
+        slots[1] = gpu_spad_alloc(graph->slot_bytes);
+    }
+    
+    int staged = slots[1] ? graph_next_staged(graph, 0) : -1;
+    if (staged >= 0) {
+        stage_ticket = graph_stage(&stage, graph->layers[staged].weights,
+                                   graph->weight_bytes[staged], slots[slot]);
+    }
+    
+    for (int index = 0; index < graph->num_layers; index++) {
+        const int8_t *weights = graph->layers[index].weights;
+        
+        if (index == staged) {
+            gpu_dma_wait(stage_ticket);
+            weights = slots[slot];
+            slot ^= 1;
+            
+            // Streams in while this layer runs
+            staged = graph_next_staged(graph, index + 1);
+            if (staged >= 0) {
+                stage_ticket = graph_stage(&stage, graph->layers[staged].weights,
+                                           graph->weight_bytes[staged], slots[slot]);
+            }
+        }
+        
+        graph_run_layer(graph, index, arena, weights);
+    }
+    return 0;
+}
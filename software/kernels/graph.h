@@ -0,0 +1,86 @@
+/*
+ * Layer-graph executor for UnifiedRISCV
+ * Runs a chain of layers over the kernels in matrix_ops.h with int8 CHW
+ * activations. graph_plan places every activation and temporary in one
+ * caller-provided arena, sharing space between buffers whose lifetimes do
+ * not overlap; graph_run stages each layer's packed weights into the GPU
+ * scratchpad while the layer before it computes.
+ */
+
+#ifndef GRAPH_H
+#define GRAPH_H
+
+#include <stdint.h>
+#include "matrix_ops.h"
+
+#define GRAPH_MAX_LAYERS  32
+#define GRAPH_MAX_BUFFERS (2 * GRAPH_MAX_LAYERS + 1)
+#define GRAPH_ALIGN       64    // Arena offsets and sizes, in bytes
+
+typedef enum {
+    GRAPH_CONV,       // conv2d_gpu_gemm_packed_requant (1x1 stride 1 is a plain GEMM)
+    GRAPH_DEPTHWISE,  // depthwise_conv2d_gpu, then the epilogue on the CPU
+    GRAPH_GEMM,       // Fully connected over the whole input as one vector
+    GRAPH_RELU,       // In place
+} graph_op_t;
+
+typedef struct {
+    graph_op_t op;
+    int out_channels;        // Filters (conv) or output features (GEMM)
+    int kernel_h, kernel_w;  // Conv and depthwise
+    int stride, pad;         // Conv and depthwise, the same in both dimensions
+    // Conv and GEMM: the [out_channels x inputs per output] weights packed by
+    // gpu_pack_weights_4x4; depthwise: [channels][kernel_h][kernel_w]
+    const int8_t *weights;
+    gpu_requant_t requant;   // Back to int8; unused by ReLU
+} graph_layer_t;
+
+typedef struct {
+    int channels, height, width;
+    int buffer;              // Index into graph_t.buffers
+} graph_tensor_t;
+
+// Arena space live from layer first through layer last
+typedef struct {
+    uint32_t bytes;
+    uint32_t offset;
+    int first, last;
+} graph_buffer_t;
+
+typedef struct {
+    graph_layer_t layers[GRAPH_MAX_LAYERS];
+    int num_layers;
+    
+    // tensors[i] is the input of layer i; tensors[num_layers] is the result
+    graph_tensor_t tensors[GRAPH_MAX_LAYERS + 1];
+    int scratch[GRAPH_MAX_LAYERS];          // Per-layer temporary buffer, -1 for none
+    uint32_t weight_bytes[GRAPH_MAX_LAYERS]; // Bytes graph_run stages, 0 for none
+    graph_buffer_t buffers[GRAPH_MAX_BUFFERS];
+    int num_buffers;
+    
+    // Filled in by graph_plan
+    uint32_t arena_bytes;      // Size the arena must have
+    uint32_t peak_live_bytes;  // Most bytes live at any one layer
+    uint32_t slot_bytes;       // Each of the two scratchpad weight slots
+} graph_t;
+
+void graph_init(graph_t *graph, int channels, int height, int width);
+
+// Append a layer to the chain; returns its index, or -1 when the graph is
+// full or the layer leaves no output
+int graph_add(graph_t *graph, const graph_layer_t *layer);
+
+// Assign arena offsets and size the scratchpad weight slots; returns the
+// arena size in bytes
+uint32_t graph_plan(graph_t *graph);
+
+// A tensor inside a planned arena: 0 for the input, num_layers for the result
+int8_t *graph_tensor(const graph_t *graph, int8_t *arena, int index);
+
+// Run every layer once. The arena must be GRAPH_ALIGN aligned and hold at
+// least arena_bytes; the input is read from graph_tensor(graph, arena, 0).
+// Owns the scratchpad while it runs (gpu_spad_reset). Returns -1 when the
+// arena is too small.
+int graph_run(graph_t *graph, int8_t *arena, uint32_t arena_bytes);
+
+#endif // GRAPH_H
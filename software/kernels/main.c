@@ -0,0 +1,18 @@
+/*
+ * Benchmark image entry point for UnifiedRISCV
+ * Runs the kernel benchmarks; startup.s passes the return value to the
+ * testbench as the exit code
+ */
+
+#include "gpu_interface.h"
+#include "matrix_ops.h"
+
+int main(void) {
+    debug_print("UnifiedRISCV ML kernel benchmarks\n");
+    
+    benchmark_matrix_multiply();
+    benchmark_conv2d();
+    performance_test_large_matrix();
+    
+    return 0;
+}
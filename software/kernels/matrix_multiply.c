@@ -6,115 +6,673 @@
 #include "gpu_interface.h"
 #include "matrix_ops.h"
 
+// Staging tiles for one in-flight ring command. Kept per unit and per ring
+// slot so the CPU can gather the next k-step while earlier ones compute.
+// FP16 tiles are twice the size and reuse the whole slot; the
+// output-stationary kernel, the only one that runs them, has no use for c.
+typedef union {
+    struct {
+        int8_t a[16];
+        int8_t b[16];
+        int16_t c[16];
+    };
+    struct {
+        uint16_t a16[16];
+        uint16_t b16[16];
+    };
+} gpu_tile_slot_t;
+
+static gpu_tile_slot_t tile_slots[NUM_GPU_UNITS][GPU_RING_DEPTH] __attribute__((aligned(64)));
+
+// DMA gathers of one k-step's A and B tiles, chained across the units
+static gpu_dma_desc_t tile_dma[NUM_GPU_UNITS][2];
+
+// Final C tiles per unit for the output-stationary kernel, double-buffered
+// so one batch can drain while the next is queued. Sized for int32 results;
+// int16 results use the first half.
+static int32_t tile_out[NUM_GPU_UNITS][2][16] __attribute__((aligned(64)));
+
 // GPU matrix multiply using custom instructions
 void gpu_matrix_multiply_4x4(int8_t *a, int8_t *b, int16_t *c, int gpu_unit) {
-    // Use custom GPU instruction to perform 4x4 matrix multiply
-    // This maps to the GPU_MATMUL custom instruction in the CPU
-    
-    asm volatile (
-        "mv t0, %0\n"          // Load matrix A address
-        "mv t1, %1\n"          // Load matrix B address  
-        "mv t2, %2\n"          // Load matrix C address
-        "mv t3, %3\n"          // GPU unit number
-        
-        // Custom instruction: GPU matrix multiply setup
-        // Format: .insn r 0x0b, 0x0, 0x0, rd, rs1, rs2
-        ".insn r 0x0b, 0x0, 0x0, t2, t0, t1\n"
-        
-        // Wait for GPU unit to complete
-        "1:\n"
-        ".insn r 0x2b, 0x1, 0x0, t4, t3, x0\n"  // Check GPU status
-        "bnez t4, 1b\n"        // Loop while busy
-        
-        : // No output operands
-        : "r"(a), "r"(b), "r"(c), "r"(gpu_unit)
-        : "t0", "t1", "t2", "t3", "t4", "memory"
-    );
+    // Synchronous wrapper over the command ring: queue one descriptor on the
+    // unit and wait for it to retire
+    uint32_t ticket = gpu_submit_4x4(a, b, c, gpu_unit);
+    gpu_wait_ticket(gpu_unit, ticket);
 }
 
 // CPU-based matrix multiply for comparison
 void cpu_matrix_multiply_4x4(int8_t *a, int8_t *b, int16_t *c) {
     for (int i = 0; i < 4; i++) {
         for (int j = 0; j < 4; j++) {
-            int16_t sum = 0;
+            int32_t sum = 0;
             for (int k = 0; k < 4; k++) {
                 sum += a[i*4 + k] * b[k*4 + j];
             }
-            c[i*4 + j] = sum;
+            c[i*4 + j] = (int16_t)sum;
+        }
+    }
+}
+
+// Copy a 4x4 tile of A (zero padded at the edges)
+static void gather_tile_a(const int8_t *a, int8_t *tile, int row0, int k0,
+                          int rows, int inner_dim) {
+    for (int ii = 0; ii < 4; ii++) {
+        for (int kk = 0; kk < 4; kk++) {
+            int row = row0 + ii;
+            int col = k0 + kk;
+            if (row < rows && col < inner_dim) {
+                tile[ii * 4 + kk] = a[row * inner_dim + col];
+            } else {
+                tile[ii * 4 + kk] = 0;
+            }
+        }
+    }
+}
+
+// Copy a 4x4 tile of B (zero padded at the edges)
+static void gather_tile_b(const int8_t *b, int8_t *tile, int k0, int col0,
+                          int inner_dim, int cols) {
+    for (int kk = 0; kk < 4; kk++) {
+        for (int jj = 0; jj < 4; jj++) {
+            int row = k0 + kk;
+            int col = col0 + jj;
+            if (row < inner_dim && col < cols) {
+                tile[kk * 4 + jj] = b[row * cols + col];
+            } else {
+                tile[kk * 4 + jj] = 0;
+            }
+        }
+    }
+}
+
+// Copy a 4x8 tile of a packed INT4 A (zero padded at the edges); tile row
+// ii is word ii, element kk in its nibble kk
+static void gather_tile_a_int4(const uint8_t *a, int8_t *tile, int row0, int k0,
+                               int rows, int inner_dim) {
+    int stride = (inner_dim + 1) / 2;
+    for (int ii = 0; ii < 4; ii++) {
+        for (int kk = 0; kk < 8; kk += 2) {
+            int row = row0 + ii;
+            int col = k0 + kk;
+            uint8_t pair = 0;
+            if (row < rows && col < inner_dim) {
+                // k0 is even, so a tile byte is a source byte; a row with odd
+                // inner_dim ends in a pad nibble that must not leak in
+                pair = a[row * stride + col / 2];
+                if (col + 1 >= inner_dim) pair &= 0x0f;
+            }
+            tile[ii * 4 + kk / 2] = (int8_t)pair;
+        }
+    }
+}
+
+// Copy an 8x4 tile of a packed INT4 B (zero padded at the edges); tile row
+// kk is halfword kk, element jj in its nibble jj
+static void gather_tile_b_int4(const uint8_t *b, int8_t *tile, int k0, int col0,
+                               int inner_dim, int cols) {
+    int stride = (cols + 1) / 2;
+    for (int kk = 0; kk < 8; kk++) {
+        for (int jj = 0; jj < 4; jj += 2) {
+            int row = k0 + kk;
+            int col = col0 + jj;
+            uint8_t pair = 0;
+            if (row < inner_dim && col < cols) {
+                pair = b[row * stride + col / 2];
+                if (col + 1 >= cols) pair &= 0x0f;
+            }
+            tile[kk * 2 + jj / 2] = (int8_t)pair;
+        }
+    }
+}
+
+// Copy a 4x4 tile of FP16 A (zero padded at the edges)
+static void gather_tile_a_fp16(const uint16_t *a, uint16_t *tile, int row0, int k0,
+                               int rows, int inner_dim) {
+    for (int ii = 0; ii < 4; ii++) {
+        for (int kk = 0; kk < 4; kk++) {
+            int row = row0 + ii;
+            int col = k0 + kk;
+            tile[ii * 4 + kk] = (row < rows && col < inner_dim) ? a[row * inner_dim + col] : 0;
+        }
+    }
+}
+
+// Copy a 4x4 tile of FP16 B (zero padded at the edges)
+static void gather_tile_b_fp16(const uint16_t *b, uint16_t *tile, int k0, int col0,
+                               int inner_dim, int cols) {
+    for (int kk = 0; kk < 4; kk++) {
+        for (int jj = 0; jj < 4; jj++) {
+            int row = k0 + kk;
+            int col = col0 + jj;
+            tile[kk * 4 + jj] = (row < inner_dim && col < cols) ? b[row * cols + col] : 0;
+        }
+    }
+}
+
+// Add a finished 4x4 partial product into C
+static void accumulate_tile_c(int16_t *c, const int16_t *tile, int row0, int col0,
+                              int rows, int cols) {
+    for (int ii = 0; ii < 4; ii++) {
+        for (int jj = 0; jj < 4; jj++) {
+            int row = row0 + ii;
+            int col = col0 + jj;
+            if (row < rows && col < cols) {
+                c[row * cols + col] += tile[ii * 4 + jj];
+            }
         }
     }
 }
 
-// Large matrix multiply using tiled approach with GPU units
+// Large matrix multiply using tiled approach with GPU units. The DMA engine
+// gathers the tiles when it is this hart's (gpu_dma_owned); otherwise the
+// CPU copies them.
 void gpu_matrix_multiply_tiled(int8_t *a, int8_t *b, int16_t *c, 
                                int rows, int cols, int inner_dim) {
     // Tile size is 4x4 to match GPU compute unit capability
     const int TILE_SIZE = 4;
-    int num_gpu_units = 8;
-    int current_unit = 0;
+    int tiles_n = (cols + TILE_SIZE - 1) / TILE_SIZE;
+    int num_tiles = ((rows + TILE_SIZE - 1) / TILE_SIZE) * tiles_n;
+    int k_steps = (inner_dim + TILE_SIZE - 1) / TILE_SIZE;
+    int use_dma = gpu_dma_owned();
+    uint32_t tickets[NUM_GPU_UNITS][GPU_RING_DEPTH];
     
-    for (int i = 0; i < rows; i += TILE_SIZE) {
-        for (int j = 0; j < cols; j += TILE_SIZE) {
-            // Zero the output tile
+    // Each batch gives one output tile to every unit; all units run at once
+    for (int t0 = 0; t0 < num_tiles; t0 += NUM_GPU_UNITS) {
+        int batch = num_tiles - t0;
+        if (batch > NUM_GPU_UNITS) batch = NUM_GPU_UNITS;
+        
+        // Zero the output tiles
+        for (int unit = 0; unit < batch; unit++) {
+            int i = ((t0 + unit) / tiles_n) * TILE_SIZE;
+            int j = ((t0 + unit) % tiles_n) * TILE_SIZE;
             for (int ii = 0; ii < TILE_SIZE && (i + ii) < rows; ii++) {
                 for (int jj = 0; jj < TILE_SIZE && (j + jj) < cols; jj++) {
                     c[(i + ii) * cols + (j + jj)] = 0;
                 }
             }
+        }
+        
+        // Queue partial products; only wait when a staging slot is reused
+        for (int ks = 0; ks < k_steps; ks++) {
+            int slot = ks % GPU_RING_DEPTH;
+            int k = ks * TILE_SIZE;
+            int k_len = inner_dim - k < TILE_SIZE ? inner_dim - k : TILE_SIZE;
             
-            // Accumulate partial products
-            for (int k = 0; k < inner_dim; k += TILE_SIZE) {
-                // Extract 4x4 tiles
-                int8_t tile_a[16], tile_b[16];
-                int16_t tile_c[16] = {0};
+            // One chain gathers every unit's A and B tiles, zero padded;
+            // without the engine the CPU copies them, as gpu_memcpy does
+            for (int unit = 0; unit < batch; unit++) {
+                int i = ((t0 + unit) / tiles_n) * TILE_SIZE;
+                int j = ((t0 + unit) % tiles_n) * TILE_SIZE;
+                int i_len = rows - i < TILE_SIZE ? rows - i : TILE_SIZE;
+                int j_len = cols - j < TILE_SIZE ? cols - j : TILE_SIZE;
+                gpu_tile_slot_t *tile = &tile_slots[unit][slot];
+                gpu_dma_desc_t *desc = tile_dma[unit];
                 
-                // Copy A tile
-                for (int ii = 0; ii < TILE_SIZE; ii++) {
-                    for (int kk = 0; kk < TILE_SIZE; kk++) {
-                        int row = i + ii;
-                        int col = k + kk;
-                        if (row < rows && col < inner_dim) {
-                            tile_a[ii * TILE_SIZE + kk] = a[row * inner_dim + col];
-                        } else {
-                            tile_a[ii * TILE_SIZE + kk] = 0;
-                        }
-                    }
+                if (ks >= GPU_RING_DEPTH) {
+                    gpu_wait_ticket(unit, tickets[unit][slot]);
                 }
                 
-                // Copy B tile
-                for (int kk = 0; kk < TILE_SIZE; kk++) {
-                    for (int jj = 0; jj < TILE_SIZE; jj++) {
-                        int row = k + kk;
-                        int col = j + jj;
-                        if (row < inner_dim && col < cols) {
-                            tile_b[kk * TILE_SIZE + jj] = b[row * cols + col];
-                        } else {
-                            tile_b[kk * TILE_SIZE + jj] = 0;
-                        }
+                if (!use_dma) {
+                    if (ks >= GPU_RING_DEPTH) {
+                        accumulate_tile_c(c, tile->c, i, j, rows, cols);
                     }
+                    gather_tile_a(a, tile->a, i, k, rows, inner_dim);
+                    gather_tile_b(b, tile->b, k, j, inner_dim, cols);
+                    continue;
                 }
                 
-                // Perform tile multiplication using GPU
-                gpu_matrix_multiply_4x4(tile_a, tile_b, tile_c, current_unit);
+                gpu_dma_tile_desc(&desc[0], tile->a, a + i * inner_dim + k, inner_dim,
+                                  i_len, k_len);
+                gpu_dma_tile_desc(&desc[1], tile->b, b + k * cols + j, cols, k_len, j_len);
+                desc[0].next = (uint32_t)(uintptr_t)&desc[1];
+                desc[1].next = unit + 1 < batch ? (uint32_t)(uintptr_t)tile_dma[unit + 1] : 0;
+            }
+            
+            if (use_dma) {
+                uint32_t gathered = gpu_dma_submit(tile_dma[0]);
                 
-                // Accumulate results back to main matrix
-                for (int ii = 0; ii < TILE_SIZE; ii++) {
-                    for (int jj = 0; jj < TILE_SIZE; jj++) {
-                        int row = i + ii;
-                        int col = j + jj;
-                        if (row < rows && col < cols) {
-                            c[row * cols + col] += tile_c[ii * TILE_SIZE + jj];
-                        }
+                // Fold the slot's previous partial products into C while the
+                // tiles stream in
+                if (ks >= GPU_RING_DEPTH) {
+                    for (int unit = 0; unit < batch; unit++) {
+                        int i = ((t0 + unit) / tiles_n) * TILE_SIZE;
+                        int j = ((t0 + unit) % tiles_n) * TILE_SIZE;
+                        accumulate_tile_c(c, tile_slots[unit][slot].c, i, j, rows, cols);
                     }
                 }
                 
-                // Round-robin GPU unit assignment
-                current_unit = (current_unit + 1) % num_gpu_units;
+                gpu_dma_wait(gathered);
+            }
+            for (int unit = 0; unit < batch; unit++) {
+                gpu_tile_slot_t *tile = &tile_slots[unit][slot];
+                tickets[unit][slot] = gpu_submit_4x4(tile->a, tile->b, tile->c, unit);
+            }
+        }
+        
+        gpu_fence(batch >= 32 ? ~0u : (1u << batch) - 1);
+        
+        // Accumulate the results still sitting in staging slots
+        int live_slots = k_steps < GPU_RING_DEPTH ? k_steps : GPU_RING_DEPTH;
+        for (int unit = 0; unit < batch; unit++) {
+            int i = ((t0 + unit) / tiles_n) * TILE_SIZE;
+            int j = ((t0 + unit) % tiles_n) * TILE_SIZE;
+            for (int slot = 0; slot < live_slots; slot++) {
+                accumulate_tile_c(c, tile_slots[unit][slot].c, i, j, rows, cols);
+            }
+        }
+    }
+}
+
+// Write a finished 4x4 output tile into C
+static void store_tile_c(int16_t *c, const int16_t *tile, int row0, int col0,
+                         int rows, int cols) {
+    for (int ii = 0; ii < 4; ii++) {
+        for (int jj = 0; jj < 4; jj++) {
+            int row = row0 + ii;
+            int col = col0 + jj;
+            if (row < rows && col < cols) {
+                c[row * cols + col] = tile[ii * 4 + jj];
+            }
+        }
+    }
+}
+
+// Write a finished int32 4x4 output tile into C
+static void store_tile_c32(int32_t *c, const int32_t *tile, int row0, int col0,
+                           int rows, int cols) {
+    for (int ii = 0; ii < 4; ii++) {
+        for (int jj = 0; jj < 4; jj++) {
+            int row = row0 + ii;
+            int col = col0 + jj;
+            if (row < rows && col < cols) {
+                c[row * cols + col] = tile[ii * 4 + jj];
             }
         }
     }
 }
 
+// Write a finished fp32 4x4 output tile into C
+static void store_tile_f32(float *c, const float *tile, int row0, int col0,
+                           int rows, int cols) {
+    for (int ii = 0; ii < 4; ii++) {
+        for (int jj = 0; jj < 4; jj++) {
+            int row = row0 + ii;
+            int col = col0 + jj;
+            if (row < rows && col < cols) {
+                c[row * cols + col] = tile[ii * 4 + jj];
+            }
+        }
+    }
+}
+
+// Requantize one accumulator to int8: bias, fixed-point scale with
+// round-to-nearest, optional ReLU, saturate
+static inline int8_t requant_value(int32_t acc, int row, const gpu_requant_t *rq) {
+    if (rq->bias) acc += rq->bias[row];
+    
+    int64_t scaled = (int64_t)acc * rq->multiplier;
+    if (rq->shift > 0) {
+        scaled = (scaled + ((int64_t)1 << (rq->shift - 1))) >> rq->shift;
+    }
+    
+    int32_t lo = rq->relu ? 0 : -128;
+    if (scaled < lo) scaled = lo;
+    if (scaled > 127) scaled = 127;
+    return (int8_t)scaled;
+}
+
+// Write a finished 4x4 output tile into an int8 C through the epilogue
+static void store_tile_requant(int8_t *c, const int32_t *tile, int row0, int col0,
+                               int rows, int cols, const gpu_requant_t *rq) {
+    for (int ii = 0; ii < 4; ii++) {
+        for (int jj = 0; jj < 4; jj++) {
+            int row = row0 + ii;
+            int col = col0 + jj;
+            if (row < rows && col < cols) {
+                c[row * cols + col] = requant_value(tile[ii * 4 + jj], row, rq);
+            }
+        }
+    }
+}
+
+// Bytes needed to hold a rows x cols matrix as padded 4x4 tiles
+int gpu_packed_size_4x4(int rows, int cols) {
+    return ((rows + 3) / 4) * ((cols + 3) / 4) * 16;
+}
+
+// Lay a row-major int8 matrix out as contiguous 4x4 tiles in tile order
+// (row of tiles by row of tiles), zero padding partial edge tiles.
+// Tile (ti, tj) lands at packed + (ti * tiles_per_row + tj) * 16.
+void gpu_pack_weights_4x4(const int8_t *weights, int8_t *packed, int rows, int cols) {
+    int tiles_m = (rows + 3) / 4;
+    int tiles_n = (cols + 3) / 4;
+    
+    // The DMA engine's tile gather produces exactly this layout
+    if (gpu_dma_owned() && ((uintptr_t)packed & 3) == 0 && rows <= 0xffff && cols <= 0xffff) {
+        gpu_dma_desc_t desc;
+        gpu_dma_tile_desc(&desc, packed, weights, cols, rows, cols);
+        gpu_dma_wait(gpu_dma_submit(&desc));
+        return;
+    }
+    
+    for (int ti = 0; ti < tiles_m; ti++) {
+        for (int tj = 0; tj < tiles_n; tj++) {
+            int8_t *tile = packed + (ti * tiles_n + tj) * 16;
+            for (int ii = 0; ii < 4; ii++) {
+                for (int jj = 0; jj < 4; jj++) {
+                    int row = ti * 4 + ii;
+                    int col = tj * 4 + jj;
+                    if (row < rows && col < cols) {
+                        tile[ii * 4 + jj] = weights[row * cols + col];
+                    } else {
+                        tile[ii * 4 + jj] = 0;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Copy packed weights into the GPU scratchpad so their tile loads skip the
+// L1. Returns the original buffer when the scratchpad has no room left.
+const int8_t *gpu_stage_weights_4x4(const int8_t *packed, int rows, int cols) {
+    const int8_t *staged = gpu_spad_stage(packed, gpu_packed_size_4x4(rows, cols));
+    return staged ? staged : packed;
+}
+
+// Copy one batch of finished output tiles out of tile_out[.][buf] into C,
+// waiting per unit for the command that stores its tile. Tile t0 + u was
+// computed by unit unit0 + u.
+static void drain_tile_batch(const gpu_gemm_out_t *out, int unit0, int t0, int batch, int buf,
+                             const uint32_t *last_ticket, int tiles_n, int rows, int cols) {
+    for (int u = 0; u < batch; u++) {
+        int i = ((t0 + u) / tiles_n) * 4;
+        int j = ((t0 + u) % tiles_n) * 4;
+        const int32_t *tile_c = tile_out[unit0 + u][buf];
+        
+        gpu_wait_ticket(unit0 + u, last_ticket[u]);
+        
+        if (out->cf) {
+            store_tile_f32(out->cf, (const float *)tile_c, i, j, rows, cols);
+        } else if (out->requant) {
+            store_tile_requant(out->c_q, tile_c, i, j, rows, cols, out->requant);
+        } else if (out->c32) {
+            store_tile_c32(out->c32, tile_c, i, j, rows, cols);
+        } else {
+            store_tile_c(out->c, (const int16_t *)tile_c, i, j, rows, cols);
+        }
+    }
+}
+
+// Harts sharing one GEMM each drive their own GEMM_UNITS contiguous units,
+// so no ring or staging slot is ever touched by two harts; harts beyond
+// the unit count sit the GEMM out
+#define GEMM_HARTS (NUM_HARTS < NUM_GPU_UNITS ? NUM_HARTS : NUM_GPU_UNITS)
+#define GEMM_UNITS (NUM_GPU_UNITS / GEMM_HARTS)
+
+typedef struct {
+    const int8_t *a, *packed_a, *b, *packed_b;
+    gpu_gather_tile_fn gather_b;
+    const void *gather_ctx;
+    const gpu_gemm_out_t *out;
+    uint32_t prec;   // GPU_CFG_INT4/FP16, or 0 for INT8 with the operand forms above
+    int tile_k;      // K covered by one unit op
+    int rows, cols, inner_dim;
+    int tiles_n, k_steps, num_tiles;
+} gemm_os_job_t;
+
+// One hart's share of gpu_gemm_os. A work item is a batch of GEMM_UNITS
+// output tiles, one per unit of the hart.
+static void gpu_gemm_os_hart(void *ctx, int hart) {
+    const gemm_os_job_t *job = ctx;
+    const gpu_gemm_out_t *out = job->out;
+    const int TILE_SIZE = 4;
+    int rows = job->rows, cols = job->cols, inner_dim = job->inner_dim;
+    int tiles_n = job->tiles_n, k_steps = job->k_steps;
+    uint32_t prec = job->prec;
+    int unit0 = hart * GEMM_UNITS;
+    uint32_t tickets[GEMM_UNITS][GPU_RING_DEPTH];
+    uint32_t last_ticket[2][GEMM_UNITS];
+    uint32_t submitted[GEMM_UNITS];
+    int prev_t0 = -1;
+    int prev_batch = 0;
+    int buf = 0;
+    int item;
+    
+    // Requant reads the full-width accumulators so deep K cannot wrap
+    int wide = out->c32 || out->requant || out->cf;
+    
+    if (hart >= GEMM_HARTS) {
+        return;
+    }
+    for (int u = 0; u < GEMM_UNITS; u++) {
+        submitted[u] = 0;
+    }
+    
+    while ((item = cluster_next_item(hart)) >= 0) {
+        int t0 = item * GEMM_UNITS;
+        int batch = job->num_tiles - t0;
+        if (batch > GEMM_UNITS) batch = GEMM_UNITS;
+        
+        for (int ks = 0; ks < k_steps; ks++) {
+            int k = ks * job->tile_k;
+            
+            // First step clears the unit's C, later steps accumulate;
+            // only the last one writes the tile back
+            uint32_t config = (wide ? GPU_CFG_ACC32 : 0) | prec;
+            if (ks > 0) config |= GPU_CFG_ACCUMULATE;
+            if (ks < k_steps - 1) config |= GPU_CFG_DEFER_STORE;
+            
+            for (int u = 0; u < batch; u++) {
+                int unit = unit0 + u;
+                int ti = (t0 + u) / tiles_n;
+                int tj = (t0 + u) % tiles_n;
+                int i = ti * TILE_SIZE;
+                int j = tj * TILE_SIZE;
+                int slot = submitted[u] % GPU_RING_DEPTH;
+                gpu_tile_slot_t *tile = &tile_slots[unit][slot];
+                const int8_t *tile_a = tile->a;
+                const int8_t *tile_b = tile->b;
+                
+                // Staging slots are recycled across batches in ring order
+                if (submitted[u] >= GPU_RING_DEPTH) {
+                    gpu_wait_ticket(unit, tickets[u][slot]);
+                }
+                
+                if (prec == GPU_CFG_INT4) {
+                    gather_tile_a_int4((const uint8_t *)job->a, tile->a, i, k, rows, inner_dim);
+                    gather_tile_b_int4((const uint8_t *)job->b, tile->b, k, j, inner_dim, cols);
+                } else if (prec == GPU_CFG_FP16) {
+                    gather_tile_a_fp16((const uint16_t *)job->a, tile->a16, i, k, rows, inner_dim);
+                    gather_tile_b_fp16((const uint16_t *)job->b, tile->b16, k, j, inner_dim, cols);
+                    tile_a = (const int8_t *)tile->a16;
+                    tile_b = (const int8_t *)tile->b16;
+                } else if (job->packed_a) {
+                    tile_a = job->packed_a + (ti * k_steps + ks) * 16;
+                } else {
+                    gather_tile_a(job->a, tile->a, i, k, rows, inner_dim);
+                }
+                if (prec != 0) {
+                    // Both tiles gathered above
+                } else if (job->packed_b) {
+                    tile_b = job->packed_b + (ks * tiles_n + tj) * 16;
+                } else if (job->gather_b) {
+                    job->gather_b(job->gather_ctx, tile->b, k, j);
+                } else {
+                    gather_tile_b(job->b, tile->b, k, j, inner_dim, cols);
+                }
+                tickets[u][slot] = gpu_submit(unit, tile_a, tile_b,
+                                              tile_out[unit][buf], config);
+                last_ticket[buf][u] = tickets[u][slot];
+                submitted[u]++;
+            }
+        }
+        
+        // This batch is queued behind the previous one; drain the previous
+        // batch's tiles while the units work on the new one
+        if (prev_t0 >= 0) {
+            drain_tile_batch(out, unit0, prev_t0, prev_batch, buf ^ 1, last_ticket[buf ^ 1],
+                             tiles_n, rows, cols);
+        }
+        prev_t0 = t0;
+        prev_batch = batch;
+        buf ^= 1;
+    }
+    
+    if (prev_t0 >= 0) {
+        drain_tile_batch(out, unit0, prev_t0, prev_batch, buf ^ 1, last_ticket[buf ^ 1],
+                         tiles_n, rows, cols);
+    }
+}
+
+// Job setup shared by gpu_gemm_os and the low-precision variants
+static void gemm_os_run(gemm_os_job_t *job, uint32_t prec, const gpu_gemm_out_t *out,
+                        int rows, int cols, int inner_dim) {
+    const int TILE_SIZE = 4;
+    
+    job->out = out;
+    job->prec = prec;
+    job->tile_k = (prec == GPU_CFG_INT4) ? 2 * TILE_SIZE : TILE_SIZE;
+    job->rows = rows;
+    job->cols = cols;
+    job->inner_dim = inner_dim;
+    job->tiles_n = (cols + TILE_SIZE - 1) / TILE_SIZE;
+    job->k_steps = (inner_dim + job->tile_k - 1) / job->tile_k;
+    job->num_tiles = ((rows + TILE_SIZE - 1) / TILE_SIZE) * job->tiles_n;
+    
+    cluster_run((job->num_tiles + GEMM_UNITS - 1) / GEMM_UNITS, gpu_gemm_os_hart, job);
+}
+
+// Output-stationary tiled multiply: each unit keeps its C tile in registers
+// and accumulates the whole K dimension before writing C once. Either operand
+// may be pre-packed (gpu_pack_weights_4x4); packed tiles are handed to the
+// unit in place instead of being gathered. B tiles can also be produced by a
+// gather callback, so B never has to exist in memory as a whole. out selects
+// an int16, int32 or requantized int8 result (see gpu_gemm_out_t).
+// Batches are pipelined: batch n+1 is queued before batch n is drained, so
+// the units' double-buffered operands always have the next tile waiting.
+// On a cluster the batches are spread over the harts (cluster_run), each
+// gathering and draining the tiles of its own units.
+void gpu_gemm_os(const int8_t *a, const int8_t *packed_a,
+                 const int8_t *b, const int8_t *packed_b,
+                 gpu_gather_tile_fn gather_b, const void *gather_ctx,
+                 const gpu_gemm_out_t *out, int rows, int cols, int inner_dim) {
+    gemm_os_job_t job;
+    
+    job.a = a;
+    job.packed_a = packed_a;
+    job.b = b;
+    job.packed_b = packed_b;
+    job.gather_b = gather_b;
+    job.gather_ctx = gather_ctx;
+    gemm_os_run(&job, 0, out, rows, cols, inner_dim);
+}
+
+// Row-major low-precision operands only; see matrix_ops.h for the layouts
+static void gemm_os_low_precision(const void *a, const void *b, uint32_t prec,
+                                  const gpu_gemm_out_t *out, int rows, int cols, int inner_dim) {
+    gemm_os_job_t job;
+    
+    job.a = a;
+    job.packed_a = 0;
+    job.b = b;
+    job.packed_b = 0;
+    job.gather_b = 0;
+    job.gather_ctx = 0;
+    gemm_os_run(&job, prec, out, rows, cols, inner_dim);
+}
+
+void gpu_matrix_multiply_tiled_os(int8_t *a, int8_t *b, int16_t *c,
+                                  int rows, int cols, int inner_dim) {
+    gpu_gemm_out_t out = { c, 0, 0, 0, 0 };
+    gpu_gemm_os(a, 0, b, 0, 0, 0, &out, rows, cols, inner_dim);
+}
+
+// C = A * B with B pre-packed by gpu_pack_weights_4x4(b, packed_b, inner_dim, cols)
+void gpu_matrix_multiply_packed_b(int8_t *a, const int8_t *packed_b, int16_t *c,
+                                  int rows, int cols, int inner_dim) {
+    gpu_gemm_out_t out = { c, 0, 0, 0, 0 };
+    gpu_gemm_os(a, 0, 0, packed_b, 0, 0, &out, rows, cols, inner_dim);
+}
+
+// C = A * B with A pre-packed by gpu_pack_weights_4x4(a, packed_a, rows, inner_dim)
+void gpu_matrix_multiply_packed_a(const int8_t *packed_a, int8_t *b, int16_t *c,
+                                  int rows, int cols, int inner_dim) {
+    gpu_gemm_out_t out = { c, 0, 0, 0, 0 };
+    gpu_gemm_os(0, packed_a, b, 0, 0, 0, &out, rows, cols, inner_dim);
+}
+
+// C = A * B where B tiles are generated on demand by gather_b. A may be
+// row-major (a) or pre-packed (packed_a); pass 0 for the other.
+void gpu_matrix_multiply_gather_b(int8_t *a, const int8_t *packed_a,
+                                  gpu_gather_tile_fn gather_b, const void *gather_ctx,
+                                  int16_t *c, int rows, int cols, int inner_dim) {
+    gpu_gemm_out_t out = { c, 0, 0, 0, 0 };
+    gpu_gemm_os(a, packed_a, 0, 0, gather_b, gather_ctx, &out, rows, cols, inner_dim);
+}
+
+// Full-width C: the units accumulate and store int32, so any K is exact
+void gpu_matrix_multiply_tiled_int32(int8_t *a, int8_t *b, int32_t *c,
+                                     int rows, int cols, int inner_dim) {
+    gpu_gemm_out_t out = { 0, c, 0, 0, 0 };
+    gpu_gemm_os(a, 0, b, 0, 0, 0, &out, rows, cols, inner_dim);
+}
+
+// Fused-epilogue variants: C is int8, produced by requant from the
+// accumulators as each tile leaves the unit (bias is indexed by row of C)
+void gpu_matrix_multiply_requant(int8_t *a, int8_t *b, int8_t *c,
+                                 int rows, int cols, int inner_dim,
+                                 const gpu_requant_t *requant) {
+    gpu_gemm_out_t out = { 0, 0, c, requant, 0 };
+    gpu_gemm_os(a, 0, b, 0, 0, 0, &out, rows, cols, inner_dim);
+}
+
+void gpu_matrix_multiply_packed_a_requant(const int8_t *packed_a, int8_t *b, int8_t *c,
+                                          int rows, int cols, int inner_dim,
+                                          const gpu_requant_t *requant) {
+    gpu_gemm_out_t out = { 0, 0, c, requant, 0 };
+    gpu_gemm_os(0, packed_a, b, 0, 0, 0, &out, rows, cols, inner_dim);
+}
+
+void gpu_matrix_multiply_gather_b_requant(int8_t *a, const int8_t *packed_a,
+                                          gpu_gather_tile_fn gather_b, const void *gather_ctx,
+                                          int8_t *c, int rows, int cols, int inner_dim,
+                                          const gpu_requant_t *requant) {
+    gpu_gemm_out_t out = { 0, 0, c, requant, 0 };
+    gpu_gemm_os(a, packed_a, 0, 0, gather_b, gather_ctx, &out, rows, cols, inner_dim);
+}
+
+// INT4 x INT4 with int32 C; a unit op is a 4x8 by 8x4 step
+void gpu_matrix_multiply_int4(const uint8_t *a, const uint8_t *b, int32_t *c,
+                              int rows, int cols, int inner_dim) {
+    gpu_gemm_out_t out = { 0, c, 0, 0, 0 };
+    gemm_os_low_precision(a, b, GPU_CFG_INT4, &out, rows, cols, inner_dim);
+}
+
+void gpu_matrix_multiply_int4_requant(const uint8_t *a, const uint8_t *b, int8_t *c,
+                                      int rows, int cols, int inner_dim,
+                                      const gpu_requant_t *requant) {
+    gpu_gemm_out_t out = { 0, 0, c, requant, 0 };
+    gemm_os_low_precision(a, b, GPU_CFG_INT4, &out, rows, cols, inner_dim);
+}
+
+// FP16 x FP16 accumulated in fp32, k-steps in order
+void gpu_matrix_multiply_fp16(const uint16_t *a, const uint16_t *b, float *c,
+                              int rows, int cols, int inner_dim) {
+    gpu_gemm_out_t out = { 0, 0, 0, 0, c };
+    gemm_os_low_precision(a, b, GPU_CFG_FP16, &out, rows, cols, inner_dim);
+}
+
+// The same epilogue on the CPU for kernels that only produce int16 results
+void gpu_requant_int16(const int16_t *c, int8_t *c_q, int rows, int cols,
+                       const gpu_requant_t *requant) {
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            *c_q++ = requant_value(*c++, row, requant);
+        }
+    }
+}
+
 // Benchmark function
 void benchmark_matrix_multiply() {
     // Test data
@@ -135,19 +693,23 @@ void benchmark_matrix_multiply() {
     static int16_t result_gpu[16];
     static int16_t result_cpu[16];
     
-    // Get cycle counter (custom instruction)
     uint32_t start_cycles, end_cycles;
+    perf_counter_t gpu_perf;
     
     // GPU version
-    asm volatile ("rdcycle %0" : "=r"(start_cycles));
+    host_region_begin("gpu_matmul_4x4");
+    perf_start(&gpu_perf);
     gpu_matrix_multiply_4x4(test_a, test_b, result_gpu, 0);
-    asm volatile ("rdcycle %0" : "=r"(end_cycles));
-    uint32_t gpu_cycles = end_cycles - start_cycles;
+    perf_end(&gpu_perf);
+    host_region_end();
+    uint32_t gpu_cycles = gpu_perf.end_cycles - gpu_perf.start_cycles;
     
     // CPU version
+    host_region_begin("cpu_matmul_4x4");
     asm volatile ("rdcycle %0" : "=r"(start_cycles));
     cpu_matrix_multiply_4x4(test_a, test_b, result_cpu);
     asm volatile ("rdcycle %0" : "=r"(end_cycles));
+    host_region_end();
     uint32_t cpu_cycles = end_cycles - start_cycles;
     
     // Verify results match
@@ -170,11 +732,12 @@ void benchmark_matrix_multiply() {
     debug_printf("GPU cycles: %d\n", gpu_cycles);
     debug_printf("CPU cycles: %d\n", cpu_cycles);
     debug_printf("Speedup: %dx\n", cpu_cycles / gpu_cycles);
+    perf_report(&gpu_perf, "GPU 4x4 multiply");
 }
 
 // Performance test with larger matrices
 void performance_test_large_matrix() {
-    const int SIZE = 32; // 32x32 matrix
+    enum { SIZE = 32 }; // 32x32 matrix
     static int8_t large_a[SIZE * SIZE];
     static int8_t large_b[SIZE * SIZE];
     static int16_t large_c[SIZE * SIZE];
@@ -185,13 +748,15 @@ void performance_test_large_matrix() {
         large_b[i] = ((i * 7) % 256) - 128;
     }
     
-    uint32_t start_cycles, end_cycles;
+    perf_counter_t perf;
     
-    asm volatile ("rdcycle %0" : "=r"(start_cycles));
+    host_region_begin("gpu_matmul_tiled_32");
+    perf_start(&perf);
     gpu_matrix_multiply_tiled(large_a, large_b, large_c, SIZE, SIZE, SIZE);
-    asm volatile ("rdcycle %0" : "=r"(end_cycles));
+    perf_end(&perf);
+    host_region_end();
     
-    uint32_t total_cycles = end_cycles - start_cycles;
+    uint32_t total_cycles = perf.end_cycles - perf.start_cycles;
     
     // Calculate performance metrics
     uint32_t total_ops = (uint32_t)SIZE * SIZE * SIZE; // MAC operations
@@ -207,4 +772,5 @@ void performance_test_large_matrix() {
     debug_printf("Theoretical TOPS @ 100MHz: %d.%03d\n", 
                  (ops_per_cycle * 100) / 1000, 
                  (ops_per_cycle * 100) % 1000);
+    perf_report(&perf, "Large matrix multiply");
 }
\ No newline at end of file
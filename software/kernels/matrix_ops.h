@@ -13,30 +13,172 @@ void gpu_matrix_multiply_4x4(int8_t *a, int8_t *b, int16_t *c, int gpu_unit);
 void cpu_matrix_multiply_4x4(int8_t *a, int8_t *b, int16_t *c);
 void gpu_matrix_multiply_tiled(int8_t *a, int8_t *b, int16_t *c, 
                                int rows, int cols, int inner_dim);
+void gpu_matrix_multiply_tiled_os(int8_t *a, int8_t *b, int16_t *c,
+                                  int rows, int cols, int inner_dim);
+void gpu_matrix_multiply_tiled_int32(int8_t *a, int8_t *b, int32_t *c,
+                                     int rows, int cols, int inner_dim);
+
+// Pre-packed weights: contiguous zero-padded 4x4 tiles in tile order
+int gpu_packed_size_4x4(int rows, int cols);
+void gpu_pack_weights_4x4(const int8_t *weights, int8_t *packed, int rows, int cols);
+const int8_t *gpu_stage_weights_4x4(const int8_t *packed, int rows, int cols);
+void gpu_matrix_multiply_packed_a(const int8_t *packed_a, int8_t *b, int16_t *c,
+                                  int rows, int cols, int inner_dim);
+void gpu_matrix_multiply_packed_b(int8_t *a, const int8_t *packed_b, int16_t *c,
+                                  int rows, int cols, int inner_dim);
+
+// Fills a zero-padded 4x4 B tile covering rows k0..k0+3, cols col0..col0+3
+typedef void (*gpu_gather_tile_fn)(const void *ctx, int8_t *tile, int k0, int col0);
+void gpu_matrix_multiply_gather_b(int8_t *a, const int8_t *packed_a,
+                                  gpu_gather_tile_fn gather_b, const void *gather_ctx,
+                                  int16_t *c, int rows, int cols, int inner_dim);
+
+// Fused int8 epilogue: out = sat8(((acc + bias[row]) * multiplier) >> shift),
+// rounded to nearest, clamped at zero when relu is set
+typedef struct {
+    const int32_t *bias;  // Per output row / filter, 0 for none
+    int32_t multiplier;   // Fixed-point scale
+    int shift;            // Right shift applied after the multiply
+    int relu;             // Non-zero fuses ReLU into the clamp
+} gpu_requant_t;
+
+void gpu_matrix_multiply_requant(int8_t *a, int8_t *b, int8_t *c,
+                                 int rows, int cols, int inner_dim,
+                                 const gpu_requant_t *requant);
+void gpu_matrix_multiply_packed_a_requant(const int8_t *packed_a, int8_t *b, int8_t *c,
+                                          int rows, int cols, int inner_dim,
+                                          const gpu_requant_t *requant);
+void gpu_matrix_multiply_gather_b_requant(int8_t *a, const int8_t *packed_a,
+                                          gpu_gather_tile_fn gather_b, const void *gather_ctx,
+                                          int8_t *c, int rows, int cols, int inner_dim,
+                                          const gpu_requant_t *requant);
+void gpu_requant_int16(const int16_t *c, int8_t *c_q, int rows, int cols,
+                       const gpu_requant_t *requant);
+
+// Result of gpu_gemm_os: exactly one of c (int16), c32 (int32),
+// c_q + requant (int8 through the fused epilogue) or cf (FP16 GEMMs only)
+typedef struct {
+    int16_t *c;
+    int32_t *c32;
+    int8_t *c_q;
+    const gpu_requant_t *requant;
+    float *cf;
+} gpu_gemm_out_t;
+
+// Generic output-stationary GEMM behind the wrappers above. Pass 0 for
+// the operand forms that are not used.
+void gpu_gemm_os(const int8_t *a, const int8_t *packed_a,
+                 const int8_t *b, const int8_t *packed_b,
+                 gpu_gather_tile_fn gather_b, const void *gather_ctx,
+                 const gpu_gemm_out_t *out, int rows, int cols, int inner_dim);
+
+// Low-precision GEMMs on the same output-stationary path. INT4 matrices are
+// row-major with two values per byte, low nibble first, and each row padded
+// to a whole byte ((cols + 1) / 2 bytes per row); a unit op covers K=8, so
+// every operand byte fetched feeds twice the MACs of INT8. FP16 operands are
+// IEEE half bits, accumulated and returned in fp32.
+void gpu_matrix_multiply_int4(const uint8_t *a, const uint8_t *b, int32_t *c,
+                              int rows, int cols, int inner_dim);
+void gpu_matrix_multiply_int4_requant(const uint8_t *a, const uint8_t *b, int8_t *c,
+                                      int rows, int cols, int inner_dim,
+                                      const gpu_requant_t *requant);
+void gpu_matrix_multiply_fp16(const uint16_t *a, const uint16_t *b, float *c,
+                              int rows, int cols, int inner_dim);
 
 // Convolution operations
 void conv2d_direct(int8_t *input, int8_t *kernel, int16_t *output,
                    int input_h, int input_w, int kernel_h, int kernel_w,
                    int stride_h, int stride_w, int pad_h, int pad_w);
 
+void conv2d_direct_multichannel(int8_t *input, int8_t *kernel, int16_t *output,
+                                int input_h, int input_w, int channels,
+                                int num_filters, int kernel_h, int kernel_w,
+                                int stride_h, int stride_w, int pad_h, int pad_w);
+
 void conv2d_gpu_gemm(int8_t *input, int8_t *kernel, int16_t *output,
                      int input_h, int input_w, int channels,
                      int num_filters, int kernel_h, int kernel_w,
                      int stride_h, int stride_w, int pad_h, int pad_w);
 
+void conv2d_gpu_gemm_int32(int8_t *input, int8_t *kernel, int32_t *output,
+                           int input_h, int input_w, int channels,
+                           int num_filters, int kernel_h, int kernel_w,
+                           int stride_h, int stride_w, int pad_h, int pad_w);
+
 void conv2d_3x3_optimized(int8_t *input, int8_t *kernel, int16_t *output,
                           int input_h, int input_w, int channels, int num_filters);
 
+void conv2d_gpu_implicit_gemm(int8_t *input, int8_t *kernel, int16_t *output,
+                              int input_h, int input_w, int channels,
+                              int num_filters, int kernel_h, int kernel_w,
+                              int stride_h, int stride_w, int pad_h, int pad_w);
+
+void conv2d_gpu_gemm_packed(int8_t *input, const int8_t *packed_kernel, int16_t *output,
+                            int input_h, int input_w, int channels,
+                            int num_filters, int kernel_h, int kernel_w,
+                            int stride_h, int stride_w, int pad_h, int pad_w);
+
+// Conv + bias + requantize (+ ReLU) in one pass, int8 activations out
+void conv2d_gpu_gemm_requant(int8_t *input, int8_t *kernel, int8_t *output,
+                             int input_h, int input_w, int channels,
+                             int num_filters, int kernel_h, int kernel_w,
+                             int stride_h, int stride_w, int pad_h, int pad_w,
+                             const gpu_requant_t *requant);
+
+void conv2d_gpu_gemm_packed_requant(int8_t *input, const int8_t *packed_kernel, int8_t *output,
+                                    int input_h, int input_w, int channels,
+                                    int num_filters, int kernel_h, int kernel_w,
+                                    int stride_h, int stride_w, int pad_h, int pad_w,
+                                    const gpu_requant_t *requant);
+
+void gpu_pack_conv3x3_weights(const int8_t *kernel, int8_t *packed,
+                              int channels, int num_filters);
+
+void conv2d_3x3_packed(int8_t *input, const int8_t *packed_kernel, int16_t *output,
+                       int input_h, int input_w, int channels, int num_filters);
+
+// Winograd F(2x2,3x3) with weights transformed once by
+// gpu_winograd_conv3x3_weights into WINOGRAD_3X3_WEIGHTS int16 values
+#define WINOGRAD_3X3_WEIGHTS(channels, num_filters) \
+    (256 * (((channels) + 3) / 4) * (((num_filters) + 3) / 4))
+
+void gpu_winograd_conv3x3_weights(const int8_t *kernel, int16_t *transformed,
+                                  int channels, int num_filters);
+
+void conv2d_3x3_winograd(int8_t *input, const int16_t *transformed_kernel, int16_t *output,
+                         int input_h, int input_w, int channels, int num_filters);
+
 void depthwise_conv2d(int8_t *input, int8_t *depthwise_kernel, int16_t *output,
                      int input_h, int input_w, int channels,
                      int kernel_h, int kernel_w,
                      int stride_h, int stride_w, int pad_h, int pad_w);
 
-// Vector operations
+// Depthwise on the GPU units, one channel per unit; kernels whose
+// kernel_h * (3 * stride_w + kernel_w) exceeds 64 run on the CPU
+void depthwise_conv2d_gpu(int8_t *input, int8_t *depthwise_kernel, int16_t *output,
+                          int input_h, int input_w, int channels,
+                          int kernel_h, int kernel_w,
+                          int stride_h, int stride_w, int pad_h, int pad_w);
+
+// Pointwise (1x1, stride 1) convolution as a direct GEMM on the CHW input
+void conv2d_1x1_gpu(int8_t *input, int8_t *kernel, int16_t *output,
+                    int input_h, int input_w, int channels, int num_filters);
+
+// Weights packed by gpu_pack_weights_4x4(kernel, packed_kernel, num_filters, channels)
+void conv2d_1x1_gpu_packed(int8_t *input, const int8_t *packed_kernel, int16_t *output,
+                           int input_h, int input_w, int channels, int num_filters);
+
+void conv2d_1x1_gpu_requant(int8_t *input, const int8_t *packed_kernel, int8_t *output,
+                            int input_h, int input_w, int channels, int num_filters,
+                            const gpu_requant_t *requant);
+
+// Vector operations (CPU packed SIMD; adds and scaling saturate)
 void vector_add_int8(int8_t *a, int8_t *b, int8_t *c, int length);
 void vector_add_int16(int16_t *a, int16_t *b, int16_t *c, int length);
 void vector_scale_int8(int8_t *input, int8_t scale, int8_t *output, int length);
 void vector_relu_int8(int8_t *input, int8_t *output, int length);
+// out = sat8((in + rounding) >> shift), for int16 GEMM results (shift 0..15)
+void vector_requant_int16(const int16_t *input, int8_t *output, int shift, int length);
 
 // Utility functions
 void im2col(int8_t *input, int8_t *output,
@@ -0,0 +1,93 @@
+/*
+ * Performance counter snapshots for UnifiedRISCV
+ * Reads the GPU control block's free-running counters around a region of
+ * interest. All counters are 32 bits and wrap, so deltas stay correct for
+ * regions shorter than 2^32 cycles.
+ */
+
+#include "gpu_interface.h"
+
+static void perf_sample(perf_counter_t *counter) {
+    counter->gpu_operations = 0;
+    for (int unit = 0; unit < NUM_GPU_UNITS; unit++) {
+        gpu_read_unit_perf(unit, &counter->unit[unit]);
+        counter->gpu_operations += counter->unit[unit].ops;
+    }
+    gpu_read_cache_stats(&counter->cache);
+    gpu_read_cache_stats_at(GPU_GPU_CACHE_STATS, &counter->gpu_cache);
+    counter->cache_misses = counter->cache.misses[0];
+    counter->bank_conflicts = gpu_read_counter(GPU_BANK_CONFLICTS);
+    counter->arb_grants = gpu_read_counter(GPU_ARB_GRANTS);
+    counter->arb_waits = gpu_read_counter(GPU_ARB_WAITS);
+    counter->fabric_stalls = gpu_read_counter(GPU_FABRIC_STALLS);
+}
+
+void perf_start(perf_counter_t *counter) {
+    perf_sample(counter);
+    counter->end_cycles = 0;
+    counter->start_cycles = get_cycle_count();
+}
+
+void perf_end(perf_counter_t *counter) {
+    perf_counter_t now;
+    
+    // Stamp first so the counter reads are not charged to the region
+    counter->end_cycles = get_cycle_count();
+    perf_sample(&now);
+    
+    counter->gpu_operations = now.gpu_operations - counter->gpu_operations;
+    counter->cache_misses = now.cache_misses - counter->cache_misses;
+    for (int unit = 0; unit < NUM_GPU_UNITS; unit++) {
+        gpu_unit_perf_t *u = &counter->unit[unit];
+        u->busy_cycles = now.unit[unit].busy_cycles - u->busy_cycles;
+        u->ops = now.unit[unit].ops - u->ops;
+        u->stall_cycles = now.unit[unit].stall_cycles - u->stall_cycles;
+        u->mem_wait_cycles = now.unit[unit].mem_wait_cycles - u->mem_wait_cycles;
+        u->macs = now.unit[unit].macs - u->macs;
+    }
+    for (int level = 0; level < GPU_CACHE_LEVELS; level++) {
+        counter->cache.hits[level] = now.cache.hits[level] - counter->cache.hits[level];
+        counter->cache.misses[level] = now.cache.misses[level] - counter->cache.misses[level];
+        counter->gpu_cache.hits[level] = now.gpu_cache.hits[level] - counter->gpu_cache.hits[level];
+        counter->gpu_cache.misses[level] = now.gpu_cache.misses[level] -
+                                           counter->gpu_cache.misses[level];
+    }
+    counter->bank_conflicts = now.bank_conflicts - counter->bank_conflicts;
+    counter->arb_grants = now.arb_grants - counter->arb_grants;
+    counter->arb_waits = now.arb_waits - counter->arb_waits;
+    counter->fabric_stalls = now.fabric_stalls - counter->fabric_stalls;
+}
+
+void perf_report(const perf_counter_t *counter, const char *test_name) {
+    uint32_t busy = 0, stall = 0, mem_wait = 0, macs = 0;
+    
+    debug_printf("%s: %u cycles, %u GPU ops\n", test_name,
+                 counter->end_cycles - counter->start_cycles, counter->gpu_operations);
+    
+    // Idle units are left out
+    for (int unit = 0; unit < NUM_GPU_UNITS; unit++) {
+        const gpu_unit_perf_t *u = &counter->unit[unit];
+        if (u->busy_cycles == 0) continue;
+        debug_printf("  unit %d: busy %u, stall %u, mem wait %u, MACs %u, ops %u\n",
+                     unit, u->busy_cycles, u->stall_cycles, u->mem_wait_cycles,
+                     u->macs, u->ops);
+        busy += u->busy_cycles;
+        stall += u->stall_cycles;
+        mem_wait += u->mem_wait_cycles;
+        macs += u->macs;
+    }
+    if (busy) {
+        debug_printf("  GPU total: busy %u, stall %u (%u%%), mem wait %u, MACs %u\n",
+                     busy, stall, (uint32_t)((uint64_t)stall * 100 / busy), mem_wait, macs);
+    }
+    
+    for (int level = 0; level < GPU_CACHE_LEVELS; level++) {
+        if (counter->cache.hits[level] == 0 && counter->cache.misses[level] == 0) continue;
+        debug_printf("  L%d: %u hits, %u misses (GPU %u hits, %u misses)\n", level + 1,
+                     counter->cache.hits[level], counter->cache.misses[level],
+                     counter->gpu_cache.hits[level], counter->gpu_cache.misses[level]);
+    }
+    debug_printf("  bank conflicts %u, arbiter grants %u, arbiter waits %u, fabric stalls %u\n",
+                 counter->bank_conflicts, counter->arb_grants, counter->arb_waits,
+                 counter->fabric_stalls);
+}
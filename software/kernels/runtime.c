@@ -0,0 +1,156 @@
+/*
+ * Bare-metal runtime for UnifiedRISCV
+ * Console output, exit, profiler regions and checkpoints through the
+ * testbench host interface, cycle counters, and the memset/memcpy that GCC
+ * may emit calls to even with -fno-builtin
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include "gpu_interface.h"
+
+// Defined by linker.ld inside the host window
+extern volatile uint32_t tohost;
+extern volatile uint32_t hostcon;
+extern volatile uint32_t hostprof[2];
+extern volatile uint32_t hostckpt;
+
+void host_exit(int code) {
+    tohost = ((uint32_t)code << 1) | 1;
+    for (;;) {
+        asm volatile ("ecall");
+    }
+}
+
+void host_region_begin(const char *name) {
+    while (*name) {
+        hostprof[0] = (uint8_t)*name++;
+    }
+    hostprof[1] = 1;
+}
+
+void host_region_end(void) {
+    hostprof[1] = 0;
+}
+
+void host_checkpoint(void) {
+    hostckpt = 1;
+}
+
+static void debug_putc(char c) {
+    hostcon = (uint8_t)c;
+}
+
+void debug_print(const char *str) {
+    while (*str) {
+        debug_putc(*str++);
+    }
+}
+
+static void debug_print_uint(uint32_t value, uint32_t base, int width, char pad) {
+    char digits[10];
+    int n = 0;
+    
+    do {
+        uint32_t d = value % base;
+        digits[n++] = d < 10 ? '0' + d : 'a' + d - 10;
+        value /= base;
+    } while (value);
+    for (int i = n; i < width; i++) {
+        debug_putc(pad);
+    }
+    while (n) {
+        debug_putc(digits[--n]);
+    }
+}
+
+// Supports %d %u %x %c %s %% with an optional zero-padded width (%03d)
+void debug_printf(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    
+    for (const char *p = format; *p; p++) {
+        if (*p != '%') {
+            debug_putc(*p);
+            continue;
+        }
+        
+        char pad = ' ';
+        int width = 0;
+        p++;
+        if (*p == '0') {
+            pad = '0';
+            p++;
+        }
+        while (*p >= '0' && *p <= '9') {
+            width = width * 10 + (*p++ - '0');
+        }
+        
+        switch (*p) {
+            case 'd': {
+                int value = va_arg(args, int);
+                if (value < 0) {
+                    debug_putc('-');
+                    debug_print_uint(-(uint32_t)value, 10, width ? width - 1 : 0, pad);
+                } else {
+                    debug_print_uint(value, 10, width, pad);
+                }
+                break;
+            }
+            case 'u':
+                debug_print_uint(va_arg(args, uint32_t), 10, width, pad);
+                break;
+            case 'x':
+                debug_print_uint(va_arg(args, uint32_t), 16, width, pad);
+                break;
+            case 'c':
+                debug_putc((char)va_arg(args, int));
+                break;
+            case 's':
+                debug_print(va_arg(args, const char *));
+                break;
+            case '%':
+                debug_putc('%');
+                break;
+            case '\0':
+                p--;
+                break;
+            default:
+                debug_putc('%');
+                debug_putc(*p);
+                break;
+        }
+    }
+    
+    va_end(args);
+}
+
+uint32_t get_cycle_count(void) {
+    uint32_t cycles;
+    asm volatile ("rdcycle %0" : "=r"(cycles));
+    return cycles;
+}
+
+void delay_cycles(uint32_t cycles) {
+    uint32_t start = get_cycle_count();
+    while (get_cycle_count() - start < cycles) {
+        asm volatile ("nop");
+    }
+}
+
+void *memset(void *dest, int value, size_t n) {
+    uint8_t *d = dest;
+    while (n--) {
+        *d++ = (uint8_t)value;
+    }
+    return dest;
+}
+
+void *memcpy(void *dest, const void *src, size_t n) {
+    uint8_t *d = dest;
+    const uint8_t *s = src;
+    while (n--) {
+        *d++ = *s++;
+    }
+    return dest;
+}
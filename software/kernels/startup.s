@@ -0,0 +1,48 @@
+# Reset entry for UnifiedRISCV kernel images
+# The CPU starts at address 0: set up the stack, clear .bss, run main and
+# hand its return value to host_exit (tohost write followed by ECALL).
+# Every hart of a cluster starts here. Hart 0 does the above; the others take
+# a stack below hart 0's, wait for .bss to be clear and run cluster_worker,
+# which only returns work when hart 0 calls cluster_run.
+
+    # 16KB of stack per hart: hart n's starts n * 16KB below __stack_top,
+    # so on a cluster hart 0 also has only 16KB before it reaches hart 1's
+    .equ    HART_STACK_SHIFT, 14
+    
+    .section .text.init
+    .globl _start
+_start:
+    csrr    t0, mhartid
+    bnez    t0, 4f
+    la      sp, __stack_top
+    la      t0, __bss_start
+    la      t1, __bss_end
+1:
+    bgeu    t0, t1, 2f
+    sw      zero, 0(t0)
+    addi    t0, t0, 4
+    j       1b
+2:
+    la      t0, harts_released
+    li      t1, 1
+    sw      t1, 0(t0)
+    call    main
+    call    host_exit
+3:
+    j       3b
+4:
+    la      sp, __stack_top
+    slli    t1, t0, HART_STACK_SHIFT
+    sub     sp, sp, t1
+    la      t2, harts_released
+5:
+    lw      t3, 0(t2)
+    beqz    t3, 5b
+    call    cluster_worker
+6:
+    j       6b
+    
+    .section .data
+    .align  2
+harts_released:
+    .word   0
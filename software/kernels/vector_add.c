@@ -0,0 +1,106 @@
+/*
+ * Elementwise Vector Kernels for UnifiedRISCV
+ * CPU packed-SIMD versions: four int8 or two int16 lanes per instruction.
+ * Word-aligned bodies use the SIMD ops, the rest falls back to scalar code
+ * with the same (saturating) results.
+ */
+
+#include "gpu_interface.h"
+#include "matrix_ops.h"
+
+static inline int8_t sat8(int32_t value) {
+    if (value > 127) return 127;
+    if (value < -128) return -128;
+    return (int8_t)value;
+}
+
+static inline int16_t sat16(int32_t value) {
+    if (value > 32767) return 32767;
+    if (value < -32768) return -32768;
+    return (int16_t)value;
+}
+
+// Number of leading elements to process as whole words, or 0 when the
+// buffers do not share word alignment
+static inline int simd_words(const void *a, const void *b, const void *c,
+                             int length, int per_word) {
+    uintptr_t misaligned = ((uintptr_t)a | (uintptr_t)b | (uintptr_t)c) & 3;
+    return misaligned ? 0 : (length / per_word) * per_word;
+}
+
+void vector_add_int8(int8_t *a, int8_t *b, int8_t *c, int length) {
+    int body = simd_words(a, b, c, length, 4);
+    const uint32_t *wa = (const uint32_t *)a;
+    const uint32_t *wb = (const uint32_t *)b;
+    uint32_t *wc = (uint32_t *)c;
+    
+    for (int w = 0; w < body / 4; w++) {
+        wc[w] = simd_kadd8(wa[w], wb[w]);
+    }
+    for (int i = body; i < length; i++) {
+        c[i] = sat8(a[i] + b[i]);
+    }
+}
+
+void vector_add_int16(int16_t *a, int16_t *b, int16_t *c, int length) {
+    int body = simd_words(a, b, c, length, 2);
+    const uint32_t *wa = (const uint32_t *)a;
+    const uint32_t *wb = (const uint32_t *)b;
+    uint32_t *wc = (uint32_t *)c;
+    
+    for (int w = 0; w < body / 2; w++) {
+        wc[w] = simd_kadd16(wa[w], wb[w]);
+    }
+    for (int i = body; i < length; i++) {
+        c[i] = sat16(a[i] + b[i]);
+    }
+}
+
+void vector_scale_int8(int8_t *input, int8_t scale, int8_t *output, int length) {
+    int body = simd_words(input, output, output, length, 4);
+    const uint32_t *win = (const uint32_t *)input;
+    uint32_t *wout = (uint32_t *)output;
+    uint32_t scale4 = simd_splat8(scale);
+    
+    for (int w = 0; w < body / 4; w++) {
+        wout[w] = simd_kmul8(win[w], scale4);
+    }
+    for (int i = body; i < length; i++) {
+        output[i] = sat8(input[i] * scale);
+    }
+}
+
+void vector_relu_int8(int8_t *input, int8_t *output, int length) {
+    int body = simd_words(input, output, output, length, 4);
+    const uint32_t *win = (const uint32_t *)input;
+    uint32_t *wout = (uint32_t *)output;
+    
+    for (int w = 0; w < body / 4; w++) {
+        wout[w] = simd_max8(win[w], 0);
+    }
+    for (int i = body; i < length; i++) {
+        output[i] = input[i] > 0 ? input[i] : 0;
+    }
+}
+
+// Two input words (four int16) narrow into one output word per step
+void vector_requant_int16(const int16_t *input, int8_t *output, int shift, int length) {
+    int body = simd_words(input, output, output, length, 4);
+    const uint32_t *win = (const uint32_t *)input;
+    uint32_t *wout = (uint32_t *)output;
+    int16_t round;
+    uint32_t round2;
+    
+    shift &= 15;
+    round = shift > 0 ? (int16_t)(1 << (shift - 1)) : 0;
+    round2 = simd_splat16(round);
+    
+    for (int w = 0; w < body / 4; w++) {
+        uint32_t lo = simd_sra16(simd_kadd16(win[2 * w], round2), shift);
+        uint32_t hi = simd_sra16(simd_kadd16(win[2 * w + 1], round2), shift);
+        wout[w] = simd_narrow16(lo, hi);
+    }
+    for (int i = body; i < length; i++) {
+        output[i] = sat8(sat16(input[i] + round) >> shift);
+    }
+}
@@ -0,0 +1,313 @@
+// Main memory timing models for the UnifiedRISCV Verilator testbenches
+// A timing model only decides when an access issued at a given cycle
+// completes; the memory models own the data and the port protocol. Any
+// number of accesses can be in flight, each one is scheduled as it arrives.
+//
+//   fixed  - every access takes `latency` cycles
+//   ddr    - banked DRAM with open-row buffers: row hits pay tCAS, accesses
+//            to a closed bank tRCD + tCAS, row conflicts tRP + tRCD + tCAS.
+//            All banks are refreshed for tRFC cycles every tREFI cycles.
+//
+// Both share a data bus capped at bytes_per_cycle, so back-to-back lines
+// are limited by bandwidth as well as latency. Timings are in core cycles;
+// the ddr4 / lpddr4 presets assume a 200MHz core clock.
+//
+// Bank parallelism only shows when the caller keeps several accesses in
+// flight, as tb_gpu_array_bandwidth does on the tagged GPU port. The system
+// memory port (TBMemoryModel) is a single req/ack handshake, so there every
+// access waits for the previous one and the ddr presets only add row-buffer
+// and refresh latency, never overlap between banks.
+//
+// Configuration comes from an optional +mem_config=<file> of `key = value`
+// lines, then +mem_<key>=<value> plusargs, e.g. +mem_model=ddr4 +mem_banks=8
+
+#ifndef TB_DRAM_TIMING_H
+#define TB_DRAM_TIMING_H
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include "verilated.h"
+
+struct MemTimingConfig {
+    std::string model = "fixed";
+    uint32_t latency = 2;
+    uint32_t banks = 8;
+    uint32_t row_bytes = 2048;
+    uint32_t tcas = 3;
+    uint32_t trcd = 3;
+    uint32_t trp = 3;
+    uint32_t trefi = 1560;
+    uint32_t trfc = 70;
+    uint32_t bytes_per_cycle = 64;
+    uint32_t line_bytes = 64;
+    
+    // Presets pick the timings; later keys can still override them
+    bool set(const std::string& key, const std::string& value) {
+        uint32_t num = strtoul(value.c_str(), nullptr, 0);
+        if (key == "model") {
+            model = value;
+            if (value == "ddr4") {
+                model = "ddr";
+                banks = 16; row_bytes = 8192;
+                tcas = 3; trcd = 3; trp = 3;
+                trefi = 1560; trfc = 70;
+                bytes_per_cycle = 64;
+            } else if (value == "lpddr4") {
+                model = "ddr";
+                banks = 8; row_bytes = 2048;
+                tcas = 4; trcd = 4; trp = 4;
+                trefi = 780; trfc = 56;
+                bytes_per_cycle = 32;
+            }
+        } else if (key == "latency") {
+            latency = num;
+        } else if (key == "banks") {
+            banks = num ? num : 1;
+        } else if (key == "row_bytes") {
+            row_bytes = num ? num : line_bytes;
+        } else if (key == "tcas") {
+            tcas = num;
+        } else if (key == "trcd") {
+            trcd = num;
+        } else if (key == "trp") {
+            trp = num;
+        } else if (key == "trefi") {
+            trefi = num;
+        } else if (key == "trfc") {
+            trfc = num;
+        } else if (key == "bytes_per_cycle") {
+            bytes_per_cycle = num ? num : 1;
+        } else {
+            return false;
+        }
+        return true;
+    }
+    
+    bool load_file(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Cannot open memory config " << path << std::endl;
+            return false;
+        }
+        std::string line;
+        while (std::getline(in, line)) {
+            line = line.substr(0, line.find('#'));
+            size_t eq = line.find('=');
+            if (eq == std::string::npos) continue;
+            std::string key, value;
+            std::istringstream(line.substr(0, eq)) >> key;
+            std::istringstream(line.substr(eq + 1)) >> value;
+            if (!key.empty() && !set(key, value)) {
+                std::cerr << "Unknown memory config key: " << key << std::endl;
+            }
+        }
+        return true;
+    }
+    
+    static MemTimingConfig from_plusargs(uint32_t default_latency) {
+        static const char* keys[] = {
+            "model", "latency", "banks", "row_bytes", "tcas", "trcd", "trp",
+            "trefi", "trfc", "bytes_per_cycle"
+        };
+        MemTimingConfig cfg;
+        cfg.latency = default_latency;
+        
+        std::string file = plusarg("config");
+        if (!file.empty()) {
+            cfg.load_file(file);
+        }
+        for (const char* key : keys) {
+            std::string value = plusarg(key);
+            if (!value.empty()) {
+                cfg.set(key, value);
+            }
+        }
+        return cfg;
+    }
+    
+    static std::string plusarg(const char* key) {
+        std::string prefix = std::string("mem_") + key + "=";
+        const char* match = Verilated::commandArgsPlusMatch(prefix.c_str());
+        if (match && match[0]) {
+            return std::string(match + prefix.size() + 1);
+        }
+        return "";
+    }
+};
+
+class MemTimingModel {
+protected:
+    // Shared data bus: one line occupies it for burst cycles
+    uint64_t bus_free;
+    uint32_t burst;
+
+public:
+    explicit MemTimingModel(const MemTimingConfig& cfg)
+        : bus_free(0),
+          burst((cfg.line_bytes + cfg.bytes_per_cycle - 1) / cfg.bytes_per_cycle) {}
+    virtual ~MemTimingModel() {}
+    
+    // Cycle at which an access issued at cycle `now` completes
+    virtual uint64_t schedule(uint64_t now, uint32_t addr, bool write) = 0;
+    virtual std::string describe() const = 0;
+    virtual void report(std::ostream& os) const { (void)os; }
+    
+    // Scheduling state as words, for checkpoints. A restore only accepts
+    // the state of an identically configured model.
+    virtual std::vector<uint64_t> state() const { return {bus_free}; }
+    virtual bool restore(const std::vector<uint64_t>& words) {
+        if (words.size() != 1) return false;
+        bus_free = words[0];
+        return true;
+    }
+    
+    static std::unique_ptr<MemTimingModel> create(const MemTimingConfig& cfg);
+
+protected:
+    // Data moves once the array is ready and the bus is free
+    uint64_t transfer(uint64_t data_ready) {
+        uint64_t start = data_ready > bus_free ? data_ready : bus_free;
+        bus_free = start + burst;
+        return bus_free;
+    }
+};
+
+class FixedLatencyTiming : public MemTimingModel {
+private:
+    uint32_t latency;
+
+public:
+    explicit FixedLatencyTiming(const MemTimingConfig& cfg)
+        : MemTimingModel(cfg), latency(cfg.latency) {}
+    
+    uint64_t schedule(uint64_t now, uint32_t addr, bool write) override {
+        (void)addr;
+        (void)write;
+        // With an uncapped bus this is exactly now + latency
+        return transfer(now + latency - (latency < burst ? latency : burst));
+    }
+    
+    std::string describe() const override {
+        return std::to_string(latency) + "-cycle fixed";
+    }
+};
+
+class DDRTiming : public MemTimingModel {
+private:
+    uint32_t banks;
+    uint32_t lines_per_row;
+    uint32_t line_bytes;
+    uint32_t tcas, trcd, trp, trefi, trfc;
+    
+    // Per bank: open row (-1 when precharged) and when it takes a new command
+    std::vector<int64_t> open_row;
+    std::vector<uint64_t> bank_ready;
+    uint64_t next_refresh;
+    
+    uint64_t row_hits;
+    uint64_t row_misses;
+    uint64_t row_conflicts;
+    uint64_t refreshes;
+
+public:
+    explicit DDRTiming(const MemTimingConfig& cfg)
+        : MemTimingModel(cfg), banks(cfg.banks),
+          lines_per_row(cfg.row_bytes / cfg.line_bytes ? cfg.row_bytes / cfg.line_bytes : 1),
+          line_bytes(cfg.line_bytes), tcas(cfg.tcas), trcd(cfg.trcd), trp(cfg.trp),
+          trefi(cfg.trefi), trfc(cfg.trfc),
+          open_row(cfg.banks, -1), bank_ready(cfg.banks, 0), next_refresh(cfg.trefi),
+          row_hits(0), row_misses(0), row_conflicts(0), refreshes(0) {}
+    
+    uint64_t schedule(uint64_t now, uint32_t addr, bool write) override {
+        (void)write;
+        // Consecutive lines share a row, consecutive rows go to different banks
+        uint32_t line = addr / line_bytes;
+        uint32_t bank = (line / lines_per_row) % banks;
+        int64_t row = line / lines_per_row / banks;
+        
+        uint64_t start = now > bank_ready[bank] ? now : bank_ready[bank];
+        
+        // Refresh closes every row and blocks all banks for tRFC
+        while (trefi && start >= next_refresh) {
+            uint64_t refresh_done = next_refresh + trfc;
+            for (uint32_t b = 0; b < banks; b++) {
+                open_row[b] = -1;
+            }
+            start = start > refresh_done ? start : refresh_done;
+            next_refresh += trefi;
+            refreshes++;
+        }
+        
+        uint32_t latency;
+        if (open_row[bank] == row) {
+            latency = tcas;
+            row_hits++;
+        } else if (open_row[bank] < 0) {
+            latency = trcd + tcas;
+            row_misses++;
+        } else {
+            latency = trp + trcd + tcas;
+            row_conflicts++;
+        }
+        open_row[bank] = row;
+        
+        uint64_t done = transfer(start + latency);
+        bank_ready[bank] = done - burst;
+        return done;
+    }
+    
+    std::string describe() const override {
+        return std::to_string(banks) + "-bank DDR (tCAS " + std::to_string(tcas) +
+               ", tRCD " + std::to_string(trcd) + ", tRP " + std::to_string(trp) + ")";
+    }
+    
+    std::vector<uint64_t> state() const override {
+        std::vector<uint64_t> words = {bus_free, next_refresh, row_hits, row_misses,
+                                       row_conflicts, refreshes};
+        for (uint32_t b = 0; b < banks; b++) {
+            words.push_back(static_cast<uint64_t>(open_row[b]));
+            words.push_back(bank_ready[b]);
+        }
+        return words;
+    }
+    
+    bool restore(const std::vector<uint64_t>& words) override {
+        if (words.size() != 6 + 2 * banks) return false;
+        bus_free = words[0];
+        next_refresh = words[1];
+        row_hits = words[2];
+        row_misses = words[3];
+        row_conflicts = words[4];
+        refreshes = words[5];
+        for (uint32_t b = 0; b < banks; b++) {
+            open_row[b] = static_cast<int64_t>(words[6 + 2 * b]);
+            bank_ready[b] = words[7 + 2 * b];
+        }
+        return true;
+    }
+    
+    void report(std::ostream& os) const override {
+        uint64_t total = row_hits + row_misses + row_conflicts;
+        os << "DRAM: " << total << " accesses, " << row_hits << " row hits, "
+           << row_misses << " row misses, " << row_conflicts << " row conflicts, "
+           << refreshes << " refreshes" << std::endl;
+    }
+};
+
+inline std::unique_ptr<MemTimingModel> MemTimingModel::create(const MemTimingConfig& cfg) {
+    if (cfg.model == "ddr") {
+        return std::unique_ptr<MemTimingModel>(new DDRTiming(cfg));
+    }
+    if (cfg.model != "fixed") {
+        std::cerr << "Unknown memory model " << cfg.model << ", using fixed" << std::endl;
+    }
+    return std::unique_ptr<MemTimingModel>(new FixedLatencyTiming(cfg));
+}
+
+#endif // TB_DRAM_TIMING_H
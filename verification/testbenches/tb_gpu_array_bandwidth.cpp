@@ -0,0 +1,260 @@
+// GPU array memory bandwidth benchmark using Verilator
+// Drives gpu_compute_array directly from per-unit command rings against a
+// pipelined, tagged memory model and reports sustained bandwidth per cycle.
+// Build with -GNUM_UNITS=<n> to sweep the unit count (see `make bandwidth`).
+
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include "Vgpu_compute_array.h"
+#include "verilated.h"
+#include "tb_dram_timing.h"
+
+// Must match the -GNUM_UNITS the model was verilated with
+#ifndef BW_NUM_UNITS
+#define BW_NUM_UNITS 8
+#endif
+
+class GPUArrayBandwidthBench {
+private:
+    Vgpu_compute_array* dut;
+    uint64_t cycle;
+    
+    // Word-addressed backing store
+    std::vector<uint32_t> memory;
+    static const uint32_t MEMORY_SIZE = 1024 * 1024; // 1MB
+    static const uint32_t LINE_WORDS = 16;           // 512-bit lines
+    
+    // Per-unit layout: ring, then A, B and C tiles in the same 4KB region
+    static const uint32_t REGION_BASE = 0x10000;
+    static const uint32_t REGION_SIZE = 0x1000;
+    static const uint32_t RING_DEPTH = 16;
+    static const uint32_t BYTES_PER_OP = 80; // descriptor + A + B + packed C
+    
+    // Responses in flight; the model accepts one request per cycle and
+    // returns each one when the timing model completes it, in order
+    struct Response {
+        uint64_t ready;
+        uint32_t tag;
+        uint32_t rdata;
+        uint32_t line[LINE_WORDS];
+    };
+    std::deque<Response> in_flight;
+    std::unique_ptr<MemTimingModel> timing;
+    
+    int num_units;
+    std::vector<uint32_t> ring_head;
+    std::vector<uint64_t> ops_retired;
+    std::vector<uint32_t> last_tail;
+    uint64_t transactions;
+
+public:
+    GPUArrayBandwidthBench(const MemTimingConfig& timing_cfg)
+        : cycle(0), timing(MemTimingModel::create(timing_cfg)), transactions(0) {
+        dut = new Vgpu_compute_array;
+        memory.resize(MEMORY_SIZE / 4, 0);
+        
+        num_units = BW_NUM_UNITS;
+        ring_head.resize(num_units, 0);
+        ops_retired.resize(num_units, 0);
+        last_tail.resize(num_units, 0);
+        
+        if (REGION_BASE + num_units * REGION_SIZE > MEMORY_SIZE) {
+            std::cerr << "Too many units for the memory model" << std::endl;
+            exit(1);
+        }
+    }
+    
+    ~GPUArrayBandwidthBench() {
+        dut->final();
+        delete dut;
+    }
+    
+    uint32_t region(int unit) const {
+        return REGION_BASE + unit * REGION_SIZE;
+    }
+    
+    void write_word(uint32_t addr, uint32_t data) {
+        if (addr < MEMORY_SIZE) {
+            memory[addr / 4] = data;
+        }
+    }
+    
+    uint32_t read_word(uint32_t addr) const {
+        return (addr < MEMORY_SIZE) ? memory[addr / 4] : 0;
+    }
+    
+    void setup_rings() {
+        for (int u = 0; u < num_units; u++) {
+            uint32_t base = region(u);
+            uint32_t a_addr = base + 0x100;
+            uint32_t b_addr = base + 0x140;
+            uint32_t c_addr = base + 0x180;
+            
+            // Every slot describes the same op, so the ring is filled once
+            // and the benchmark only has to advance the head
+            for (uint32_t slot = 0; slot < RING_DEPTH; slot++) {
+                write_word(base + slot * 16 + 0, a_addr);
+                write_word(base + slot * 16 + 4, b_addr);
+                write_word(base + slot * 16 + 8, c_addr);
+                write_word(base + slot * 16 + 12, 0);
+            }
+            for (uint32_t w = 0; w < 4; w++) {
+                write_word(a_addr + w * 4, 0x01010101 * (w + 1));
+                write_word(b_addr + w * 4, 0x01000000 >> (w * 8)); // identity rows
+            }
+            
+            dut->ring_base[u] = base;
+            dut->ring_head[u] = 0;
+            dut->unit_start = 0;
+            dut->matrix_a[u] = 0;
+            dut->matrix_b[u] = 0;
+            dut->unit_config[u] = 0;
+        }
+    }
+    
+    // Sample the request presented this cycle and drive the response due now
+    void handle_memory_interface() {
+        dut->mem_gnt = 1;
+        dut->mem_ack = 0;
+        
+        if (!in_flight.empty() && in_flight.front().ready <= cycle) {
+            const Response& resp = in_flight.front();
+            dut->mem_ack = 1;
+            dut->mem_rtag = resp.tag;
+            dut->mem_rdata = resp.rdata;
+            for (uint32_t w = 0; w < LINE_WORDS; w++) {
+                dut->mem_line_rdata[w] = resp.line[w];
+            }
+            in_flight.pop_front();
+        }
+        dut->eval();
+        
+        if (dut->mem_req && dut->mem_gnt) {
+            Response resp = {};
+            uint32_t addr = dut->mem_addr;
+            uint32_t line_addr = addr & ~(LINE_WORDS * 4 - 1);
+            
+            resp.ready = timing->schedule(cycle, addr, dut->mem_we);
+            resp.tag = dut->mem_tag;
+            if (dut->mem_line) {
+                for (uint32_t w = 0; w < LINE_WORDS; w++) {
+                    if (dut->mem_we && (dut->mem_wmask & (1u << w))) {
+                        write_word(line_addr + w * 4, dut->mem_line_wdata[w]);
+                    }
+                    resp.line[w] = read_word(line_addr + w * 4);
+                }
+            } else if (dut->mem_we) {
+                write_word(addr, dut->mem_wdata);
+            } else {
+                resp.rdata = read_word(addr);
+            }
+            in_flight.push_back(resp);
+            transactions++;
+        }
+    }
+    
+    void clock_tick() {
+        handle_memory_interface();
+        
+        dut->clk = 1;
+        dut->eval();
+        dut->clk = 0;
+        dut->eval();
+        cycle++;
+    }
+    
+    void reset(int cycles = 5) {
+        dut->rst_n = 0;
+        for (int i = 0; i < cycles; i++) {
+            clock_tick();
+        }
+        dut->rst_n = 1;
+    }
+    
+    // Keep every ring full and count retired descriptors from the tails
+    void refill_rings() {
+        for (int u = 0; u < num_units; u++) {
+            uint32_t tail = dut->ring_tail[u];
+            ops_retired[u] += (tail - last_tail[u]) & 0xff;
+            last_tail[u] = tail;
+            
+            uint32_t pending = (ring_head[u] - tail) & 0xff;
+            if (pending < RING_DEPTH) {
+                ring_head[u] = (ring_head[u] + (RING_DEPTH - pending)) & 0xff;
+                dut->ring_head[u] = ring_head[u];
+            }
+        }
+    }
+    
+    void run(uint64_t warmup, uint64_t measure) {
+        setup_rings();
+        reset();
+        
+        for (uint64_t i = 0; i < warmup; i++) {
+            refill_rings();
+            clock_tick();
+        }
+        
+        uint64_t start_ops = total_ops();
+        uint64_t start_txns = transactions;
+        for (uint64_t i = 0; i < measure; i++) {
+            refill_rings();
+            clock_tick();
+        }
+        refill_rings();
+        
+        uint64_t ops = total_ops() - start_ops;
+        uint64_t txns = transactions - start_txns;
+        double ops_per_cycle = (double)ops / measure;
+        
+        std::cout << "GPU array bandwidth (" << num_units << " units, "
+                  << timing->describe() << " memory)" << std::endl;
+        std::cout << "  Cycles measured:     " << measure << std::endl;
+        std::cout << "  Ops retired:         " << ops << std::endl;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "  Ops/cycle:           " << ops_per_cycle << std::endl;
+        std::cout << "  Transactions/cycle:  " << (double)txns / measure << std::endl;
+        std::cout << "  Bytes/cycle:         " << ops_per_cycle * BYTES_PER_OP << std::endl;
+        timing->report(std::cout);
+        
+        // One line per run for the make bandwidth summary table
+        std::cout << "BW " << num_units << " " << ops_per_cycle << " "
+                  << (double)txns / measure << " " << ops_per_cycle * BYTES_PER_OP
+                  << std::endl;
+    }
+    
+    uint64_t total_ops() const {
+        uint64_t total = 0;
+        for (int u = 0; u < num_units; u++) {
+            total += ops_retired[u];
+        }
+        return total;
+    }
+};
+
+static uint64_t plusarg_value(const char* name, uint64_t fallback) {
+    std::string prefix = std::string(name) + "=";
+    const char* match = Verilated::commandArgsPlusMatch(prefix.c_str());
+    if (match && match[0]) {
+        return strtoull(match + prefix.size() + 1, nullptr, 0);
+    }
+    return fallback;
+}
+
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+    
+    MemTimingConfig timing_cfg = MemTimingConfig::from_plusargs(4);
+    uint64_t warmup = plusarg_value("warmup", 1000);
+    uint64_t cycles = plusarg_value("cycles", 20000);
+    
+    GPUArrayBandwidthBench bench(timing_cfg);
+    bench.run(warmup, cycles);
+    
+    return 0;
+}
@@ -0,0 +1,241 @@
+// Main memory model for the UnifiedRISCV Verilator testbenches
+// Serves the top-level 512-bit line port with whole-line memcpy between the
+// backing store and the Verilator wide signals. Large images (up to the
+// 256MB MAIN_MEMORY_SIZE) use an anonymous mmap so untouched pages cost
+// nothing. The RISC-V targets and the simulation hosts are little-endian,
+// so bytes in the store line up with the 32-bit words of the wide signals.
+// Access latency comes from a MemTimingModel (see tb_dram_timing.h). The
+// port has no tag and the DUT holds mem_req until it sees mem_ack, so only
+// one access is ever outstanding: DRAM bank overlap is not modelled here.
+// save/restore put the contents and port state into a simulation checkpoint.
+
+#ifndef TB_MEMORY_MODEL_H
+#define TB_MEMORY_MODEL_H
+
+#include <iostream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/mman.h>
+#include "tb_dram_timing.h"
+
+class TBMemoryModel {
+private:
+    uint8_t* data;
+    size_t size;
+    bool mapped;
+    
+    // The port holds one request: accepted, waiting for its completion
+    // cycle from the timing model, then acked for a cycle. The handshake
+    // gives the DUT no way to issue the next one earlier, so there is no
+    // queue of completions to keep.
+    std::unique_ptr<MemTimingModel> timing;
+    uint64_t cycle;
+    uint64_t done_cycle;
+    bool pending;
+    bool acking;
+    
+    int verbosity;
+    uint64_t reads;
+    uint64_t writes;
+    
+    // Checkpoints store only the pages that are not all zero
+    static const size_t PAGE_BYTES = 4096;
+    
+    bool page_is_zero(size_t offset, size_t len) const {
+        static const uint8_t zero[PAGE_BYTES] = {};
+        return memcmp(data + offset, zero, len) == 0;
+    }
+    
+    template <class Stream>
+    static void put(Stream& os, uint64_t value) { os.write(&value, sizeof(value)); }
+    
+    template <class Stream>
+    static uint64_t get(Stream& is) {
+        uint64_t value = 0;
+        is.read(&value, sizeof(value));
+        return value;
+    }
+
+public:
+    static const uint32_t LINE_BYTES = 64; // 512-bit lines
+    static const size_t MAIN_MEMORY_SIZE = 0x10000000; // 256MB
+    
+    TBMemoryModel(size_t bytes, bool use_mmap, const MemTimingConfig& timing_cfg, int verbose = 0)
+        : data(nullptr), size(bytes), mapped(false), timing(MemTimingModel::create(timing_cfg)),
+          cycle(0), done_cycle(0), pending(false), acking(false),
+          verbosity(verbose), reads(0), writes(0) {
+        if (use_mmap) {
+            void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+            if (region != MAP_FAILED) {
+                data = static_cast<uint8_t*>(region);
+                mapped = true;
+            } else if (verbosity > 0) {
+                std::cout << "mmap of " << size << " bytes failed, using heap" << std::endl;
+            }
+        }
+        if (!data) {
+            data = static_cast<uint8_t*>(calloc(size, 1));
+            if (!data) {
+                std::cerr << "Cannot allocate " << size << " bytes of memory" << std::endl;
+                exit(1);
+            }
+        }
+    }
+    
+    ~TBMemoryModel() {
+        if (mapped) {
+            munmap(data, size);
+        } else {
+            free(data);
+        }
+    }
+    
+    TBMemoryModel(const TBMemoryModel&) = delete;
+    TBMemoryModel& operator=(const TBMemoryModel&) = delete;
+    
+    size_t bytes() const { return size; }
+    bool is_mapped() const { return mapped; }
+    uint64_t read_count() const { return reads; }
+    uint64_t write_count() const { return writes; }
+    void set_verbosity(int level) { verbosity = level; }
+    std::string timing_name() const { return timing->describe(); }
+    
+    void report(std::ostream& os) const {
+        os << "Memory: " << reads << " line reads, " << writes << " line writes ("
+           << timing->describe() << ")" << std::endl;
+        timing->report(os);
+    }
+    
+    uint8_t& operator[](size_t addr) { return data[addr]; }
+    
+    // Bulk accessors; anything past the end of memory is dropped or reads 0
+    void write(uint32_t addr, const void* src, size_t len) {
+        if (addr >= size) return;
+        memcpy(data + addr, src, len < size - addr ? len : size - addr);
+    }
+    
+    void read(uint32_t addr, void* dst, size_t len) const {
+        size_t avail = addr < size ? size - addr : 0;
+        size_t n = len < avail ? len : avail;
+        if (n) memcpy(dst, data + addr, n);
+        memset(static_cast<uint8_t*>(dst) + n, 0, len - n);
+    }
+    
+    void write32(uint32_t addr, uint32_t value) { write(addr, &value, 4); }
+    
+    uint32_t read32(uint32_t addr) const {
+        uint32_t value;
+        read(addr, &value, 4);
+        return value;
+    }
+    
+    // Write the contents and port state to a checkpoint stream (anything
+    // with write(const void*, size_t), e.g. VerilatedSave)
+    template <class Stream>
+    void save(Stream& os) const {
+        put(os, size);
+        put(os, cycle);
+        put(os, done_cycle);
+        put(os, (pending ? 1 : 0) | (acking ? 2 : 0));
+        put(os, reads);
+        put(os, writes);
+        
+        std::vector<uint64_t> words = timing->state();
+        put(os, words.size());
+        for (uint64_t word : words) {
+            put(os, word);
+        }
+        
+        // Non-zero pages as (offset, bytes), ended by an offset of size
+        for (size_t offset = 0; offset < size; offset += PAGE_BYTES) {
+            size_t len = size - offset < PAGE_BYTES ? size - offset : PAGE_BYTES;
+            if (page_is_zero(offset, len)) continue;
+            put(os, offset);
+            os.write(data + offset, len);
+        }
+        put(os, size);
+    }
+    
+    // Counterpart of save, from a stream with read(void*, size_t). Fails when
+    // the checkpoint came from a different memory size or timing config.
+    template <class Stream>
+    bool restore(Stream& is) {
+        if (get(is) != size) {
+            std::cerr << "Checkpoint memory size does not match (+mem_mmap?)" << std::endl;
+            return false;
+        }
+        cycle = get(is);
+        done_cycle = get(is);
+        uint64_t flags = get(is);
+        pending = flags & 1;
+        acking = flags & 2;
+        reads = get(is);
+        writes = get(is);
+        
+        std::vector<uint64_t> words(get(is));
+        for (uint64_t& word : words) {
+            word = get(is);
+        }
+        if (!timing->restore(words)) {
+            std::cerr << "Checkpoint memory timing does not match " << timing->describe()
+                      << std::endl;
+            return false;
+        }
+        
+        // Clear only what is dirty, so a sparse mmap image stays unbacked
+        for (size_t offset = 0; offset < size; offset += PAGE_BYTES) {
+            size_t len = size - offset < PAGE_BYTES ? size - offset : PAGE_BYTES;
+            if (!page_is_zero(offset, len)) memset(data + offset, 0, len);
+        }
+        for (uint64_t offset = get(is); offset < size; offset = get(is)) {
+            size_t len = size - offset < PAGE_BYTES ? size - offset : PAGE_BYTES;
+            is.read(data + offset, len);
+        }
+        return true;
+    }
+    
+    // Drive the DUT's main memory port. Call once per clock, after the
+    // negative edge, so mem_ack and mem_rdata are stable for the next
+    // rising edge; the DUT holds mem_req until it samples mem_ack.
+    template <class Dut>
+    void tick(Dut* dut) {
+        uint64_t now = cycle++;
+        
+        if (acking) {
+            // The DUT saw the ack on the last rising edge and dropped mem_req
+            acking = false;
+            dut->mem_ack = 0;
+            return;
+        }
+        
+        if (!pending) {
+            if (!dut->mem_req) return;
+            pending = true;
+            done_cycle = timing->schedule(now, dut->mem_addr, dut->mem_we);
+        }
+        
+        if (now < done_cycle) return;
+        
+        uint32_t addr = dut->mem_addr;
+        if (dut->mem_we) {
+            write(addr, &dut->mem_wdata[0], LINE_BYTES);
+            writes++;
+        } else {
+            read(addr, &dut->mem_rdata[0], LINE_BYTES);
+            reads++;
+        }
+        if (verbosity > 0) {
+            std::cout << (dut->mem_we ? "MEM WRITE" : "MEM READ") << ": addr=0x"
+                      << std::hex << addr << std::dec << std::endl;
+        }
+        
+        pending = false;
+        acking = true;
+        dut->mem_ack = 1;
+    }
+};
+
+#endif // TB_MEMORY_MODEL_H
@@ -0,0 +1,339 @@
+// Stall attribution profiler for the UnifiedRISCV Verilator testbench
+// Samples CPU pipeline, GPU unit and memory-system state once per cycle
+// through VPI and charges every cycle of each track to exactly one state:
+//
+//   CPU     dmem (data access waiting), gpu (blocked on a GPU instruction),
+//           run (an instruction retired), ifetch (I-cache refill), hazard
+//           (load-use bubble), bubble (redirects and other empty slots)
+//   GPU n   compute (MAC array busy), arb_wait (requesting, not granted by
+//           the array arbiter), mem (request in flight or ack pending),
+//           busy (ring bookkeeping, handoff), idle
+//   Memory  dram (external port busy), miss (misses waiting on the memory
+//           engine), hit (hit service or lookup), idle
+//
+// Totals are kept per region. Software names regions through the host
+// window (host_region_begin / host_region_end in gpu_interface.h); the
+// whole run is always reported as "program". The timeline is written as
+// Chrome trace-event JSON, loadable in chrome://tracing or ui.perfetto.dev,
+// with one microsecond on the time axis per core cycle. Idle slices are
+// left out to keep the file small.
+//
+// Needs a model built with --vpi --public-flat-rw (make sim-profile).
+
+#ifndef TB_PROFILER_H
+#define TB_PROFILER_H
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "verilated.h"
+#include "verilated_vpi.h"
+
+class TBProfiler {
+private:
+    enum CpuState { CPU_DMEM, CPU_GPU, CPU_RUN, CPU_IFETCH, CPU_HAZARD, CPU_BUBBLE };
+    enum UnitState { UNIT_COMPUTE, UNIT_ARB_WAIT, UNIT_MEM, UNIT_BUSY, UNIT_IDLE };
+    enum MemState { MEM_DRAM, MEM_MISS, MEM_HIT, MEM_IDLE };
+    
+    // exec_state_t encoding in gpu_compute_unit.sv
+    static const int EX_COMPUTE = 1;
+    
+    struct Track {
+        std::string name;
+        std::vector<std::string> states;
+        int idle_state;  // Not written to the timeline (-1: always written)
+        int current;
+        uint64_t since;
+    };
+    
+    struct Region {
+        std::string name;
+        uint64_t start;
+        uint64_t end;
+        std::vector<std::vector<uint64_t>> cycles;  // [track][state]
+    };
+    
+    std::vector<Track> tracks;
+    std::vector<Region> regions;  // Closed regions in completion order
+    std::vector<Region> open;     // Innermost last; open[0] is the whole run
+    std::vector<int> state;       // Per-track state of the current sample
+    std::string pending_name;
+    
+    // Sampled signals; null handles are treated as 0
+    vpiHandle cpu_mem_stall, cpu_ex_stall, cpu_w_valid, cpu_refilling, cpu_load_use;
+    vpiHandle arb_eligible, arb_outstanding, arb_grant_valid, arb_grant_unit, arb_issue_free;
+    vpiHandle unit_mem_req;
+    std::vector<vpiHandle> unit_exec_state, unit_busy;
+    vpiHandle top_mem_req;
+    vpiHandle mc_mshr_count, mc_gpu_hit, mc_cpu_hit;
+    vpiHandle ch_state;
+    
+    std::ofstream json;
+    uint64_t events;
+    uint64_t max_events;
+    bool active;
+    
+    static vpiHandle find(const std::string& path) {
+        vpiHandle h = vpi_handle_by_name(const_cast<PLI_BYTE8*>(path.c_str()), nullptr);
+        if (h) return h;
+        // Generate block scopes may only be known by their mangled names
+        std::string mangled;
+        for (char c : path) {
+            if (c == '[') mangled += "__BRA__";
+            else if (c == ']') mangled += "__KET__";
+            else mangled += c;
+        }
+        return vpi_handle_by_name(const_cast<PLI_BYTE8*>(mangled.c_str()), nullptr);
+    }
+    
+    static uint32_t read(vpiHandle h) {
+        if (!h) return 0;
+        s_vpi_value value;
+        value.format = vpiIntVal;
+        vpi_get_value(h, &value);
+        return static_cast<uint32_t>(value.value.integer);
+    }
+    
+    void add_track(const std::string& name, const std::vector<std::string>& states, int idle) {
+        Track t;
+        t.name = name;
+        t.states = states;
+        t.idle_state = idle;
+        t.current = idle >= 0 ? idle : 0;
+        t.since = 0;
+        tracks.push_back(t);
+    }
+    
+    Region new_region(const std::string& name, uint64_t cycle) const {
+        Region r;
+        r.name = name;
+        r.start = cycle;
+        r.end = cycle;
+        for (const Track& t : tracks) {
+            r.cycles.push_back(std::vector<uint64_t>(t.states.size(), 0));
+        }
+        return r;
+    }
+    
+    void emit(const std::string& name, int tid, uint64_t ts, uint64_t dur) {
+        if (!json.is_open() || dur == 0 || events >= max_events) return;
+        json << ",\n{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << tid
+             << ",\"ts\":" << ts << ",\"dur\":" << dur << "}";
+        if (++events == max_events) {
+            std::cout << "Profiler: timeline truncated at " << max_events << " events" << std::endl;
+        }
+    }
+    
+    void set_state(size_t index, int next, uint64_t cycle) {
+        Track& t = tracks[index];
+        if (next == t.current) return;
+        if (t.current != t.idle_state) {
+            emit(t.states[t.current], index, t.since, cycle - t.since);
+        }
+        t.current = next;
+        t.since = cycle;
+    }
+    
+    void close_region(uint64_t cycle) {
+        Region r = open.back();
+        open.pop_back();
+        r.end = cycle;
+        emit(r.name, tracks.size(), r.start, r.end - r.start);
+        regions.push_back(r);
+    }
+    
+    void report_region(const Region& r, std::ostream& os) const {
+        uint64_t total = r.end - r.start;
+        os << "Profile: " << r.name << " (" << total << " cycles)" << std::endl;
+        if (total == 0) return;
+        for (size_t i = 0; i < tracks.size(); i++) {
+            const Track& t = tracks[i];
+            // Units that never left idle only add noise
+            if (t.idle_state >= 0 && r.cycles[i][t.idle_state] == total) continue;
+            os << "  " << std::left << std::setw(8) << t.name << std::right;
+            for (size_t s = 0; s < t.states.size(); s++) {
+                if (r.cycles[i][s] == 0) continue;
+                os << " " << t.states[s] << " " << std::fixed << std::setprecision(1)
+                   << 100.0 * r.cycles[i][s] / total << "%";
+            }
+            os << std::endl;
+        }
+    }
+
+public:
+    TBProfiler()
+        : cpu_mem_stall(nullptr), cpu_ex_stall(nullptr), cpu_w_valid(nullptr),
+          cpu_refilling(nullptr), cpu_load_use(nullptr),
+          arb_eligible(nullptr), arb_outstanding(nullptr), arb_grant_valid(nullptr),
+          arb_grant_unit(nullptr), arb_issue_free(nullptr), unit_mem_req(nullptr),
+          top_mem_req(nullptr), mc_mshr_count(nullptr), mc_gpu_hit(nullptr),
+          mc_cpu_hit(nullptr), ch_state(nullptr),
+          events(0), max_events(0), active(false) {}
+    
+    bool is_active() const { return active; }
+    
+    // Resolve the signals under `top` (e.g. "TOP.unified_riscv_simple") and
+    // open the timeline. Returns false when the model was not built for VPI.
+    bool start(const std::string& top, const std::string& path, uint64_t event_limit,
+               uint64_t cycle) {
+        std::string cpu = top + ".cpu_core.harts[0].cpu.";  // Hart 0 runs main
+        std::string array = top + ".gpu_array.";
+        
+        cpu_mem_stall = find(cpu + "mem_stall");
+        cpu_ex_stall = find(cpu + "ex_stall");
+        cpu_w_valid = find(cpu + "w_valid");
+        cpu_refilling = find(cpu + "refilling");
+        cpu_load_use = find(cpu + "load_use");
+        if (!cpu_mem_stall || !cpu_w_valid) {
+            std::cerr << "Profiler: no public signals under " << top
+                      << " (build with make sim-profile)" << std::endl;
+            return false;
+        }
+        
+        arb_eligible = find(array + "unit_eligible");
+        arb_outstanding = find(array + "unit_outstanding");
+        arb_grant_valid = find(array + "grant_valid");
+        arb_grant_unit = find(array + "grant_unit");
+        arb_issue_free = find(array + "issue_free");
+        unit_mem_req = find(array + "unit_mem_req");
+        for (int u = 0; u < 32; u++) {
+            std::string unit = array + "gpu_units[" + std::to_string(u) + "].unit.";
+            vpiHandle state = find(unit + "exec_state");
+            if (!state) break;
+            unit_exec_state.push_back(state);
+            unit_busy.push_back(find(unit + "busy"));
+        }
+        
+        // Whichever memory system the model was built with
+        top_mem_req = find(top + ".mem_req");
+        mc_mshr_count = find(top + ".gen_memory_controller.memory_controller.mshr_count");
+        mc_gpu_hit = find(top + ".gen_memory_controller.memory_controller.gpu_hit_valid");
+        mc_cpu_hit = find(top + ".gen_memory_controller.memory_controller.cpu_hit_valid");
+        ch_state = find(top + ".gen_cache_hierarchy.caches.current_state");
+        
+        add_track("CPU", {"dmem", "gpu", "run", "ifetch", "hazard", "bubble"}, -1);
+        for (size_t u = 0; u < unit_exec_state.size(); u++) {
+            add_track("GPU " + std::to_string(u),
+                      {"compute", "arb_wait", "mem", "busy", "idle"}, UNIT_IDLE);
+        }
+        add_track("Memory", {"dram", "miss", "hit", "idle"}, MEM_IDLE);
+        for (Track& t : tracks) {
+            t.since = cycle;
+        }
+        state.resize(tracks.size());
+        
+        max_events = event_limit;
+        json.open(path);
+        if (!json) {
+            std::cerr << "Profiler: cannot write " << path << std::endl;
+        } else {
+            json << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+                 << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,"
+                 << "\"args\":{\"name\":\"UnifiedRISCV (1us = 1 cycle)\"}}";
+            for (size_t i = 0; i <= tracks.size(); i++) {
+                json << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i
+                     << ",\"args\":{\"name\":\""
+                     << (i < tracks.size() ? tracks[i].name : std::string("Regions")) << "\"}}";
+            }
+        }
+        
+        open.push_back(new_region("program", cycle));
+        active = true;
+        std::cout << "Profiling " << unit_exec_state.size() << " GPU units"
+                  << (json.is_open() ? " into " + path : std::string()) << std::endl;
+        return true;
+    }
+    
+    // Call once per cycle after the rising edge has been evaluated
+    void sample(uint64_t cycle) {
+        if (!active) return;
+        
+        int cpu;
+        if (read(cpu_mem_stall)) cpu = CPU_DMEM;
+        else if (read(cpu_ex_stall)) cpu = CPU_GPU;
+        else if (read(cpu_w_valid)) cpu = CPU_RUN;
+        else if (read(cpu_refilling)) cpu = CPU_IFETCH;
+        else if (read(cpu_load_use)) cpu = CPU_HAZARD;
+        else cpu = CPU_BUBBLE;
+        
+        uint32_t eligible = read(arb_eligible);
+        uint32_t outstanding = read(arb_outstanding);
+        uint32_t requesting = read(unit_mem_req);
+        uint32_t granted = (read(arb_grant_valid) && read(arb_issue_free)) ?
+                           (1u << read(arb_grant_unit)) : 0;
+        
+        int mem;
+        if (read(top_mem_req)) mem = MEM_DRAM;
+        else if (read(mc_mshr_count)) mem = MEM_MISS;
+        else if (read(mc_gpu_hit) || read(mc_cpu_hit)) mem = MEM_HIT;
+        else if (ch_state && read(ch_state) != 0) mem = MEM_HIT;
+        else mem = MEM_IDLE;
+        
+        state[0] = cpu;
+        for (size_t u = 0; u < unit_exec_state.size(); u++) {
+            uint32_t bit = 1u << u;
+            int s;
+            if (read(unit_exec_state[u]) == EX_COMPUTE) s = UNIT_COMPUTE;
+            else if ((eligible & bit) && !(granted & bit)) s = UNIT_ARB_WAIT;
+            else if ((outstanding | requesting) & bit) s = UNIT_MEM;
+            else if (read(unit_busy[u])) s = UNIT_BUSY;
+            else s = UNIT_IDLE;
+            state[u + 1] = s;
+        }
+        state.back() = mem;
+        
+        for (size_t i = 0; i < tracks.size(); i++) {
+            set_state(i, state[i], cycle);
+            for (Region& r : open) {
+                r.cycles[i][state[i]]++;
+            }
+        }
+    }
+    
+    // Host window markers: name characters, then begin (1) or end (0)
+    void region_name_char(char c) {
+        if (active) pending_name += c;
+    }
+    
+    void region_control(uint32_t value, uint64_t cycle) {
+        if (!active) return;
+        if (value & 1) {
+            open.push_back(new_region(pending_name.empty() ? "region" : pending_name, cycle));
+            pending_name.clear();
+        } else if (open.size() > 1) {
+            close_region(cycle);
+        }
+    }
+    
+    // Close everything, finish the JSON file and print the breakdown
+    void finish(uint64_t cycle, std::ostream& os) {
+        if (!active) return;
+        for (size_t i = 0; i < tracks.size(); i++) {
+            Track& t = tracks[i];
+            if (t.current != t.idle_state) {
+                emit(t.states[t.current], i, t.since, cycle - t.since);
+            }
+        }
+        while (!open.empty()) {
+            close_region(cycle);
+        }
+        if (json.is_open()) {
+            json << "\n]}\n";
+            json.close();
+        }
+        active = false;
+        
+        os << "\n=== Stall Attribution ===" << std::endl;
+        // The whole run closes last; show it first
+        report_region(regions.back(), os);
+        for (size_t i = 0; i + 1 < regions.size(); i++) {
+            report_region(regions[i], os);
+        }
+        os << "Timeline: " << events << " events" << std::endl;
+    }
+};
+
+#endif // TB_PROFILER_H
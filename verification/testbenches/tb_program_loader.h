@@ -0,0 +1,173 @@
+// Program image loader for the UnifiedRISCV Verilator testbenches
+// Loads a RISC-V ELF32 executable (PT_LOAD segments plus its symbol table)
+// or a raw binary into TBMemoryModel. The ELF structures are declared here
+// since <elf.h> is not available on macOS.
+
+#ifndef TB_PROGRAM_LOADER_H
+#define TB_PROGRAM_LOADER_H
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include <cstring>
+#include "tb_memory_model.h"
+
+struct ProgramImage {
+    std::string path;
+    bool is_elf = false;
+    uint32_t entry = 0;
+    uint32_t load_bytes = 0;
+    std::map<std::string, uint32_t> symbols;
+    
+    // Symbol address, or fallback when the image has no such symbol
+    uint32_t symbol(const std::string& name, uint32_t fallback) const {
+        auto it = symbols.find(name);
+        return it != symbols.end() ? it->second : fallback;
+    }
+};
+
+class ProgramLoader {
+private:
+    struct Elf32Header {
+        uint8_t ident[16];
+        uint16_t type;
+        uint16_t machine;
+        uint32_t version;
+        uint32_t entry;
+        uint32_t phoff;
+        uint32_t shoff;
+        uint32_t flags;
+        uint16_t ehsize;
+        uint16_t phentsize;
+        uint16_t phnum;
+        uint16_t shentsize;
+        uint16_t shnum;
+        uint16_t shstrndx;
+    };
+    
+    struct Elf32ProgramHeader {
+        uint32_t type;
+        uint32_t offset;
+        uint32_t vaddr;
+        uint32_t paddr;
+        uint32_t filesz;
+        uint32_t memsz;
+        uint32_t flags;
+        uint32_t align;
+    };
+    
+    struct Elf32SectionHeader {
+        uint32_t name;
+        uint32_t type;
+        uint32_t flags;
+        uint32_t addr;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t link;
+        uint32_t info;
+        uint32_t addralign;
+        uint32_t entsize;
+    };
+    
+    struct Elf32Symbol {
+        uint32_t name;
+        uint32_t value;
+        uint32_t size;
+        uint8_t info;
+        uint8_t other;
+        uint16_t shndx;
+    };
+    
+    static const uint32_t PT_LOAD = 1;
+    static const uint32_t SHT_SYMTAB = 2;
+    static const uint16_t EM_RISCV = 243;
+    
+    template <class T>
+    static bool read_struct(const std::vector<uint8_t>& file, uint32_t offset, T& out) {
+        if (offset > file.size() || file.size() - offset < sizeof(T)) return false;
+        memcpy(&out, file.data() + offset, sizeof(T));
+        return true;
+    }
+    
+    static bool load_elf(const std::vector<uint8_t>& file, TBMemoryModel& memory,
+                         ProgramImage& image) {
+        Elf32Header eh;
+        if (!read_struct(file, 0, eh) || eh.ident[4] != 1 || eh.ident[5] != 1) {
+            std::cerr << image.path << ": not a little-endian ELF32 file" << std::endl;
+            return false;
+        }
+        if (eh.machine != EM_RISCV) {
+            std::cerr << image.path << ": not a RISC-V executable" << std::endl;
+            return false;
+        }
+        image.is_elf = true;
+        image.entry = eh.entry;
+        
+        for (uint32_t i = 0; i < eh.phnum; i++) {
+            Elf32ProgramHeader ph;
+            if (!read_struct(file, eh.phoff + i * eh.phentsize, ph)) return false;
+            if (ph.type != PT_LOAD || ph.memsz == 0) continue;
+            if (ph.offset > file.size() || file.size() - ph.offset < ph.filesz ||
+                ph.paddr >= memory.bytes() || memory.bytes() - ph.paddr < ph.memsz) {
+                std::cerr << image.path << ": segment at 0x" << std::hex << ph.paddr
+                          << std::dec << " does not fit in memory" << std::endl;
+                return false;
+            }
+            memory.write(ph.paddr, file.data() + ph.offset, ph.filesz);
+            for (uint32_t b = ph.filesz; b < ph.memsz; b++) {
+                memory[ph.paddr + b] = 0;
+            }
+            image.load_bytes += ph.memsz;
+        }
+        
+        // Symbols are optional; a stripped image just falls back to defaults
+        for (uint32_t i = 0; i < eh.shnum; i++) {
+            Elf32SectionHeader sh, strtab;
+            if (!read_struct(file, eh.shoff + i * eh.shentsize, sh)) break;
+            if (sh.type != SHT_SYMTAB || sh.entsize == 0) continue;
+            if (!read_struct(file, eh.shoff + sh.link * eh.shentsize, strtab)) break;
+            for (uint32_t off = 0; off + sh.entsize <= sh.size; off += sh.entsize) {
+                Elf32Symbol sym;
+                if (!read_struct(file, sh.offset + off, sym)) break;
+                uint32_t name = strtab.offset + sym.name;
+                if (sym.name == 0 || name >= file.size()) continue;
+                const char* str = reinterpret_cast<const char*>(file.data() + name);
+                image.symbols[std::string(str, strnlen(str, file.size() - name))] = sym.value;
+            }
+        }
+        return true;
+    }
+
+public:
+    // ELF files are recognised by their magic; anything else is loaded raw
+    // at base (the CPU reset vector is address 0)
+    static bool load(const std::string& path, TBMemoryModel& memory, ProgramImage& image,
+                     uint32_t base = 0) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            std::cerr << "Cannot open program " << path << std::endl;
+            return false;
+        }
+        std::vector<uint8_t> file((std::istreambuf_iterator<char>(in)),
+                                  std::istreambuf_iterator<char>());
+        image = ProgramImage();
+        image.path = path;
+        
+        if (file.size() >= 4 && memcmp(file.data(), "\x7f" "ELF", 4) == 0) {
+            return load_elf(file, memory, image);
+        }
+        if (base >= memory.bytes() || memory.bytes() - base < file.size()) {
+            std::cerr << path << ": " << file.size() << " bytes do not fit in memory" << std::endl;
+            return false;
+        }
+        memory.write(base, file.data(), file.size());
+        image.entry = base;
+        image.load_bytes = file.size();
+        return true;
+    }
+};
+
+#endif // TB_PROGRAM_LOADER_H
@@ -11,6 +11,17 @@ import numpy as np
 import random
 import logging
 
+# Descriptor / UNIT_CONFIG config bits (gpu_compute_unit.sv)
+CFG_ACCUMULATE = 0x1
+CFG_DEFER_STORE = 0x2
+CFG_ACC32 = 0x4
+CFG_INT16 = 0x8
+CFG_INT4 = 0x10
+CFG_FP16 = 0x18
+CFG_UNIT_PREC = 0x20
+
+RING_BASE = 0x8000  # Command ring used by the ring tests
+
 class GPUTestBench:
     """Test bench for GPU operations"""
     
@@ -18,12 +29,18 @@ class GPUTestBench:
         self.dut = dut
         self.log = logging.getLogger("cocotb.tb")
         self.memory = {}  # Simple memory model
+        self.transactions = 0  # Handshakes served by the memory model
+        self.spad_transactions = 0  # Requests served by the scratchpad model
         
     async def setup(self):
         """Initialize the test bench"""
         # Start clock
         cocotb.start_soon(Clock(self.dut.clk, 10, units="ns").start())
         
+        # Clear unit defaults so a failed test's precision/ACC mode can't leak
+        for unit in range(len(self.dut.unit_config)):
+            self.dut.unit_config[unit].value = 0
+        
         # Reset
         self.dut.rst_n.value = 0
         await RisingEdge(self.dut.clk)
@@ -43,8 +60,22 @@ class GPUTestBench:
                 await Timer(20, units="ns")
                 
                 addr = int(self.dut.mem_addr.value)
+                self.transactions += 1
                 
-                if self.dut.mem_we.value == 1:
+                if hasattr(self.dut, "mem_line") and self.dut.mem_line.value == 1:
+                    # Line access: 16 words at a line-aligned address
+                    if self.dut.mem_we.value == 1:
+                        line = int(self.dut.mem_line_wdata.value)
+                        mask = int(self.dut.mem_wmask.value)
+                        for w in range(16):
+                            if mask & (1 << w):
+                                self.memory[addr + w * 4] = (line >> (w * 32)) & 0xFFFFFFFF
+                    else:
+                        line = 0
+                        for w in range(16):
+                            line |= self.memory.get(addr + w * 4, 0) << (w * 32)
+                        self.dut.mem_line_rdata.value = line
+                elif self.dut.mem_we.value == 1:
                     # Write operation
                     data = int(self.dut.mem_wdata.value)
                     self.memory[addr] = data
@@ -59,6 +90,37 @@ class GPUTestBench:
                 await RisingEdge(self.dut.clk)
                 self.dut.mem_ack.value = 0
     
+    async def spad_model(self):
+        """Scratchpad model: one-cycle response, shares the address space"""
+        while True:
+            await RisingEdge(self.dut.clk)
+            
+            ack = 0
+            if self.dut.spad_req.value == 1:
+                addr = int(self.dut.spad_addr.value)
+                self.spad_transactions += 1
+                
+                if self.dut.spad_line.value == 1:
+                    base = addr & ~0x3F
+                    if self.dut.spad_we.value == 1:
+                        line = int(self.dut.spad_line_wdata.value)
+                        mask = int(self.dut.spad_wmask.value)
+                        for w in range(16):
+                            if mask & (1 << w):
+                                self.memory[base + w * 4] = (line >> (w * 32)) & 0xFFFFFFFF
+                    else:
+                        line = 0
+                        for w in range(16):
+                            line |= self.memory.get(base + w * 4, 0) << (w * 32)
+                        self.dut.spad_line_rdata.value = line
+                elif self.dut.spad_we.value == 1:
+                    self.memory[addr] = int(self.dut.spad_wdata.value)
+                else:
+                    self.dut.spad_rdata.value = self.memory.get(addr, 0)
+                ack = 1
+            
+            self.dut.spad_ack.value = ack
+    
     def create_test_matrix(self, rows=4, cols=4, dtype=np.int8):
         """Create a test matrix with known values"""
         return np.random.randint(-128, 127, size=(rows, cols), dtype=dtype)
@@ -79,12 +141,66 @@ class GPUTestBench:
             self.memory[addr] &= ~(0xFF << (byte_idx * 8))
             self.memory[addr] |= (val & 0xFF) << (byte_idx * 8)
     
+    def matrix16_to_memory(self, matrix, base_addr):
+        """Store an int16 matrix, 2 values per word"""
+        flat = matrix.flatten()
+        for i in range(0, len(flat), 2):
+            lo = int(flat[i]) & 0xFFFF
+            hi = int(flat[i + 1]) & 0xFFFF if i + 1 < len(flat) else 0
+            self.memory[base_addr + i * 2] = lo | (hi << 16)
+    
+    def matrix4_to_memory(self, matrix, base_addr):
+        """Store an int4 tile (4x8 A or 8x4 B), 8 values per word, low nibble first"""
+        flat = matrix.flatten()
+        for i in range(0, len(flat), 8):
+            word = 0
+            for n, value in enumerate(flat[i:i + 8]):
+                word |= (int(value) & 0xF) << (n * 4)
+            self.memory[base_addr + i // 2] = word
+    
+    def descriptor_to_memory(self, ring_base, slot, addr_a, addr_b, addr_c, config=0):
+        """Write a 16-byte command descriptor into a unit's ring"""
+        base = ring_base + slot * 16
+        for i, word in enumerate([addr_a, addr_b, addr_c, config]):
+            self.memory[base + i * 4] = word & 0xFFFFFFFF
+    
+    @staticmethod
+    def chain_config(ks, k_steps, base=0):
+        """Config of step ks of a k-step chain: the first clears C, later ones
+        accumulate, and only the last stores it"""
+        config = base
+        if ks > 0:
+            config |= CFG_ACCUMULATE
+        if ks < k_steps - 1:
+            config |= CFG_DEFER_STORE
+        return config
+    
+    async def run_ring(self, unit, count, timeout=4000, message=None, ring_base=RING_BASE):
+        """Point unit at its ring, publish head = count and wait for the tail
+        to reach it; returns the cycles waited"""
+        self.dut.gpu_ring_base[unit].value = ring_base
+        self.dut.gpu_ring_head[unit].value = count
+        await RisingEdge(self.dut.clk)
+        
+        cycles = 0
+        while int(self.dut.gpu_ring_tail[unit].value) != count and cycles < timeout:
+            await RisingEdge(self.dut.clk)
+            cycles += 1
+        assert cycles < timeout, message or f"Unit {unit} ring did not reach tail {count}"
+        return cycles
+    
     def matrix_from_memory(self, base_addr, rows=4, cols=4, dtype=np.int16):
         """Read matrix from memory model"""
         result = np.zeros((rows, cols), dtype=dtype)
         flat_size = rows * cols
         
         for i in range(flat_size):
+            if dtype == np.int32:
+                # One int32 value per word
+                word = self.memory.get(base_addr + i * 4, 0)
+                result.flat[i] = np.int32(np.uint32(word).view(np.int32))
+                continue
+            
             word_idx = i // 2  # 2 int16 values per 32-bit word
             elem_idx = i % 2
             addr = base_addr + word_idx * 4
@@ -328,6 +444,387 @@ async def test_gpu_performance(dut):
     else:
         tb.log.warning("  May require architectural improvements")
 
+@cocotb.test()
+async def test_gpu_command_ring(dut):
+    """Queue several descriptors on one unit and check they all retire"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    num_cmds = 4
+    tb.log.info(f"Testing command ring with {num_cmds} queued descriptors")
+    
+    expected_results = []
+    result_addrs = []
+    for slot in range(num_cmds):
+        a = tb.create_test_matrix()
+        b = tb.create_test_matrix()
+        expected_results.append(np.dot(a.astype(np.int16), b.astype(np.int16)))
+        
+        addr_a = 0x9000 + slot * 0x100
+        addr_b = addr_a + 0x20
+        addr_c = addr_a + 0x40
+        result_addrs.append(addr_c)
+        
+        tb.matrix_to_memory(a, addr_a)
+        tb.matrix_to_memory(b, addr_b)
+        tb.descriptor_to_memory(RING_BASE, slot, addr_a, addr_b, addr_c)
+    
+    # Point unit 0 at the ring and publish all descriptors in one doorbell
+    cycles = await tb.run_ring(0, num_cmds, message="Command ring did not drain")
+    tb.log.info(f"{num_cmds} queued operations retired in {cycles} cycles")
+    
+    for slot in range(num_cmds):
+        result = tb.matrix_from_memory(result_addrs[slot])
+        np.testing.assert_array_equal(result, expected_results[slot],
+                                      err_msg=f"Ring slot {slot} result mismatch")
+    
+    tb.log.info("Command ring test: PASSED")
+
+@cocotb.test()
+async def test_gpu_accumulate_mode(dut):
+    """Stream two k-steps through one unit and check C is written once"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    addr_c = 0xA000
+    
+    a0, b0 = tb.create_test_matrix(), tb.create_test_matrix()
+    a1, b1 = tb.create_test_matrix(), tb.create_test_matrix()
+    expected = (np.dot(a0.astype(np.int16), b0.astype(np.int16)) +
+                np.dot(a1.astype(np.int16), b1.astype(np.int16)))
+    
+    tb.matrix_to_memory(a0, 0x9000)
+    tb.matrix_to_memory(b0, 0x9020)
+    tb.matrix_to_memory(a1, 0x9100)
+    tb.matrix_to_memory(b1, 0x9120)
+    
+    # First step keeps its partial sum on the unit, second accumulates and stores
+    tb.descriptor_to_memory(RING_BASE, 0, 0x9000, 0x9020, addr_c, CFG_DEFER_STORE)
+    tb.descriptor_to_memory(RING_BASE, 1, 0x9100, 0x9120, addr_c, CFG_ACCUMULATE)
+    
+    await tb.run_ring(0, 2, timeout=2000, message="Accumulate sequence did not complete")
+    
+    result = tb.matrix_from_memory(addr_c)
+    np.testing.assert_array_equal(result, expected,
+                                  err_msg="Accumulated result mismatch")
+    
+    tb.log.info("Accumulate mode test: PASSED")
+
+@cocotb.test()
+async def test_gpu_burst_access(dut):
+    """A tile pair sharing a line loads in one burst, C stores in one"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    if not hasattr(dut, "mem_line"):
+        tb.log.info("DUT has no line port, skipping burst test")
+        return
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    addr_a = 0x9000          # A and B share one 64-byte line
+    addr_b = addr_a + 0x10
+    addr_c = 0x9040          # 32-byte int16 C tile in the next line
+    
+    a, b = tb.create_test_matrix(), tb.create_test_matrix()
+    expected = np.dot(a.astype(np.int16), b.astype(np.int16))
+    tb.matrix_to_memory(a, addr_a)
+    tb.matrix_to_memory(b, addr_b)
+    tb.descriptor_to_memory(RING_BASE, 0, addr_a, addr_b, addr_c)
+    
+    tb.transactions = 0
+    cycles = await tb.run_ring(0, 1, timeout=2000, message="Burst command did not complete")
+    
+    # Descriptor, A+B and C: one handshake each (word mode needs 20)
+    tb.log.info(f"Burst command: {tb.transactions} transactions, {cycles} cycles")
+    assert tb.transactions <= 3, f"Expected 3 line transactions, saw {tb.transactions}"
+    
+    result = tb.matrix_from_memory(addr_c)
+    np.testing.assert_array_equal(result, expected, err_msg="Burst result mismatch")
+    
+    tb.log.info("Burst access test: PASSED")
+
+@cocotb.test()
+async def test_gpu_double_buffer_overlap(dut):
+    """Back-to-back ring commands overlap load, compute and store"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    num_cmds = 4
+    expected_results = []
+    
+    for slot in range(num_cmds):
+        a, b = tb.create_test_matrix(), tb.create_test_matrix()
+        expected_results.append(np.dot(a.astype(np.int16), b.astype(np.int16)))
+        addr_a = 0x9000 + slot * 0x100
+        tb.matrix_to_memory(a, addr_a)
+        tb.matrix_to_memory(b, addr_a + 0x20)
+        tb.descriptor_to_memory(RING_BASE, slot, addr_a, addr_a + 0x20, addr_a + 0x40)
+    
+    # One command on its own gives the serial latency
+    single = await tb.run_ring(0, 1)
+    
+    # The rest are queued together and should pipeline
+    batch = await tb.run_ring(0, num_cmds)
+    
+    tb.log.info(f"Single command: {single} cycles, {num_cmds - 1} queued: {batch} cycles")
+    assert batch < single * (num_cmds - 1), "Queued commands did not overlap"
+    
+    for slot in range(num_cmds):
+        result = tb.matrix_from_memory(0x9000 + slot * 0x100 + 0x40)
+        np.testing.assert_array_equal(result, expected_results[slot],
+                                      err_msg=f"Result mismatch for command {slot}")
+    
+    tb.log.info("Double-buffer overlap test: PASSED")
+
+@cocotb.test()
+async def test_gpu_int32_accumulate(dut):
+    """Accumulate a K=16 reduction past int16 range and store int32 C"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    addr_c = 0xA000
+    k_steps = 4
+    
+    # Worst-case operands: every product is 127*127, sums overflow int16
+    a = np.full((4, 4 * k_steps), 127, dtype=np.int8)
+    b = np.full((4 * k_steps, 4), 127, dtype=np.int8)
+    expected = np.dot(a.astype(np.int32), b.astype(np.int32))
+    
+    for ks in range(k_steps):
+        addr_a = 0x9000 + ks * 0x40
+        addr_b = addr_a + 0x20
+        tb.matrix_to_memory(a[:, ks * 4:(ks + 1) * 4], addr_a)
+        tb.matrix_to_memory(b[ks * 4:(ks + 1) * 4, :], addr_b)
+        
+        config = tb.chain_config(ks, k_steps, CFG_ACC32)
+        tb.descriptor_to_memory(RING_BASE, ks, addr_a, addr_b, addr_c, config)
+    
+    await tb.run_ring(0, k_steps, message="Int32 accumulate sequence did not complete")
+    
+    result = tb.matrix_from_memory(addr_c, dtype=np.int32)
+    np.testing.assert_array_equal(result, expected,
+                                  err_msg="Int32 accumulated result mismatch")
+    
+    tb.log.info("Int32 accumulate test: PASSED")
+
+@cocotb.test()
+async def test_gpu_scratchpad_bypass(dut):
+    """Tiles in the scratchpad window never reach the memory controller"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    if not hasattr(dut, "spad_req"):
+        tb.log.info("DUT has no scratchpad port, skipping scratchpad test")
+        return
+    
+    cocotb.start_soon(tb.memory_model())
+    cocotb.start_soon(tb.spad_model())
+    
+    SPAD_BASE = 0x10010000
+    addr_a = SPAD_BASE
+    addr_b = SPAD_BASE + 0x10
+    addr_c = SPAD_BASE + 0x40
+    
+    a, b = tb.create_test_matrix(), tb.create_test_matrix()
+    expected = np.dot(a.astype(np.int16), b.astype(np.int16))
+    tb.matrix_to_memory(a, addr_a)
+    tb.matrix_to_memory(b, addr_b)
+    tb.descriptor_to_memory(RING_BASE, 0, addr_a, addr_b, addr_c)
+    
+    tb.transactions = 0
+    tb.spad_transactions = 0
+    cycles = await tb.run_ring(0, 1, timeout=2000, message="Scratchpad command did not complete")
+    
+    # Only the descriptor comes from main memory
+    tb.log.info(f"Scratchpad command: {tb.transactions} memory, "
+                f"{tb.spad_transactions} scratchpad requests, {cycles} cycles")
+    assert tb.transactions == 1, f"Expected 1 memory transaction, saw {tb.transactions}"
+    assert tb.spad_transactions > 0, "No requests reached the scratchpad"
+    
+    result = tb.matrix_from_memory(addr_c)
+    np.testing.assert_array_equal(result, expected, err_msg="Scratchpad result mismatch")
+    
+    tb.log.info("Scratchpad bypass test: PASSED")
+
+@cocotb.test()
+async def test_gpu_perf_counters(dut):
+    """Per-unit counters account for one 4x4 op"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    if not hasattr(dut, "unit_macs"):
+        tb.log.info("DUT has no performance counter ports, skipping counter test")
+        return
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    addr_a, addr_b, addr_c = 0x9000, 0x9010, 0x9040
+    tb.matrix_to_memory(tb.create_test_matrix(), addr_a)
+    tb.matrix_to_memory(tb.create_test_matrix(), addr_b)
+    tb.descriptor_to_memory(RING_BASE, 0, addr_a, addr_b, addr_c)
+    
+    await tb.run_ring(0, 1, timeout=2000, message="Counter test command did not complete")
+    await RisingEdge(dut.clk)
+    
+    busy = int(dut.unit_busy_cycles[0].value)
+    stall = int(dut.unit_stall_cycles[0].value)
+    mem_wait = int(dut.unit_mem_wait_cycles[0].value)
+    macs = int(dut.unit_macs[0].value)
+    ops = int(dut.unit_ops[0].value)
+    tb.log.info(f"Unit 0: busy {busy}, stall {stall}, mem wait {mem_wait}, "
+                f"MACs {macs}, ops {ops}")
+    
+    # Four compute cycles of 16 MACs; the rest of the busy time is load/store
+    assert macs == 64, f"Expected 64 MACs, saw {macs}"
+    assert ops == 1, f"Expected 1 retired op, saw {ops}"
+    assert busy - stall == 4, f"Expected 4 compute cycles, saw {busy - stall}"
+    assert 0 < mem_wait < busy, f"Memory wait {mem_wait} outside (0, {busy})"
+    assert int(dut.unit_busy_cycles[1].value) == 0, "Idle unit counted busy cycles"
+    
+    tb.log.info("Performance counter test: PASSED")
+
+@cocotb.test()
+async def test_gpu_int16_operands(dut):
+    """INT16 precision: 32-byte A/B tiles outside the int8 range, int32 C"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    addr_c = 0xA000
+    k_steps = 2
+    
+    # Winograd-sized operands: transformed weights reach +-1152, inputs +-512
+    a = np.random.randint(-1152, 1153, size=(4, 4 * k_steps)).astype(np.int16)
+    b = np.random.randint(-512, 513, size=(4 * k_steps, 4)).astype(np.int16)
+    a[0, 0], b[0, 0] = -1152, -512
+    expected = np.dot(a.astype(np.int32), b.astype(np.int32))
+    
+    for ks in range(k_steps):
+        addr_a = 0x9000 + ks * 0x40
+        addr_b = addr_a + 0x20
+        tb.matrix16_to_memory(a[:, ks * 4:(ks + 1) * 4], addr_a)
+        tb.matrix16_to_memory(b[ks * 4:(ks + 1) * 4, :], addr_b)
+        
+        config = tb.chain_config(ks, k_steps, CFG_INT16 | CFG_ACC32)
+        tb.descriptor_to_memory(RING_BASE, ks, addr_a, addr_b, addr_c, config)
+    
+    await tb.run_ring(0, k_steps, message="INT16 operand sequence did not complete")
+    
+    result = tb.matrix_from_memory(addr_c, dtype=np.int32)
+    np.testing.assert_array_equal(result, expected, err_msg="INT16 operand result mismatch")
+    
+    tb.log.info("INT16 operand test: PASSED")
+
+@cocotb.test()
+async def test_gpu_unit_precision_default(dut):
+    """Descriptor PREC=0 is INT8 whatever UNIT_CONFIG says; UNIT_PREC takes the unit's"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    a8 = np.random.randint(-128, 128, size=(4, 4)).astype(np.int8)
+    b8 = np.random.randint(-128, 128, size=(4, 4)).astype(np.int8)
+    a16 = np.random.randint(-1000, 1001, size=(4, 4)).astype(np.int16)
+    b16 = np.random.randint(-1000, 1001, size=(4, 4)).astype(np.int16)
+    tb.matrix_to_memory(a8, 0x9000)
+    tb.matrix_to_memory(b8, 0x9010)
+    tb.matrix16_to_memory(a16, 0x9040)
+    tb.matrix16_to_memory(b16, 0x9060)
+    tb.descriptor_to_memory(RING_BASE, 0, 0x9000, 0x9010, 0xA000, CFG_ACC32)
+    tb.descriptor_to_memory(RING_BASE, 1, 0x9040, 0x9060, 0xA040, CFG_UNIT_PREC | CFG_ACC32)
+    
+    dut.unit_config[0].value = CFG_INT16
+    await tb.run_ring(0, 2, message="Precision default sequence did not complete")
+    
+    result8 = tb.matrix_from_memory(0xA000, dtype=np.int32)
+    result16 = tb.matrix_from_memory(0xA040, dtype=np.int32)
+    np.testing.assert_array_equal(result8, np.dot(a8.astype(np.int32), b8.astype(np.int32)),
+                                  err_msg="PREC=0 descriptor did not run as INT8")
+    np.testing.assert_array_equal(result16, np.dot(a16.astype(np.int32), b16.astype(np.int32)),
+                                  err_msg="UNIT_PREC descriptor did not take the unit precision")
+    
+    tb.log.info("Unit precision default test: PASSED")
+
+@cocotb.test()
+async def test_gpu_int4_operands(dut):
+    """INT4 precision: 16-byte 4x8 A / 8x4 B tiles, so each op is a K=8 step"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    addr_c = 0xA000
+    k_steps = 2
+    
+    a = np.random.randint(-8, 8, size=(4, 8 * k_steps)).astype(np.int32)
+    b = np.random.randint(-8, 8, size=(8 * k_steps, 4)).astype(np.int32)
+    a[0, :], b[:, 0] = -8, -8
+    a[3, 7], b[15, 3] = 7, 7
+    expected = np.dot(a, b)
+    
+    for ks in range(k_steps):
+        addr_a = 0x9000 + ks * 0x40
+        addr_b = addr_a + 0x10
+        tb.matrix4_to_memory(a[:, ks * 8:(ks + 1) * 8], addr_a)
+        tb.matrix4_to_memory(b[ks * 8:(ks + 1) * 8, :], addr_b)
+        
+        config = tb.chain_config(ks, k_steps, CFG_INT4 | CFG_ACC32)
+        tb.descriptor_to_memory(RING_BASE, ks, addr_a, addr_b, addr_c, config)
+    
+    await tb.run_ring(0, k_steps, message="INT4 operand sequence did not complete")
+    
+    result = tb.matrix_from_memory(addr_c, dtype=np.int32)
+    np.testing.assert_array_equal(result, expected, err_msg="INT4 operand result mismatch")
+    
+    tb.log.info("INT4 operand test: PASSED")
+
+@cocotb.test()
+async def test_gpu_fp16_operands(dut):
+    """FP16 precision: fp32 accumulate in k order, C always stored as fp32"""
+    tb = GPUTestBench(dut)
+    await tb.setup()
+    
+    cocotb.start_soon(tb.memory_model())
+    
+    addr_c = 0xA000
+    k_steps = 2
+    
+    a = np.random.uniform(-8, 8, size=(4, 4 * k_steps)).astype(np.float16)
+    b = np.random.uniform(-64, 64, size=(4 * k_steps, 4)).astype(np.float16)
+    a[1, 2], b[2, 1] = np.float16(6.1e-5), np.float16(-3.0e-7)  # Normal and subnormal
+    
+    # Products of fp16 values are exact in fp32; each add rounds
+    expected = np.zeros((4, 4), dtype=np.float32)
+    for k in range(4 * k_steps):
+        expected += np.outer(a[:, k].astype(np.float32), b[k, :].astype(np.float32))
+    
+    for ks in range(k_steps):
+        addr_a = 0x9000 + ks * 0x40
+        addr_b = addr_a + 0x20
+        tb.matrix16_to_memory(a[:, ks * 4:(ks + 1) * 4].view(np.int16), addr_a)
+        tb.matrix16_to_memory(b[ks * 4:(ks + 1) * 4, :].view(np.int16), addr_b)
+        
+        config = tb.chain_config(ks, k_steps, CFG_FP16)
+        tb.descriptor_to_memory(RING_BASE, ks, addr_a, addr_b, addr_c, config)
+    
+    await tb.run_ring(0, k_steps, message="FP16 operand sequence did not complete")
+    
+    result = tb.matrix_from_memory(addr_c, dtype=np.int32).view(np.float32)
+    np.testing.assert_array_equal(result, expected, err_msg="FP16 operand result mismatch")
+    
+    tb.log.info("FP16 operand test: PASSED")
+
 # Test factory for parameterized tests
 tf_matrix_sizes = TestFactory(test_gpu_basic_functionality)
 tf_matrix_sizes.add_option("matrix_size", [4, 8, 16])